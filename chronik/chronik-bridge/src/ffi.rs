@@ -246,6 +246,19 @@ mod ffi_inner {
             block_index: &CBlockIndex,
         ) -> Result<UniquePtr<CBlockUndo>>;
 
+        /// Like load_block, for the blocks read in chain order: the reads
+        /// are shared with the indexes catching up at the same time.
+        fn load_block_in_order(
+            self: &ChronikBridge,
+            block_index: &CBlockIndex,
+        ) -> Result<UniquePtr<CBlock>>;
+
+        /// Like load_block_undo, for the blocks read in chain order.
+        fn load_block_undo_in_order(
+            self: &ChronikBridge,
+            block_index: &CBlockIndex,
+        ) -> Result<UniquePtr<CBlockUndo>>;
+
         /// Load the CTransaction and CTxUndo data from disk and turn it into a
         /// bridged Tx, containing spent coins etc.
         fn load_tx(
@@ -194,7 +194,9 @@ void log_print_chronik(const rust::Str logging_function,
     }
 }
 
-ChronikBridge::ChronikBridge(const node::NodeContext &node) : m_node{node} {
+ChronikBridge::ChronikBridge(const node::NodeContext &node)
+    : m_node{node},
+      m_block_cursor{Assert(node.chainman)->m_blockman.m_shared_block_reader} {
     // This class relies on these two members not being nullptr
     Assert(m_node.chainman);
     Assert(m_node.mempool);
@@ -295,6 +297,29 @@ ChronikBridge::load_block_undo(const CBlockIndex &bindex) const {
     return std::make_unique<CBlockUndo>(std::move(block_undo));
 }
 
+std::unique_ptr<CBlock>
+ChronikBridge::load_block_in_order(const CBlockIndex &bindex) const {
+    m_block_cursor.SetHeight(bindex.nHeight);
+    std::shared_ptr<const CBlock> block = m_block_cursor.ReadBlock(bindex);
+    if (!block) {
+        throw std::runtime_error("Reading block data failed");
+    }
+    // The transactions are shared, so the copy is cheap.
+    return std::make_unique<CBlock>(*block);
+}
+
+std::unique_ptr<CBlockUndo>
+ChronikBridge::load_block_undo_in_order(const CBlockIndex &bindex) const {
+    m_block_cursor.SetHeight(bindex.nHeight);
+    // The genesis block has empty undo data
+    std::shared_ptr<const CBlockUndo> block_undo =
+        m_block_cursor.ReadBlockUndo(bindex);
+    if (!block_undo) {
+        throw std::runtime_error("Reading block undo data failed");
+    }
+    return std::make_unique<CBlockUndo>(*block_undo);
+}
+
 Tx ChronikBridge::load_tx(uint32_t file_num, uint32_t data_pos,
                           uint32_t undo_pos) const {
     CMutableTransaction tx;
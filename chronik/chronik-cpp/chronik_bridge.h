@@ -6,6 +6,7 @@
 #define BITCOIN_CHRONIK_CPP_CHRONIK_BRIDGE_H
 
 #include <node/context.h>
+#include <node/sharedblockreader.h>
 #include <threadsafety.h>
 #include <txmempool.h>
 
@@ -61,6 +62,12 @@ void log_print_chronik(const rust::Str logging_function,
  */
 class ChronikBridge {
     const node::NodeContext &m_node;
+    /**
+     * The blocks of the catch up are read through the shared reader, so they
+     * are only read once from disk when the indexes catch up with the chain
+     * at the same time. It is only used for reads in chain order.
+     */
+    mutable node::SharedBlockReader::Cursor m_block_cursor;
 
 public:
     ChronikBridge(const node::NodeContext &node);
@@ -81,6 +88,12 @@ public:
     std::unique_ptr<CBlockUndo>
     load_block_undo(const CBlockIndex &bindex) const;
 
+    std::unique_ptr<CBlock>
+    load_block_in_order(const CBlockIndex &bindex) const;
+
+    std::unique_ptr<CBlockUndo>
+    load_block_undo_in_order(const CBlockIndex &bindex) const;
+
     Tx load_tx(uint32_t file_num, uint32_t data_pos, uint32_t undo_pos) const;
 
     rust::Vec<uint8_t> load_raw_tx(uint32_t file_num, uint32_t data_pos) const;
@@ -438,7 +438,7 @@ impl ChronikIndexer {
                 return Ok(());
             }
             let block_index = ffi::get_block_ancestor(node_tip_index, height)?;
-            let block = self.load_chronik_block(node, block_index)?;
+            let block = self.load_chronik_block_in_order(node, block_index)?;
             let hash = block.db_block.hash.clone();
             self.handle_block_connected(block)?;
             log_chronik!(
@@ -1277,6 +1277,23 @@ impl ChronikIndexer {
         Ok(self.make_chronik_block(block))
     }
 
+    /// Load a ChronikBlock while catching up with the node, the blocks being
+    /// read in chain order. The reads are shared with the node's indexes.
+    fn load_chronik_block_in_order(
+        &self,
+        node: &Node,
+        block_index: &ffi::CBlockIndex,
+    ) -> Result<ChronikBlock> {
+        let ffi_block = node.bridge.load_block_in_order(block_index)?;
+        let ffi_block = expect_unique_ptr("load_block_in_order", &ffi_block);
+        let ffi_block_undo =
+            node.bridge.load_block_undo_in_order(block_index)?;
+        let ffi_block_undo =
+            expect_unique_ptr("load_block_undo_in_order", &ffi_block_undo);
+        let block = ffi::bridge_block(ffi_block, ffi_block_undo, block_index)?;
+        Ok(self.make_chronik_block(block))
+    }
+
     /// Mempool, behind read/write lock
     pub fn mempool(&self) -> &Mempool {
         &self.mempool
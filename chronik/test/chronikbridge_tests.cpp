@@ -7,7 +7,9 @@
 #include <chronik-cpp/chronik_bridge.h>
 #include <chronik-cpp/util/hash.h>
 #include <config.h>
+#include <node/sharedblockreader.h>
 #include <streams.h>
+#include <undo.h>
 #include <util/strencodings.h>
 #include <validation.h>
 
@@ -229,6 +231,53 @@ BOOST_FIXTURE_TEST_CASE(test_load_block, TestChain100Setup) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(test_load_block_in_order, TestChain100Setup) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    node::SharedBlockReader &reader = chainman.m_blockman.m_shared_block_reader;
+    const CBlockIndex &tip =
+        WITH_LOCK(chainman.GetMutex(), return *chainman.ActiveTip());
+
+    // An index catching up behind Chronik
+    node::SharedBlockReader::Cursor index_cursor(reader);
+
+    const chronik_bridge::ChronikBridge bridge(m_node);
+    for (int height = 0; height <= tip.nHeight; height++) {
+        // Keep the index active so the blocks are kept for it
+        index_cursor.SetHeight(0);
+
+        const CBlockIndex &bindex = *tip.GetAncestor(height);
+        BOOST_CHECK_EQUAL(bridge.load_block_in_order(bindex)->GetHash(),
+                          bindex.GetBlockHash());
+
+        DataStream expected{};
+        DataStream actual{};
+        expected << *bridge.load_block_undo(bindex);
+        actual << *bridge.load_block_undo_in_order(bindex);
+        BOOST_CHECK_EQUAL(HexStr(actual), HexStr(expected));
+    }
+    BOOST_CHECK_EQUAL(reader.GetCacheCount(), tip.nHeight + 1);
+    BOOST_CHECK(reader.GetCacheSize() > 0);
+
+    // The index gets the blocks that were read by Chronik
+    for (int height = 0; height <= tip.nHeight; height++) {
+        const CBlockIndex &bindex = *tip.GetAncestor(height);
+        index_cursor.SetHeight(height);
+        const auto block = index_cursor.ReadBlock(bindex);
+        BOOST_REQUIRE(block);
+        BOOST_CHECK_EQUAL(block->GetHash(), bindex.GetBlockHash());
+        BOOST_CHECK(index_cursor.ReadBlockUndo(bindex));
+    }
+
+    // Only the tip is still needed, by Chronik's cursor
+    index_cursor.SetHeight(tip.nHeight + 1);
+    BOOST_CHECK_EQUAL(reader.GetCacheCount(), 1);
+
+    // The reads out of order don't go through the cursor
+    BOOST_CHECK_EQUAL(bridge.load_block(*tip.GetAncestor(0))->GetHash(),
+                      chainman.GetParams().GenesisBlock().GetHash());
+    BOOST_CHECK_EQUAL(reader.GetCacheCount(), 1);
+}
+
 BOOST_FIXTURE_TEST_CASE(test_get_block_ancestor, TestChain100Setup) {
     ChainstateManager &chainman = *Assert(m_node.chainman);
     const CBlockIndex &tip =
@@ -583,8 +583,18 @@ void AddrManImpl::MakeTried(AddrInfo &info, nid_type nId) {
     info.fInTried = true;
 }
 
-bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
-                            std::chrono::seconds time_penalty) {
+std::pair<int, int>
+AddrManImpl::GetNewPosition(const CAddress &addr,
+                            const CNetAddr &source) const {
+    const AddrInfo info{addr, source};
+    const int bucket{info.GetNewBucket(nKey, m_asmap)};
+    return {bucket, info.GetBucketPosition(nKey, true, bucket)};
+}
+
+bool AddrManImpl::AddSingle(
+    const CAddress &addr, const CNetAddr &source,
+    std::chrono::seconds time_penalty,
+    const std::optional<std::pair<int, int>> &new_position) {
     AssertLockHeld(cs);
 
     if (!addr.IsRoutable()) {
@@ -641,8 +651,8 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
         nNew++;
     }
 
-    int nUBucket = pinfo->GetNewBucket(nKey, source, m_asmap);
-    int nUBucketPos = pinfo->GetBucketPosition(nKey, true, nUBucket);
+    const auto [nUBucket, nUBucketPos] =
+        new_position ? *new_position : GetNewPosition(addr, source);
     bool fInsert = vvNew[nUBucket][nUBucketPos] == -1;
     if (vvNew[nUBucket][nUBucketPos] != nId) {
         if (!fInsert) {
@@ -731,11 +741,13 @@ void AddrManImpl::Good_(const CService &addr, bool test_before_evict,
 
 bool AddrManImpl::Add_(const std::vector<CAddress> &vAddr,
                        const CNetAddr &source,
-                       std::chrono::seconds time_penalty) {
+                       std::chrono::seconds time_penalty,
+                       const std::vector<std::optional<std::pair<int, int>>>
+                           &new_positions) {
     int added{0};
-    for (std::vector<CAddress>::const_iterator it = vAddr.begin();
-         it != vAddr.end(); it++) {
-        added += AddSingle(*it, source, time_penalty) ? 1 : 0;
+    for (size_t i = 0; i < vAddr.size(); ++i) {
+        added +=
+            AddSingle(vAddr[i], source, time_penalty, new_positions[i]) ? 1 : 0;
     }
     if (added > 0) {
         LogPrint(BCLog::ADDRMAN,
@@ -874,6 +886,8 @@ AddrManImpl::GetAddr_(size_t max_addresses, size_t max_pct,
     // gather a list of random nodes, skipping those of low quality
     const auto now{Now<NodeSeconds>()};
     std::vector<CAddress> addresses;
+    // Avoid reallocating while the lock is held
+    addresses.reserve(nNodes);
     for (unsigned int n = 0; n < vRandom.size(); n++) {
         if (addresses.size() >= nNodes) {
             break;
@@ -1186,9 +1200,28 @@ size_t AddrManImpl::size() const {
 bool AddrManImpl::Add(const std::vector<CAddress> &vAddr,
                       const CNetAddr &source,
                       std::chrono::seconds time_penalty) {
+    // Hashing the position in the new table is most of the cost of inserting
+    // an address. It doesn't depend on the addrman state, so it is done
+    // without holding the lock for the addresses that are not known yet,
+    // which are the ones likely to be inserted.
+    std::vector<bool> unknown(vAddr.size());
+    {
+        LOCK(cs);
+        for (size_t i = 0; i < vAddr.size(); ++i) {
+            unknown[i] = vAddr[i].IsRoutable() && mapAddr.count(vAddr[i]) == 0;
+        }
+    }
+    std::vector<std::optional<std::pair<int, int>>> new_positions(
+        vAddr.size());
+    for (size_t i = 0; i < vAddr.size(); ++i) {
+        if (unknown[i]) {
+            new_positions[i] = GetNewPosition(vAddr[i], source);
+        }
+    }
+
     LOCK(cs);
     Check();
-    auto ret = Add_(vAddr, source, time_penalty);
+    auto ret = Add_(vAddr, source, time_penalty, new_positions);
     Check();
     return ret;
 }
@@ -166,7 +166,9 @@ private:
     //! Source of random numbers for randomization in inner loops
     mutable FastRandomContext insecure_rand GUARDED_BY(cs);
 
-    //! secret key to randomize bucket select with
+    //! secret key to randomize bucket select with. It is only set on
+    //! construction and when unserializing, before the addrman is shared, so
+    //! it can be read without holding cs.
     uint256 nKey;
 
     //! Serialization versions.
@@ -283,19 +285,32 @@ private:
     //! Move an entry from the "new" table(s) to the "tried" table
     void MakeTried(AddrInfo &info, nid_type nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /**
+     * The "new" bucket and position of an address announced by source. This
+     * only depends on the addresses and nKey, so it can be computed without
+     * holding cs.
+     */
+    std::pair<int, int> GetNewPosition(const CAddress &addr,
+                                       const CNetAddr &source) const;
+
     /**
      * Attempt to add a single address to addrman's new table.
-     * @see AddrMan::Add() for parameters.
+     * @param[in] new_position The result of GetNewPosition() if it was
+     *                         computed beforehand.
+     * @see AddrMan::Add() for the other parameters.
      */
     bool AddSingle(const CAddress &addr, const CNetAddr &source,
-                   std::chrono::seconds time_penalty)
+                   std::chrono::seconds time_penalty,
+                   const std::optional<std::pair<int, int>> &new_position)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void Good_(const CService &addr, bool test_before_evict, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     bool Add_(const std::vector<CAddress> &vAddr, const CNetAddr &source,
-              std::chrono::seconds time_penalty) EXCLUSIVE_LOCKS_REQUIRED(cs);
+              std::chrono::seconds time_penalty,
+              const std::vector<std::optional<std::pair<int, int>>>
+                  &new_positions) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void Attempt_(const CService &addr, bool fCountFailure, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
@@ -0,0 +1,87 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/compactpoll.h>
+
+namespace avalanche {
+
+CompactPoll PollSessionEncoder::encode(uint64_t round,
+                                       const std::vector<CInv> &invs) {
+    // Start over rather than letting the session grow forever. The items
+    // that are still being polled will get a new id on the next poll.
+    const bool resetSession =
+        sessionIds.size() + invs.size() > AVALANCHE_MAX_POLL_SESSION_IDS;
+    if (resetSession) {
+        sessionIds.clear();
+    }
+
+    std::vector<CompactPollItem> items;
+    items.reserve(invs.size());
+    for (const CInv &inv : invs) {
+        auto [it, inserted] = sessionIds.emplace(inv, sessionIds.size());
+        if (inserted) {
+            items.push_back({0, inv});
+            continue;
+        }
+
+        items.push_back({it->second + 1, CInv()});
+    }
+
+    return CompactPoll(round, resetSession, std::move(items));
+}
+
+bool PollSessionDecoder::decode(const CompactPoll &poll,
+                                std::vector<CInv> &invs) {
+    if (poll.isSessionReset()) {
+        sessionInvs.clear();
+    }
+
+    invs.clear();
+    invs.reserve(poll.getItems().size());
+    for (const CompactPollItem &item : poll.getItems()) {
+        if (item.isNew()) {
+            if (sessionInvs.size() >= AVALANCHE_MAX_POLL_SESSION_IDS) {
+                return false;
+            }
+            sessionInvs.push_back(item.inv);
+            invs.push_back(item.inv);
+            continue;
+        }
+
+        const uint32_t sessionId = item.code - 1;
+        if (sessionId >= sessionInvs.size()) {
+            return false;
+        }
+        invs.push_back(sessionInvs[sessionId]);
+    }
+
+    return true;
+}
+
+CompactResponse::CompactResponse(const Response &response)
+    : round(response.getRound()), cooldown(response.getCooldown()),
+      maxVotes(response.GetVotes().size()) {
+    errors.reserve(response.GetVotes().size());
+    for (const Vote &vote : response.GetVotes()) {
+        errors.push_back(vote.GetError());
+    }
+}
+
+bool CompactResponse::expand(const std::vector<CInv> &invs,
+                             Response &response) const {
+    if (invs.size() != errors.size()) {
+        return false;
+    }
+
+    std::vector<Vote> votes;
+    votes.reserve(errors.size());
+    for (size_t i = 0; i < errors.size(); i++) {
+        votes.emplace_back(errors[i], invs[i].hash);
+    }
+
+    response = Response(round, cooldown, std::move(votes));
+    return true;
+}
+
+} // namespace avalanche
@@ -0,0 +1,252 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_AVALANCHE_COMPACTPOLL_H
+#define BITCOIN_AVALANCHE_COMPACTPOLL_H
+
+#include <avalanche/protocol.h>
+#include <protocol.h> // for CInv
+#include <serialize.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <ios>
+#include <limits>
+#include <map>
+#include <vector>
+
+/**
+ * Starting with AVALANCHE_COMPACT_POLL_VERSION, the avapoll and avaresponse
+ * messages use a compact encoding:
+ *  - The items that were already polled on the connection are referred to by
+ *    a short session id instead of their full inv. The ids are assigned by
+ *    both sides in order of first appearance, much like the short ids in
+ *    compact blocks.
+ *  - The responses don't repeat the item hashes, since the poller knows in
+ *    which order it asked for them. The common vote values are packed on 2
+ *    bits each.
+ */
+
+namespace avalanche {
+
+/**
+ * Maximum number of session ids per connection. The poller resets the session
+ * before reaching it, so the pollee can reject anything above.
+ */
+static constexpr uint32_t AVALANCHE_MAX_POLL_SESSION_IDS = 4096;
+
+struct CompactPollItem {
+    /** Session id + 1 of an already known item, or 0 for a new item. */
+    uint32_t code{0};
+    /** Only set for new items. */
+    CInv inv;
+
+    bool isNew() const { return code == 0; }
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        WriteCompactSize(s, code);
+        if (isNew()) {
+            s << inv;
+        }
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        const uint64_t c = ReadCompactSize(s);
+        if (c > AVALANCHE_MAX_POLL_SESSION_IDS) {
+            throw std::ios_base::failure("poll session id out of range");
+        }
+        code = c;
+        if (isNew()) {
+            s >> inv;
+        }
+    }
+};
+
+class CompactPoll {
+    uint64_t round{std::numeric_limits<uint64_t>::max()};
+    /** Whether the pollee should forget the session ids before this poll. */
+    bool resetSession{false};
+    std::vector<CompactPollItem> items;
+    /**
+     * Maximum number of items accepted when unserializing. The count is
+     * checked before reading them, since the 1 byte session ids expand to
+     * much larger items.
+     */
+    size_t maxItems{0};
+
+public:
+    /**
+     * Prepare for unserializing a poll of at most maxItemsIn items. Polls with
+     * more items are rejected.
+     */
+    explicit CompactPoll(size_t maxItemsIn) : maxItems(maxItemsIn) {}
+    CompactPoll(uint64_t roundIn, bool resetSessionIn,
+                std::vector<CompactPollItem> itemsIn)
+        : round(roundIn), resetSession(resetSessionIn),
+          items(std::move(itemsIn)), maxItems(items.size()) {}
+
+    uint64_t getRound() const { return round; }
+    bool isSessionReset() const { return resetSession; }
+    const std::vector<CompactPollItem> &getItems() const { return items; }
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        s << round << resetSession << items;
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        s >> round >> resetSession;
+        const uint64_t count = ReadCompactSize(s);
+        if (count > maxItems) {
+            throw std::ios_base::failure("too many poll items");
+        }
+
+        items.clear();
+        items.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            s >> items.emplace_back();
+        }
+    }
+};
+
+/**
+ * Poller side of the session: assigns the ids to the polled invs.
+ */
+class PollSessionEncoder {
+    std::map<CInv, uint32_t> sessionIds;
+
+public:
+    CompactPoll encode(uint64_t round, const std::vector<CInv> &invs);
+};
+
+/**
+ * Pollee side of the session: resolves the ids back to the invs.
+ */
+class PollSessionDecoder {
+    std::vector<CInv> sessionInvs;
+
+public:
+    /**
+     * Return false if the poll refers to an unknown id or would overflow the
+     * session. The session state should be considered lost in this case.
+     */
+    bool decode(const CompactPoll &poll, std::vector<CInv> &invs);
+};
+
+class CompactResponse {
+    uint64_t round{std::numeric_limits<uint64_t>::max()};
+    uint32_t cooldown{std::numeric_limits<uint32_t>::max()};
+    std::vector<uint32_t> errors;
+    /**
+     * Maximum number of votes accepted when unserializing. Each vote packed on
+     * 2 bits expands to 4 bytes, so the count is checked before reading them.
+     */
+    size_t maxVotes{0};
+
+    /** Vote values packed on 2 bits. Anything else is escaped. */
+    static constexpr uint8_t CODE_ACCEPTED = 0;
+    static constexpr uint8_t CODE_REJECTED = 1;
+    static constexpr uint8_t CODE_UNKNOWN = 2;
+    static constexpr uint8_t CODE_ESCAPED = 3;
+
+    static uint8_t GetCode(uint32_t error) {
+        switch (error) {
+            case 0:
+                return CODE_ACCEPTED;
+            case 1:
+                return CODE_REJECTED;
+            case std::numeric_limits<uint32_t>::max():
+                return CODE_UNKNOWN;
+            default:
+                return CODE_ESCAPED;
+        }
+    }
+
+public:
+    /**
+     * Prepare for unserializing a response to a poll of at most maxVotesIn
+     * items. Responses with more votes are rejected.
+     */
+    explicit CompactResponse(size_t maxVotesIn) : maxVotes(maxVotesIn) {}
+    explicit CompactResponse(const Response &response);
+
+    uint64_t getRound() const { return round; }
+    uint32_t getCooldown() const { return cooldown; }
+    const std::vector<uint32_t> &getErrors() const { return errors; }
+
+    /**
+     * Rebuild the full response given the invs that were polled, in the same
+     * order. Return false if the number of votes doesn't match.
+     */
+    bool expand(const std::vector<CInv> &invs, Response &response) const;
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        s << round << cooldown;
+        WriteCompactSize(s, errors.size());
+
+        uint8_t packed = 0;
+        for (size_t i = 0; i < errors.size(); i++) {
+            packed |= GetCode(errors[i]) << (2 * (i % 4));
+            if (i % 4 == 3) {
+                s << packed;
+                packed = 0;
+            }
+        }
+        if (errors.size() % 4) {
+            s << packed;
+        }
+
+        for (uint32_t error : errors) {
+            if (GetCode(error) == CODE_ESCAPED) {
+                s << error;
+            }
+        }
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        s >> round >> cooldown;
+        const uint64_t count = ReadCompactSize(s);
+        if (count > maxVotes) {
+            throw std::ios_base::failure("too many votes");
+        }
+
+        // Don't trust the count for the allocation, the packed votes are read
+        // one byte at a time so a bogus count fails at the end of the stream.
+        errors.clear();
+        errors.reserve(std::min<uint64_t>(count, 1024));
+
+        std::vector<size_t> escaped;
+        uint8_t packed = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            if (i % 4 == 0) {
+                s >> packed;
+            }
+            switch ((packed >> (2 * (i % 4))) & 0x03) {
+                case CODE_ACCEPTED:
+                    errors.push_back(0);
+                    break;
+                case CODE_REJECTED:
+                    errors.push_back(1);
+                    break;
+                case CODE_UNKNOWN:
+                    errors.push_back(std::numeric_limits<uint32_t>::max());
+                    break;
+                default:
+                    escaped.push_back(errors.size());
+                    errors.push_back(0);
+                    break;
+            }
+        }
+
+        for (size_t index : escaped) {
+            s >> errors[index];
+            if (GetCode(errors[index]) != CODE_ESCAPED) {
+                throw std::ios_base::failure("non-canonical vote encoding");
+            }
+        }
+    }
+};
+
+} // namespace avalanche
+
+#endif // BITCOIN_AVALANCHE_COMPACTPOLL_H
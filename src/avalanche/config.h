@@ -6,14 +6,19 @@
 #define BITCOIN_AVALANCHE_CONFIG_H
 
 #include <chrono>
+#include <cstddef>
 
 namespace avalanche {
 
 struct Config {
     const std::chrono::milliseconds queryTimeoutDuration;
+    /** Maximum number of nodes polled per event loop iteration. */
+    const size_t pollFanout;
 
-    Config(std::chrono::milliseconds queryTimeoutDurationIn)
-        : queryTimeoutDuration(queryTimeoutDurationIn) {}
+    Config(std::chrono::milliseconds queryTimeoutDurationIn,
+           size_t pollFanoutIn = 1)
+        : queryTimeoutDuration(queryTimeoutDurationIn),
+          pollFanout(pollFanoutIn) {}
 };
 
 } // namespace avalanche
@@ -24,11 +24,17 @@
 #include <validation.h> // For ChainstateManager
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <limits>
 
 namespace avalanche {
-static constexpr uint64_t PEERS_DUMP_VERSION{1};
+/**
+ * Version 1 only contains the peers. Version 2 adds the time of the dump and
+ * the proofs from the conflicting and immature pools.
+ */
+static constexpr uint64_t PEERS_DUMP_VERSION_PEERS_ONLY{1};
+static constexpr uint64_t PEERS_DUMP_VERSION{2};
 
 bool PeerManager::addNode(NodeId nodeid, const ProofId &proofid,
                           size_t max_elements) {
@@ -101,6 +107,7 @@ bool PeerManager::addNodeToPeer(const PeerSet::iterator &it) {
         const uint32_t score = p.getScore();
         const uint64_t start = slotCount;
         slots.emplace_back(start, score, it->peerid);
+        slotScores.push_back(score);
         slotCount = start + score;
 
         // Add to our allocated score when we allocate a new peer in the slots
@@ -174,10 +181,17 @@ bool PeerManager::removeNodeFromPeer(const PeerSet::iterator &it,
 
     if (i + 1 == slots.size()) {
         slots.pop_back();
+        slotScores.pop_back();
         slotCount = slots.empty() ? 0 : slots.back().getStop();
     } else {
         fragmentation += slots[i].getScore();
         slots[i] = slots[i].withPeerId(NO_PEER);
+        slotScores.setNullScore(i);
+
+        if (slots.size() >= COMPACT_MIN_SLOTS &&
+            2 * fragmentation > slotCount) {
+            compact();
+        }
     }
 
     return true;
@@ -277,6 +291,82 @@ void PeerManager::moveToConflictingPool(const ProofContainer &proofs) {
 bool PeerManager::registerProof(const ProofRef &proof,
                                 ProofRegistrationState &registrationState,
                                 RegistrationMode mode) {
+    return registerProofImpl(proof, registrationState, mode, nullptr);
+}
+
+bool PeerManager::registerVerifiedProof(
+    const ProofRef &proof, const ProofValidationState &statelessState,
+    ProofRegistrationState &registrationState, RegistrationMode mode) {
+    assert(proof);
+
+    ProofValidationState validationState = statelessState;
+    if (validationState.IsValid()) {
+        if (exists(proof->getId())) {
+            // The proof is likely to be rejected as a duplicate, so don't
+            // bother looking up the utxos. Should it pass the checks anyway,
+            // it gets fully verified.
+            return registerProofImpl(proof, registrationState, mode, nullptr);
+        }
+
+        WITH_LOCK(cs_main, return proof->verifyAgainstChain(chainman,
+                                                            validationState));
+    }
+
+    return registerProofImpl(proof, registrationState, mode, &validationState);
+}
+
+std::vector<std::optional<ProofValidationState>>
+PeerManager::verifyProofs(const std::vector<ProofRef> &proofs,
+                          ProofCheckQueue *checkQueue) const {
+    const size_t numProofs = proofs.size();
+
+    // Run the stateless checks first. These are the expensive ones as they
+    // involve all the signatures, so spread them over the check queue workers.
+    std::vector<ProofValidationState> statelessStates(numProofs);
+    {
+        CCheckQueueControl<ProofStatelessCheck> control(checkQueue);
+
+        std::vector<ProofStatelessCheck> checks;
+        checks.reserve(numProofs);
+        for (size_t i = 0; i < numProofs; i++) {
+            assert(proofs[i]);
+            checks.emplace_back(proofs[i], stakeUtxoDustThreshold,
+                                &statelessStates[i]);
+        }
+
+        if (checkQueue) {
+            control.Add(std::move(checks));
+            control.Complete();
+        } else {
+            for (auto &check : checks) {
+                check();
+            }
+        }
+    }
+
+    // Then check all the stake utxos at once. There is no point in looking up
+    // the utxos of proofs that we already know about, they are likely to be
+    // rejected as duplicates. These are left unverified.
+    std::vector<std::optional<ProofValidationState>> validationStates(
+        numProofs);
+    LOCK(cs_main);
+    for (size_t i = 0; i < numProofs; i++) {
+        if (statelessStates[i].IsValid() && exists(proofs[i]->getId())) {
+            continue;
+        }
+
+        validationStates[i] = std::move(statelessStates[i]);
+        if (validationStates[i]->IsValid()) {
+            proofs[i]->verifyAgainstChain(chainman, *validationStates[i]);
+        }
+    }
+
+    return validationStates;
+}
+
+bool PeerManager::registerProofImpl(
+    const ProofRef &proof, ProofRegistrationState &registrationState,
+    RegistrationMode mode, const ProofValidationState *validationState) {
     assert(proof);
 
     const ProofId &proofid = proof->getId();
@@ -305,11 +395,17 @@ bool PeerManager::registerProof(const ProofRef &proof,
         return invalidate(ProofRegistrationResult::DANGLING, "dangling-proof");
     }
 
-    // Check the proof's validity.
-    ProofValidationState validationState;
-    if (!WITH_LOCK(cs_main, return proof->verify(stakeUtxoDustThreshold,
-                                                 chainman, validationState))) {
-        if (isImmatureState(validationState)) {
+    // Check the proof's validity, unless the caller did it already.
+    ProofValidationState localValidationState;
+    if (!validationState) {
+        WITH_LOCK(cs_main,
+                  return proof->verify(stakeUtxoDustThreshold, chainman,
+                                       localValidationState));
+        validationState = &localValidationState;
+    }
+
+    if (!validationState->IsValid()) {
+        if (isImmatureState(*validationState)) {
             immatureProofPool.addProofIfPreferred(proof);
             if (immatureProofPool.countProofs() >
                 AVALANCHE_MAX_IMMATURE_PROOFS) {
@@ -323,7 +419,7 @@ bool PeerManager::registerProof(const ProofRef &proof,
                               "immature-proof");
         }
 
-        if (validationState.GetResult() ==
+        if (validationState->GetResult() ==
             ProofValidationResult::MISSING_UTXO) {
             return invalidate(ProofRegistrationResult::MISSING_UTXO,
                               "utxo-missing-or-spent");
@@ -565,11 +661,10 @@ NodeId PeerManager::selectNode() {
     for (int retry = 0; retry < SELECT_NODE_MAX_RETRY; retry++) {
         const PeerId p = selectPeer();
 
-        // If we cannot find a peer, it may be due to the fact that it is
-        // unlikely due to high fragmentation, so compact and retry.
+        // Dead slots are never selected, so if we cannot find a peer there is
+        // no connected peer at all and retrying is pointless.
         if (p == NO_PEER) {
-            compact();
-            continue;
+            break;
         }
 
         // See if that peer has an available node.
@@ -587,6 +682,49 @@ NodeId PeerManager::selectNode() {
     return NO_NODE;
 }
 
+std::vector<NodeId> PeerManager::selectNodes(size_t count) {
+    std::vector<NodeId> nodeids;
+    nodeids.reserve(std::min(count, slots.size()));
+
+    // The score of each drawn peer is removed from the tree so it can't be
+    // drawn again, and restored once the selection is complete. Every draw
+    // removes a peer, so this ends after at most one draw per peer.
+    std::vector<std::pair<size_t, uint64_t>> drawnScores;
+    FastRandomContext rng;
+    const auto now = Now<SteadyMilliseconds>();
+    auto &nview = nodes.get<next_request_time>();
+    while (nodeids.size() < count) {
+        const uint64_t total = slotScores.getTotal();
+        if (total == 0) {
+            break;
+        }
+
+        const size_t i = slotScores.find(rng.randrange(total));
+        assert(i < slots.size());
+        drawnScores.emplace_back(i, slotScores.getScore(i));
+        slotScores.setNullScore(i);
+
+        // See if that peer has an available node.
+        const PeerId p = slots[i].getPeerId();
+        auto it = nview.lower_bound(boost::make_tuple(p, SteadyMilliseconds()));
+        if (it != nview.end() && it->peerid == p &&
+            it->nextRequestTime <= now) {
+            nodeids.push_back(it->nodeid);
+        }
+    }
+
+    for (const auto &[i, score] : drawnScores) {
+        slotScores.addScore(i, score);
+    }
+
+    if (nodeids.empty()) {
+        // We failed to find a node to query, flag this so we can request more
+        needMoreNodes = true;
+    }
+
+    return nodeids;
+}
+
 std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
     std::vector<ProofId> invalidProofIds;
     std::vector<ProofRef> newImmatures;
@@ -594,9 +732,11 @@ std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
     {
         LOCK(cs_main);
 
+        // The stateless checks passed upon registration and their outcome
+        // can't change, so only check the proofs against the new chain state.
         for (const auto &p : peers) {
             ProofValidationState state;
-            if (!p.proof->verify(stakeUtxoDustThreshold, chainman, state)) {
+            if (!p.proof->verifyAgainstChain(chainman, state)) {
                 if (isImmatureState(state)) {
                     newImmatures.push_back(p.proof);
                 }
@@ -614,7 +754,7 @@ std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
             [&](const ProofRef &proof) NO_THREAD_SAFETY_ANALYSIS {
                 AssertLockHeld(cs_main);
                 ProofValidationState state;
-                if (!proof->verify(stakeUtxoDustThreshold, chainman, state)) {
+                if (!proof->verifyAgainstChain(chainman, state)) {
                     invalidProofIds.push_back(proof->getId());
 
                     LogPrint(
@@ -800,20 +940,17 @@ bool PeerManager::removePeer(const PeerId peerid) {
 }
 
 PeerId PeerManager::selectPeer() const {
-    if (slots.empty() || slotCount == 0) {
+    // The tree only accounts for the live slots, so unlike a draw over the
+    // whole slot space this never lands on a dead slot and never needs to
+    // retry, whatever the fragmentation.
+    const uint64_t total = slotScores.getTotal();
+    if (total == 0) {
         return NO_PEER;
     }
 
-    const uint64_t max = slotCount;
-    for (int retry = 0; retry < SELECT_PEER_MAX_RETRY; retry++) {
-        size_t i =
-            selectPeerImpl(slots, FastRandomContext().randrange(max), max);
-        if (i != NO_PEER) {
-            return i;
-        }
-    }
-
-    return NO_PEER;
+    const size_t i = slotScores.find(FastRandomContext().randrange(total));
+    assert(i < slots.size());
+    return slots[i].getPeerId();
 }
 
 uint64_t PeerManager::compact() {
@@ -824,6 +961,7 @@ uint64_t PeerManager::compact() {
 
     std::vector<Slot> newslots;
     newslots.reserve(peers.size());
+    slotScores.clear();
 
     uint64_t prevStop = 0;
     uint32_t i = 0;
@@ -833,6 +971,7 @@ uint64_t PeerManager::compact() {
         }
 
         newslots.emplace_back(prevStop, it->getScore(), it->peerid);
+        slotScores.push_back(it->getScore());
         prevStop = newslots.back().getStop();
         if (!peers.modify(it, [&](Peer &p) { p.index = i++; })) {
             return 0;
@@ -849,6 +988,11 @@ uint64_t PeerManager::compact() {
 }
 
 bool PeerManager::verify() const {
+    // The score tree must mirror the slots.
+    if (slotScores.size() != slots.size()) {
+        return false;
+    }
+
     uint64_t prevStop = 0;
     uint32_t scoreFromSlots = 0;
     for (size_t i = 0; i < slots.size(); i++) {
@@ -863,9 +1007,16 @@ bool PeerManager::verify() const {
 
         // If this is a dead slot, then nothing more needs to be checked.
         if (s.getPeerId() == NO_PEER) {
+            if (slotScores.getScore(i) != 0) {
+                return false;
+            }
             continue;
         }
 
+        if (slotScores.getScore(i) != s.getScore()) {
+            return false;
+        }
+
         // We have a live slot, verify index.
         auto it = peers.find(s.getPeerId());
         if (it == peers.end() || it->index != i) {
@@ -982,6 +1133,54 @@ bool PeerManager::verify() const {
     });
 }
 
+uint64_t SlotScoreTree::prefixSum(size_t count) const {
+    assert(count < tree.size());
+
+    uint64_t sum = 0;
+    for (size_t i = count; i > 0; i &= i - 1) {
+        sum += tree[i];
+    }
+
+    return sum;
+}
+
+void SlotScoreTree::push_back(uint32_t score) {
+    // The new node covers the range (i - lowbit(i), i], which is its own score
+    // plus the sum of the slots (i - lowbit(i), i - 1].
+    const size_t i = tree.size();
+    const size_t lowbit = i & -i;
+    tree.push_back(score + prefixSum(i - 1) - prefixSum(i - lowbit));
+}
+
+void SlotScoreTree::setNullScore(size_t index) {
+    const uint64_t score = getScore(index);
+    for (size_t i = index + 1; i < tree.size(); i += i & -i) {
+        tree[i] -= score;
+    }
+}
+
+void SlotScoreTree::addScore(size_t index, uint64_t score) {
+    for (size_t i = index + 1; i < tree.size(); i += i & -i) {
+        tree[i] += score;
+    }
+}
+
+size_t SlotScoreTree::find(uint64_t value) const {
+    assert(value < getTotal());
+
+    // Descend the implicit tree, looking for the largest prefix which sum is
+    // lower or equal to value. The slot right after is the one we want.
+    size_t pos = 0;
+    for (size_t step = std::bit_floor(size()); step > 0; step >>= 1) {
+        if (pos + step < tree.size() && tree[pos + step] <= value) {
+            pos += step;
+            value -= tree[pos];
+        }
+    }
+
+    return pos;
+}
+
 PeerId selectPeerImpl(const std::vector<Slot> &slots, const uint64_t slot,
                       const uint64_t max) {
     assert(slot <= max);
@@ -1335,7 +1534,31 @@ PeerManager::getRemotePresenceStatus(const ProofId &proofid) const {
     return std::nullopt;
 }
 
-bool PeerManager::dumpPeersToFile(const fs::path &dumpPath) const {
+PeerManager::PeersSnapshot PeerManager::getPeersSnapshot() const {
+    PeersSnapshot snapshot;
+    snapshot.time = GetTime<std::chrono::seconds>();
+
+    snapshot.peers.reserve(peers.size());
+    for (const Peer &peer : peers) {
+        snapshot.peers.push_back(
+            {peer.proof, peer.hasFinalized,
+             int64_t(peer.registration_time.count()),
+             int64_t(peer.nextPossibleConflictTime.count())});
+    }
+
+    snapshot.poolProofs.reserve(conflictingProofPool.size() +
+                                immatureProofPool.size());
+    auto addPoolProof = [&](const ProofRef &proof) {
+        snapshot.poolProofs.push_back(proof);
+    };
+    conflictingProofPool.forEachProof(addPoolProof);
+    immatureProofPool.forEachProof(addPoolProof);
+
+    return snapshot;
+}
+
+bool PeerManager::dumpPeersToFile(const PeersSnapshot &snapshot,
+                                  const fs::path &dumpPath) {
     try {
         const fs::path dumpPathTmp = dumpPath + ".new";
         FILE *filestr = fsbridge::fopen(dumpPathTmp, "wb");
@@ -1345,12 +1568,17 @@ bool PeerManager::dumpPeersToFile(const fs::path &dumpPath) const {
 
         AutoFile file{filestr};
         file << PEERS_DUMP_VERSION;
-        file << uint64_t(peers.size());
-        for (const Peer &peer : peers) {
+        file << int64_t(snapshot.time.count());
+        file << uint64_t(snapshot.peers.size());
+        for (const auto &peer : snapshot.peers) {
             file << peer.proof;
             file << peer.hasFinalized;
-            file << int64_t(peer.registration_time.count());
-            file << int64_t(peer.nextPossibleConflictTime.count());
+            file << peer.registrationTime;
+            file << peer.nextPossibleConflictTime;
+        }
+        file << uint64_t(snapshot.poolProofs.size());
+        for (const ProofRef &proof : snapshot.poolProofs) {
+            file << proof;
         }
 
         if (!FileCommit(file.Get())) {
@@ -1370,16 +1598,22 @@ bool PeerManager::dumpPeersToFile(const fs::path &dumpPath) const {
         return false;
     }
 
-    LogPrint(BCLog::AVALANCHE, "Successfully dumped %d peers to %s.\n",
-             peers.size(), PathToString(dumpPath));
+    LogPrint(BCLog::AVALANCHE,
+             "Successfully dumped %d peers and %d pooled proofs to %s.\n",
+             snapshot.peers.size(), snapshot.poolProofs.size(),
+             PathToString(dumpPath));
 
     return true;
 }
 
 bool PeerManager::loadPeersFromFile(
     const fs::path &dumpPath,
-    std::unordered_set<ProofRef, SaltedProofHasher> &registeredProofs) {
+    std::unordered_set<ProofRef, SaltedProofHasher> &registeredProofs,
+    ProofCheckQueue *checkQueue, std::chrono::seconds *dumpTime) {
     registeredProofs.clear();
+    if (dumpTime) {
+        *dumpTime = 0s;
+    }
 
     FILE *filestr = fsbridge::fopen(dumpPath, "rb");
     AutoFile file{filestr};
@@ -1389,62 +1623,124 @@ bool PeerManager::loadPeersFromFile(
         return false;
     }
 
+    using PeerEntry = PeersSnapshot::PeerEntry;
+
+    // Read all the proofs first, so they can be verified as a batch.
+    std::vector<ProofRef> proofs;
+    std::vector<PeerEntry> entries;
+    std::vector<ProofRef> poolProofs;
+    bool success = true;
     try {
         uint64_t version;
         file >> version;
 
-        if (version != PEERS_DUMP_VERSION) {
+        if (version != PEERS_DUMP_VERSION &&
+            version != PEERS_DUMP_VERSION_PEERS_ONLY) {
             LogPrint(BCLog::AVALANCHE,
                      "Unsupported avalanche peers file version.\n");
             return false;
         }
 
+        if (version >= PEERS_DUMP_VERSION) {
+            int64_t time;
+            file >> time;
+            if (dumpTime) {
+                *dumpTime = std::chrono::seconds{time};
+            }
+        }
+
         uint64_t numPeers;
         file >> numPeers;
 
-        auto &peersByProofId = peers.get<by_proofid>();
-
         for (uint64_t i = 0; i < numPeers; i++) {
-            ProofRef proof;
-            bool hasFinalized;
-            int64_t registrationTime;
-            int64_t nextPossibleConflictTime;
-
-            file >> proof;
-            file >> hasFinalized;
-            file >> registrationTime;
-            file >> nextPossibleConflictTime;
-
-            if (registerProof(proof)) {
-                auto it = peersByProofId.find(proof->getId());
-                if (it == peersByProofId.end()) {
-                    // Should never happen
-                    continue;
-                }
+            PeerEntry entry;
+
+            file >> entry.proof;
+            file >> entry.hasFinalized;
+            file >> entry.registrationTime;
+            file >> entry.nextPossibleConflictTime;
 
-                // We don't modify any key so we don't need to rehash.
-                // If the modify fails, it means we don't get the full benefit
-                // from the file but we still added our peer to the set. The
-                // non-overridden fields will be set the normal way.
-                peersByProofId.modify(it, [&](Peer &p) {
-                    p.hasFinalized = hasFinalized;
-                    p.registration_time =
-                        std::chrono::seconds{registrationTime};
-                    p.nextPossibleConflictTime =
-                        std::chrono::seconds{nextPossibleConflictTime};
-                });
-
-                registeredProofs.insert(proof);
+            proofs.push_back(entry.proof);
+            entries.push_back(std::move(entry));
+        }
+
+        if (version >= PEERS_DUMP_VERSION) {
+            uint64_t numPoolProofs;
+            file >> numPoolProofs;
+
+            for (uint64_t i = 0; i < numPoolProofs; i++) {
+                ProofRef proof;
+                file >> proof;
+                poolProofs.push_back(std::move(proof));
             }
         }
     } catch (const std::exception &e) {
         LogPrint(BCLog::AVALANCHE,
                  "Failed to read the avalanche peers file data on disk: %s.\n",
                  e.what());
-        return false;
+        // Still register the peers that could be read.
+        success = false;
+    }
+
+    // Verify the peers and the pooled proofs all at once.
+    const size_t numPeers = proofs.size();
+    proofs.insert(proofs.end(), poolProofs.begin(), poolProofs.end());
+    const auto validationStates = verifyProofs(proofs, checkQueue);
+
+    auto &peersByProofId = peers.get<by_proofid>();
+    for (size_t i = 0; i < numPeers; i++) {
+        // Register the proofs one at a time, so the peers restored from the
+        // file are accounted for when registering the next ones.
+        ProofRegistrationState registrationState;
+        if (!registerProofImpl(proofs[i], registrationState,
+                               RegistrationMode::DEFAULT,
+                               validationStates[i] ? &*validationStates[i]
+                                                   : nullptr)) {
+            continue;
+        }
+
+        auto it = peersByProofId.find(proofs[i]->getId());
+        if (it == peersByProofId.end()) {
+            // Should never happen
+            continue;
+        }
+
+        // We don't modify any key so we don't need to rehash.
+        // If the modify fails, it means we don't get the full benefit
+        // from the file but we still added our peer to the set. The
+        // non-overridden fields will be set the normal way.
+        const PeerEntry &entry = entries[i];
+        peersByProofId.modify(it, [&](Peer &p) {
+            p.hasFinalized = entry.hasFinalized;
+            p.registration_time = std::chrono::seconds{entry.registrationTime};
+            p.nextPossibleConflictTime =
+                std::chrono::seconds{entry.nextPossibleConflictTime};
+        });
+
+        registeredProofs.insert(proofs[i]);
+    }
+
+    // The pooled proofs go through the normal registration so they end up in
+    // the pool matching their current status. Conflicting proofs are kept even
+    // if the cooldown of the restored peers is not elapsed, as they were
+    // already known before the restart.
+    for (size_t i = numPeers; i < proofs.size(); i++) {
+        ProofRegistrationState registrationState;
+        if (registerProofImpl(proofs[i], registrationState,
+                              RegistrationMode::DEFAULT,
+                              validationStates[i] ? &*validationStates[i]
+                                                  : nullptr)) {
+            registeredProofs.insert(proofs[i]);
+            continue;
+        }
+
+        if (registrationState.GetResult() ==
+            ProofRegistrationResult::COOLDOWN_NOT_ELAPSED) {
+            conflictingProofPool.addProofIfPreferred(proofs[i]);
+        }
     }
 
-    return true;
+    return success;
 }
 
 void PeerManager::cleanupStakeContenders(const int requestedMinHeight) {
@@ -11,6 +11,8 @@
 #include <avalanche/proofradixtreeadapter.h>
 #include <avalanche/protocol.h>
 #include <avalanche/stakecontendercache.h>
+#include <avalanche/validation.h>
+#include <checkqueue.h>
 #include <common/bloom.h>
 #include <consensus/validation.h>
 #include <radix.h>
@@ -29,6 +31,7 @@
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 
 class ChainstateManager;
@@ -81,6 +84,42 @@ public:
     bool follows(uint64_t slot) const { return getStart() > slot; }
 };
 
+/**
+ * Fenwick tree mirroring the scores of the slots, in the same order. Dead
+ * slots are given a null score so they can never be drawn, which makes peer
+ * selection O(log n) without depending on the slots being compacted.
+ */
+class SlotScoreTree {
+    /**
+     * tree[i] holds the sum of the scores of the slots in the range
+     * (i - lowbit(i), i], with 1-based indices.
+     */
+    std::vector<uint64_t> tree{0};
+
+    uint64_t prefixSum(size_t count) const;
+
+public:
+    size_t size() const { return tree.size() - 1; }
+    uint64_t getTotal() const { return prefixSum(size()); }
+    uint64_t getScore(size_t index) const {
+        return prefixSum(index + 1) - prefixSum(index);
+    }
+
+    void clear() { tree.assign(1, 0); }
+    void push_back(uint32_t score);
+    void pop_back() { tree.pop_back(); }
+    void setNullScore(size_t index);
+    /** Add to the score of a slot, e.g. to restore it after it was nulled. */
+    void addScore(size_t index, uint64_t score);
+
+    /**
+     * Return the index of the slot covering the given value, which must be
+     * strictly lower than getTotal(). Slots with a null score are never
+     * returned.
+     */
+    size_t find(uint64_t value) const;
+};
+
 struct Peer {
     PeerId peerid;
     uint32_t index = -1;
@@ -156,10 +195,36 @@ enum class ProofRegistrationResult {
 class ProofRegistrationState : public ValidationState<ProofRegistrationResult> {
 };
 
+/**
+ * Run the stateless checks of a proof, so they can be spread over the workers
+ * of a CCheckQueue. The result is written to the provided state and the check
+ * never reports a failure to the queue, so a bad proof doesn't prevent the
+ * other proofs of the batch from being checked.
+ */
+class ProofStatelessCheck {
+    ProofRef proof;
+    Amount stakeUtxoDustThreshold;
+    ProofValidationState *state;
+
+public:
+    ProofStatelessCheck(ProofRef proofIn, Amount stakeUtxoDustThresholdIn,
+                        ProofValidationState *stateIn)
+        : proof(std::move(proofIn)),
+          stakeUtxoDustThreshold(stakeUtxoDustThresholdIn), state(stateIn) {}
+
+    std::optional<int> operator()() {
+        proof->verify(stakeUtxoDustThreshold, *state);
+        return std::nullopt;
+    }
+};
+
+using ProofCheckQueue = CCheckQueue<ProofStatelessCheck>;
+
 namespace bmi = boost::multi_index;
 
 class PeerManager {
     std::vector<Slot> slots;
+    SlotScoreTree slotScores;
     uint64_t slotCount = 0;
     uint64_t fragmentation = 0;
 
@@ -223,9 +288,15 @@ class PeerManager {
                 bmi::member<PendingNode, NodeId, &PendingNode::nodeid>>>>;
     PendingNodeSet pendingNodes;
 
-    static constexpr int SELECT_PEER_MAX_RETRY = 3;
     static constexpr int SELECT_NODE_MAX_RETRY = 3;
 
+    /**
+     * The slots are compacted when the dead slots account for more than half
+     * of the slot space, once there are at least this many slots. This bounds
+     * the memory and the slot score tree updates as the peers come and go.
+     */
+    static constexpr size_t COMPACT_MIN_SLOTS = 64;
+
     /**
      * Track proof ids to broadcast
      */
@@ -332,6 +403,13 @@ public:
     // Randomly select a node to poll.
     NodeId selectNode();
 
+    /**
+     * Randomly select up to count nodes to poll, from distinct peers. The
+     * peers are drawn by score without replacement, so this returns fewer
+     * nodes only if fewer peers have a node available.
+     */
+    std::vector<NodeId> selectNodes(size_t count);
+
     /**
      * Returns true if we encountered a lack of node since the last call.
      */
@@ -389,6 +467,17 @@ public:
         return registerProof(proof, dummy, mode);
     }
 
+    /**
+     * Same as registerProof, but the stateless checks have already been run by
+     * the caller, typically without holding the peer manager lock, and their
+     * result is passed via statelessState. Only the checks against the chain
+     * state are left to do.
+     */
+    bool registerVerifiedProof(
+        const ProofRef &proof, const ProofValidationState &statelessState,
+        ProofRegistrationState &registrationState,
+        RegistrationMode mode = RegistrationMode::DEFAULT);
+
     /**
      * Rejection mode
      *  - DEFAULT: Default policy, reject a proof and attempt to keep it in the
@@ -541,15 +630,65 @@ public:
         const CBlockIndex *pprev,
         std::vector<std::pair<ProofId, CScript>> &winners);
 
-    bool dumpPeersToFile(const fs::path &dumpPath) const;
+    /**
+     * Copy of the state that is persisted to disk. It only holds references
+     * to the proofs so it is cheap to build, and it can be written to disk
+     * without holding the peer manager lock.
+     */
+    struct PeersSnapshot {
+        struct PeerEntry {
+            ProofRef proof;
+            bool hasFinalized;
+            int64_t registrationTime;
+            int64_t nextPossibleConflictTime;
+        };
+
+        std::chrono::seconds time;
+        std::vector<PeerEntry> peers;
+        /** Proofs from the conflicting and immature pools. */
+        std::vector<ProofRef> poolProofs;
+    };
+
+    PeersSnapshot getPeersSnapshot() const;
+    static bool dumpPeersToFile(const PeersSnapshot &snapshot,
+                                const fs::path &dumpPath);
+    bool dumpPeersToFile(const fs::path &dumpPath) const {
+        return dumpPeersToFile(getPeersSnapshot(), dumpPath);
+    }
+    /**
+     * Load the peers and the pools content from the file, verifying all the
+     * proofs as a batch. If dumpTime is not null, it is set to the time the
+     * file was written, or 0 if it is unknown.
+     */
     bool loadPeersFromFile(
         const fs::path &dumpPath,
-        std::unordered_set<ProofRef, SaltedProofHasher> &registeredProofs);
+        std::unordered_set<ProofRef, SaltedProofHasher> &registeredProofs,
+        ProofCheckQueue *checkQueue = nullptr,
+        std::chrono::seconds *dumpTime = nullptr);
 
 private:
     template <typename ProofContainer>
     void moveToConflictingPool(const ProofContainer &proofs);
 
+    /**
+     * Registration logic shared by the registerProof variants. If
+     * validationState is not null it holds the result of the complete proof
+     * verification, otherwise the proof is verified here.
+     */
+    bool registerProofImpl(const ProofRef &proof,
+                           ProofRegistrationState &registrationState,
+                           RegistrationMode mode,
+                           const ProofValidationState *validationState);
+
+    /**
+     * Fully verify a batch of proofs, spreading the stateless checks over the
+     * check queue workers if any and checking all the utxos under a single
+     * cs_main lock. The proofs that are already known are left unverified.
+     */
+    std::vector<std::optional<ProofValidationState>>
+    verifyProofs(const std::vector<ProofRef> &proofs,
+                 ProofCheckQueue *checkQueue) const;
+
     bool addOrUpdateNode(const PeerSet::iterator &it, NodeId nodeid,
                          size_t max_elements);
     bool addNodeToPeer(const PeerSet::iterator &it);
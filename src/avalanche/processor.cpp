@@ -5,6 +5,7 @@
 #include <avalanche/processor.h>
 
 #include <avalanche/avalanche.h>
+#include <avalanche/compactpoll.h>
 #include <avalanche/delegationbuilder.h>
 #include <avalanche/peermanager.h>
 #include <avalanche/proofcomparator.h>
@@ -25,8 +26,10 @@
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
+#include <optional>
 #include <tuple>
 
 /**
@@ -189,12 +192,39 @@ Processor::Processor(Config avaconfigIn, interfaces::Chain &chain,
         return;
     }
 
+    scheduler.scheduleEvery(
+        [this]() -> bool {
+            dumpPeers();
+            return true;
+        },
+        AVALANCHE_PEERS_DUMP_INTERVAL);
+
     std::unordered_set<ProofRef, SaltedProofHasher> registeredProofs;
 
-    // Attempt to load the peer file if it exists.
+    // Attempt to load the peer file if it exists. There can be thousands of
+    // proofs to verify, so spread the work over the same number of threads as
+    // the script checks. The threads are only needed for the duration of the
+    // load.
     const fs::path dumpPath = gArgs.GetDataDirNet() / AVAPEERS_FILE_NAME;
-    WITH_LOCK(cs_peerManager, return peerManager->loadPeersFromFile(
-                                  dumpPath, registeredProofs));
+    std::chrono::seconds dumpTime{0};
+    {
+        ProofCheckQueue checkQueue(/*batch_size=*/16,
+                                   chainman.m_options.worker_threads_num,
+                                   "avaproofch");
+        WITH_LOCK(cs_peerManager,
+                  return peerManager->loadPeersFromFile(
+                      dumpPath, registeredProofs, &checkQueue, &dumpTime));
+    }
+
+    // If the file is recent enough, the peers it contains are a good enough
+    // approximation of what the avaproofs messages would tell us, so there is
+    // no need to wait for them before the quorum can be established.
+    const std::chrono::seconds maxDumpAge{gArgs.GetIntArg(
+        "-avapeersdumpmaxage", AVALANCHE_DEFAULT_PEERS_DUMP_MAX_AGE.count())};
+    const auto dumpAge = GetTime<std::chrono::seconds>() - dumpTime;
+    loadedRecentPeers = maxDumpAge > 0s && dumpTime > 0s &&
+                        !registeredProofs.empty() && dumpAge >= 0s &&
+                        dumpAge <= maxDumpAge;
 
     // We just loaded the previous finalization status, but make sure to trigger
     // another round of vote for these proofs to avoid issue if the network
@@ -216,9 +246,19 @@ Processor::~Processor() {
         return;
     }
 
-    LOCK(cs_peerManager);
+    dumpPeers();
+}
+
+void Processor::dumpPeers() {
+    // Only hold the peer manager lock while gathering the data, the slow part
+    // is writing the file.
+    const auto snapshot =
+        WITH_LOCK(cs_peerManager, return peerManager->getPeersSnapshot());
+
+    LOCK(cs_peersDump);
     // Discard the status output: if it fails we want to continue normally.
-    peerManager->dumpPeersToFile(gArgs.GetDataDirNet() / AVAPEERS_FILE_NAME);
+    PeerManager::dumpPeersToFile(snapshot,
+                                 gArgs.GetDataDirNet() / AVAPEERS_FILE_NAME);
 }
 
 std::unique_ptr<Processor>
@@ -400,7 +440,17 @@ Processor::MakeProcessor(const ArgsManager &argsman, interfaces::Chain &chain,
         return nullptr;
     }
 
-    Config avaconfig(queryTimeoutDuration);
+    int64_t pollFanout =
+        argsman.GetIntArg("-avapollfanout", AVALANCHE_DEFAULT_POLL_FANOUT);
+    if (pollFanout <= 0 || pollFanout > std::numeric_limits<uint32_t>::max()) {
+        error = strprintf(
+            _("The -avapollfanout value must be between 1 and %d"),
+            std::numeric_limits<uint32_t>::max());
+        return nullptr;
+    }
+
+    // This is safe because we ensure size_t is >= 32 bits in assumptions.h
+    Config avaconfig(queryTimeoutDuration, static_cast<size_t>(pollFanout));
 
     int64_t maxElementPoll = argsman.GetIntArg(
         "-avamaxelementpoll", DEFAULT_AVALANCHE_MAX_ELEMENT_POLL);
@@ -452,7 +502,8 @@ bool Processor::addToReconcile(const AnyVoteItem &item) {
     // the calls or we get a deadlock.
     const bool accepted = getLocalAcceptance(item);
 
-    return voteRecords.getWriteView()
+    return getVoteRecords(item)
+        .getWriteView()
         ->insert(std::make_pair(item, VoteRecord(accepted)))
         .second;
 }
@@ -481,7 +532,7 @@ bool Processor::isAccepted(const AnyVoteItem &item) const {
         return false;
     }
 
-    auto r = voteRecords.getReadView();
+    auto r = getVoteRecords(item).getReadView();
     auto it = r->find(item);
     if (it == r.end()) {
         return false;
@@ -495,7 +546,7 @@ int Processor::getConfidence(const AnyVoteItem &item) const {
         return -1;
     }
 
-    auto r = voteRecords.getReadView();
+    auto r = getVoteRecords(item).getReadView();
     auto it = r->find(item);
     if (it == r.end()) {
         return -1;
@@ -509,7 +560,7 @@ bool Processor::isPolled(const AnyVoteItem &item) const {
         return false;
     }
 
-    auto r = voteRecords.getReadView();
+    auto r = getVoteRecords(item).getReadView();
     auto it = r->find(item);
     return it != r.end();
 }
@@ -535,10 +586,13 @@ namespace {
     class TCPResponse {
         Response response;
         SchnorrSig sig;
+        // The signature always commits to the full response, even when it is
+        // sent in the compact format.
+        bool compact;
 
     public:
-        TCPResponse(Response responseIn, const CKey &key)
-            : response(std::move(responseIn)) {
+        TCPResponse(Response responseIn, const CKey &key, bool compactIn)
+            : response(std::move(responseIn)), compact(compactIn) {
             HashWriter hasher{};
             hasher << response;
             const uint256 hash = hasher.GetHash();
@@ -550,16 +604,57 @@ namespace {
         }
 
         // serialization support
-        SERIALIZE_METHODS(TCPResponse, obj) {
-            READWRITE(obj.response, obj.sig);
+        template <typename Stream> void Serialize(Stream &s) const {
+            if (compact) {
+                s << CompactResponse(response);
+            } else {
+                s << response;
+            }
+            s << sig;
         }
     };
 } // namespace
 
 void Processor::sendResponse(CNode *pfrom, Response response) const {
+    const bool compact =
+        pfrom->GetCommonVersion() >= AVALANCHE_COMPACT_POLL_VERSION;
     connman->PushMessage(
-        pfrom, NetMsg::Make(NetMsgType::AVARESPONSE,
-                            TCPResponse(std::move(response), sessionKey)));
+        pfrom,
+        NetMsg::Make(NetMsgType::AVARESPONSE,
+                     TCPResponse(std::move(response), sessionKey, compact)));
+}
+
+size_t Processor::getMaxPendingPollSize(NodeId nodeid) const {
+    size_t maxSize = 0;
+    auto r = queries.getReadView();
+    for (const Query &query : r) {
+        if (query.nodeid == nodeid) {
+            maxSize = std::max(maxSize, query.invs.size());
+        }
+    }
+    return maxSize;
+}
+
+bool Processor::expandCompactResponse(NodeId nodeid,
+                                      const CompactResponse &compactResponse,
+                                      Response &response, bool &disconnect,
+                                      std::string &error) const {
+    disconnect = false;
+
+    auto r = queries.getReadView();
+    auto it = r->find(std::make_tuple(nodeid, compactResponse.getRound()));
+    if (it == r.end()) {
+        error = "unexpected-ava-response";
+        return false;
+    }
+
+    if (!compactResponse.expand(it->invs, response)) {
+        disconnect = true;
+        error = "invalid-ava-response-size";
+        return false;
+    }
+
+    return true;
 }
 
 bool Processor::registerVotes(NodeId nodeid, const Response &response,
@@ -611,8 +706,9 @@ bool Processor::registerVotes(NodeId nodeid, const Response &response,
 
     // At this stage we are certain that invs[i] matches votes[i], so we can use
     // the inv type to retrieve what is being voted on.
+    std::vector<AnyVoteItem> items = getVoteItemsFromInvs(invs);
     for (size_t i = 0; i < size; i++) {
-        auto item = getVoteItemFromInv(invs[i]);
+        auto &item = items[i];
 
         if (isNull(item)) {
             // This should not happen, but just in case...
@@ -627,15 +723,25 @@ bool Processor::registerVotes(NodeId nodeid, const Response &response,
         responseItems.insert(std::make_pair(std::move(item), votes[i]));
     }
 
-    auto voteRecordsWriteView = voteRecords.getWriteView();
+    // The response items are sorted by type, so we only need to lock each
+    // shard once.
+    std::optional<RWCollection<VoteMap>::WriteView> voteRecordsWriteView;
+    size_t lockedShard = voteRecords.size();
 
     // Register votes.
     for (const auto &p : responseItems) {
         auto item = p.first;
         const Vote &v = p.second;
 
-        auto it = voteRecordsWriteView->find(item);
-        if (it == voteRecordsWriteView.end()) {
+        if (item.index() != lockedShard) {
+            // Release the previous shard before locking the next one
+            voteRecordsWriteView.reset();
+            voteRecordsWriteView.emplace(getVoteRecords(item).getWriteView());
+            lockedShard = item.index();
+        }
+
+        auto it = (*voteRecordsWriteView)->find(item);
+        if (it == (*voteRecordsWriteView)->end()) {
             // We are not voting on that item anymore.
             continue;
         }
@@ -647,7 +753,7 @@ bool Processor::registerVotes(NodeId nodeid, const Response &response,
 
                 // Just drop stale votes. If we see this item again, we'll
                 // do a new vote.
-                voteRecordsWriteView->erase(it);
+                (*voteRecordsWriteView)->erase(it);
             }
             // This vote did not provide any extra information, move on.
             continue;
@@ -667,8 +773,9 @@ bool Processor::registerVotes(NodeId nodeid, const Response &response,
         updates.emplace_back(std::move(item), vr.isAccepted()
                                                   ? VoteStatus::Finalized
                                                   : VoteStatus::Invalid);
-        voteRecordsWriteView->erase(it);
+        (*voteRecordsWriteView)->erase(it);
     }
+    voteRecordsWriteView.reset();
 
     // FIXME This doesn't belong here as it has nothing to do with vote
     // registration.
@@ -866,7 +973,7 @@ bool Processor::isQuorumEstablished() {
         return false;
     }
 
-    if (avaproofsNodeCounter < minAvaproofsNodeCount) {
+    if (!loadedRecentPeers && avaproofsNodeCounter < minAvaproofsNodeCount) {
         return false;
     }
 
@@ -1239,102 +1346,141 @@ void Processor::runEventLoop() {
 
     clearInvsNotWorthPolling();
 
-    NodeId nodeid{NO_NODE};
-    do {
-        std::vector<CInv> invs;
+    while (true) {
+        std::vector<CInv> undelivered;
+        size_t sent = 0;
 
         {
-            // Build a unique pointer to the read view of vote records.
-            // This is so we can release the lock immediately after we have
-            // gathered the invs to poll and avoid a lock inversion with the
-            // peer manager lock.
-            auto voteRecordsReadView =
-                std::make_unique<decltype(voteRecords.getReadView())>(
-                    voteRecords.getReadView());
+            // Grab the read views of vote records before the peer manager
+            // lock to avoid a lock inversion. They are released as soon as we
+            // have gathered the invs to poll.
+            VoteMapReadViews voteRecordsReadViews = getVoteRecordsReadViews();
 
             LOCK(cs_peerManager);
 
-            // Make sure there is at least one suitable node to query before
+            // Select up to pollFanout nodes of distinct peers to query before
             // gathering invs.
-            nodeid = peerManager->selectNode();
-            if (nodeid == NO_NODE) {
+            const std::vector<NodeId> nodeids =
+                peerManager->selectNodes(avaconfig.pollFanout);
+            std::vector<size_t> max_elements;
+            max_elements.reserve(nodeids.size());
+            for (const NodeId nodeid : nodeids) {
+                size_t node_max_elements = AVALANCHE_MAX_ELEMENT_POLL_LEGACY;
+                peerManager->forNode(nodeid,
+                                     [&node_max_elements](const Node &node) {
+                                         node_max_elements = node.maxElements;
+                                         return true;
+                                     });
+                max_elements.push_back(node_max_elements);
+            }
+
+            if (nodeids.empty()) {
                 return;
             }
 
-            size_t max_elements = AVALANCHE_MAX_ELEMENT_POLL_LEGACY;
-            peerManager->forNode(nodeid, [&max_elements](const Node &node) {
-                max_elements = node.maxElements;
-                return true;
-            });
+            std::vector<std::vector<CInv>> polls =
+                getInvsForNextPolls(voteRecordsReadViews, max_elements);
 
-            invs = getInvsForNextPoll(*voteRecordsReadView, max_elements);
-            if (invs.empty()) {
-                return;
+            // Release the read locks on vote records
+            voteRecordsReadViews.clear();
+
+            const auto timeout =
+                Now<SteadyMilliseconds>() + avaconfig.queryTimeoutDuration;
+
+            for (size_t i = 0; i < nodeids.size(); i++) {
+                std::vector<CInv> &invs = polls[i];
+                if (invs.empty()) {
+                    // The polls are filled in order, so there is nothing left
+                    // to poll for the next nodes either.
+                    break;
+                }
+
+                /**
+                 * If we lost contact to that node, then we remove it from
+                 * nodeids, but never add the request to queries, which ensures
+                 * bad nodes get cleaned up over time. Keep a copy of invs for
+                 * inflight rollback if the send fails (registerPoll already ran
+                 * during gather).
+                 */
+                bool hasSent = connman->ForNode(
+                    nodeids[i],
+                    [this, invs, &timeout](CNode *pnode)
+                        EXCLUSIVE_LOCKS_REQUIRED(cs_peerManager) mutable {
+                            uint64_t current_round = round++;
+
+                            // Register the query.
+                            queries.getWriteView()->insert(
+                                {pnode->GetId(), current_round, timeout, invs});
+                            // Set the timeout.
+                            peerManager->updateNextRequestTimeForPoll(
+                                pnode->GetId(), timeout, current_round);
+
+                            pnode->invsPolled(invs.size());
+
+                            // Send the query to the node.
+                            if (pnode->GetCommonVersion() >=
+                                AVALANCHE_COMPACT_POLL_VERSION) {
+                                CompactPoll compactPoll = WITH_LOCK(
+                                    pnode->m_avalanche_poll_encoder_mutex,
+                                    return pnode->m_avalanche_poll_encoder
+                                        .encode(current_round, invs));
+                                connman->PushMessage(
+                                    pnode, NetMsg::Make(NetMsgType::AVAPOLL,
+                                                        compactPoll));
+                                return true;
+                            }
+
+                            connman->PushMessage(
+                                pnode,
+                                NetMsg::Make(
+                                    NetMsgType::AVAPOLL,
+                                    Poll(current_round, std::move(invs))));
+                            return true;
+                        });
+
+                if (hasSent) {
+                    sent++;
+                    continue;
+                }
+
+                // This node is obsolete, delete it.
+                peerManager->removeNode(nodeids[i]);
+                undelivered.insert(undelivered.end(), invs.begin(), invs.end());
             }
 
-            // Release the read lock on vote records
-            voteRecordsReadView.reset();
-
-            /**
-             * If we lost contact to that node, then we remove it from nodeids,
-             * but never add the request to queries, which ensures bad nodes get
-             * cleaned up over time. Keep a copy of invs for inflight rollback
-             * if the send fails (registerPoll already ran during gather).
-             */
-            bool hasSent = connman->ForNode(
-                nodeid, [this, invs](CNode *pnode) EXCLUSIVE_LOCKS_REQUIRED(
-                            cs_peerManager) mutable {
-                    uint64_t current_round = round++;
-
-                    {
-                        // Compute the time at which this requests times out.
-                        auto timeout = Now<SteadyMilliseconds>() +
-                                       avaconfig.queryTimeoutDuration;
-                        // Register the query.
-                        queries.getWriteView()->insert(
-                            {pnode->GetId(), current_round, timeout, invs});
-                        // Set the timeout.
-                        peerManager->updateNextRequestTimeForPoll(
-                            pnode->GetId(), timeout, current_round);
-                    }
-
-                    pnode->invsPolled(invs.size());
-
-                    // Send the query to the node.
-                    connman->PushMessage(
-                        pnode,
-                        NetMsg::Make(NetMsgType::AVAPOLL,
-                                     Poll(current_round, std::move(invs))));
-                    return true;
-                });
-
-            // Success!
-            if (hasSent) {
+            if (polls.front().empty()) {
+                // Nothing to poll
                 return;
             }
-
-            // This node is obsolete, delete it.
-            peerManager->removeNode(nodeid);
         }
 
         // Roll back inflight counters for the polls that were never dispatched.
         // Done after releasing cs_peerManager to avoid lock inversion with
         // voteRecords.
-        std::map<CInv, uint8_t> undelivered;
-        for (const CInv &inv : invs) {
-            undelivered[inv]++;
+        std::map<CInv, uint8_t> undeliveredCount;
+        for (const CInv &inv : undelivered) {
+            undeliveredCount[inv]++;
+        }
+        clearInflightRequests(undeliveredCount);
+
+        // Success!
+        if (sent > 0) {
+            return;
         }
-        clearInflightRequests(undelivered);
-    } while (nodeid != NO_NODE);
+
+        // All the selected nodes were obsolete, try again with other nodes.
+    }
 }
 
 void Processor::clearInvsNotWorthPolling() {
-    auto w = voteRecords.getWriteView();
-    for (auto it = w->begin(); it != w->end();) {
-        if (!isWorthPolling(it->first)) {
-            it = w->erase(it);
-        } else {
-            ++it;
+    for (auto &shard : voteRecords) {
+        auto w = shard.getWriteView();
+        for (auto it = w->begin(); it != w->end();) {
+            if (!isWorthPolling(it->first)) {
+                it = w->erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 }
@@ -1365,14 +1511,23 @@ void Processor::clearInflightRequests(
         return;
     }
 
-    auto voteRecordsReadView = voteRecords.getReadView();
+    std::vector<CInv> invs;
+    invs.reserve(inflightRequests.size());
+    for (const auto &inflightRequest : inflightRequests) {
+        invs.push_back(inflightRequest.first);
+    }
+    const std::vector<AnyVoteItem> items = getVoteItemsFromInvs(invs);
+
+    auto voteRecordsReadViews = getVoteRecordsReadViews();
+    size_t i = 0;
     for (const auto &inflightRequest : inflightRequests) {
-        auto item = getVoteItemFromInv(inflightRequest.first);
+        const auto &item = items[i++];
 
         if (isNull(item)) {
             continue;
         }
 
+        const auto &voteRecordsReadView = voteRecordsReadViews[item.index()];
         auto it = voteRecordsReadView->find(item);
         if (it == voteRecordsReadView.end()) {
             continue;
@@ -1382,73 +1537,174 @@ void Processor::clearInflightRequests(
     }
 }
 
+VoteMapReadViews Processor::getVoteRecordsReadViews() const {
+    VoteMapReadViews views;
+    views.reserve(voteRecords.size());
+    for (const auto &shard : voteRecords) {
+        views.push_back(shard.getReadView());
+    }
+    return views;
+}
+
+static CInv buildInvFromVoteItem(const AnyVoteItem &item) {
+    return std::visit(
+        variant::overloaded{
+            [](const ProofRef &proof) {
+                return CInv(MSG_AVA_PROOF, proof->getId());
+            },
+            [](const CBlockIndex *pindex) {
+                return CInv(MSG_BLOCK, pindex->GetBlockHash());
+            },
+            [](const StakeContenderId &contenderId) {
+                return CInv(MSG_AVA_STAKE_CONTENDER, contenderId);
+            },
+            [](const CTransactionRef &tx) {
+                return CInv(MSG_TX, tx->GetHash());
+            },
+        },
+        item);
+}
+
 std::vector<CInv> Processor::getInvsForNextPoll(
-    RWCollection<VoteMap>::ReadView &voteRecordsReadView, size_t max_elements,
+    const VoteMapReadViews &voteRecordsReadViews, size_t max_elements,
     bool forPoll) const {
     std::vector<CInv> invs;
 
-    auto buildInvFromVoteItem = variant::overloaded{
-        [](const ProofRef &proof) {
-            return CInv(MSG_AVA_PROOF, proof->getId());
-        },
-        [](const CBlockIndex *pindex) {
-            return CInv(MSG_BLOCK, pindex->GetBlockHash());
-        },
-        [](const StakeContenderId &contenderId) {
-            return CInv(MSG_AVA_STAKE_CONTENDER, contenderId);
-        },
-        [](const CTransactionRef &tx) { return CInv(MSG_TX, tx->GetHash()); },
-    };
+    for (const auto &voteRecordsReadView : voteRecordsReadViews) {
+        for (const auto &[item, voteRecord] : voteRecordsReadView) {
+            if (invs.size() >= max_elements) {
+                // Make sure we do not produce more invs than specified by the
+                // protocol.
+                return invs;
+            }
 
-    for (const auto &[item, voteRecord] : voteRecordsReadView) {
-        if (invs.size() >= max_elements) {
-            // Make sure we do not produce more invs than specified by the
-            // protocol.
-            return invs;
-        }
+            const bool shouldPoll =
+                forPoll ? voteRecord.registerPoll() : voteRecord.shouldPoll();
 
-        const bool shouldPoll =
-            forPoll ? voteRecord.registerPoll() : voteRecord.shouldPoll();
+            if (!shouldPoll) {
+                continue;
+            }
 
-        if (!shouldPoll) {
-            continue;
+            invs.emplace_back(buildInvFromVoteItem(item));
         }
-
-        invs.emplace_back(std::visit(buildInvFromVoteItem, item));
     }
 
     return invs;
 }
 
-AnyVoteItem Processor::getVoteItemFromInv(const CInv &inv) const {
-    if (inv.IsMsgBlk()) {
-        return WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(
-                                      BlockHash(inv.hash)));
+std::vector<std::vector<CInv>> Processor::getInvsForNextPolls(
+    const VoteMapReadViews &voteRecordsReadViews,
+    const std::vector<size_t> &max_elements) const {
+    std::vector<std::vector<CInv>> polls(max_elements.size());
+
+    // Index of the first poll that still has room. Items are handed out in
+    // order so the polls are filled one after the other.
+    size_t first = 0;
+    for (const auto &voteRecordsReadView : voteRecordsReadViews) {
+        for (const auto &[item, voteRecord] : voteRecordsReadView) {
+            while (first < polls.size() &&
+                   polls[first].size() >= max_elements[first]) {
+                first++;
+            }
+            if (first >= polls.size()) {
+                // Make sure we do not produce more invs than specified by the
+                // protocol.
+                return polls;
+            }
+
+            std::optional<CInv> inv;
+            for (size_t i = first; i < polls.size(); i++) {
+                if (polls[i].size() >= max_elements[i]) {
+                    continue;
+                }
+
+                // This fails once the item reached the max inflight count
+                if (!voteRecord.registerPoll()) {
+                    break;
+                }
+
+                if (!inv) {
+                    inv = buildInvFromVoteItem(item);
+                }
+                polls[i].push_back(*inv);
+            }
+        }
     }
 
-    if (inv.IsMsgProof()) {
-        return WITH_LOCK(cs_peerManager,
-                         return peerManager->getProof(ProofId(inv.hash)));
+    return polls;
+}
+
+std::vector<AnyVoteItem>
+Processor::getVoteItemsFromInvs(const std::vector<CInv> &invs) const {
+    const size_t size = invs.size();
+
+    bool hasBlocks{false};
+    bool hasProofs{false};
+    bool hasTxs{false};
+    for (const CInv &inv : invs) {
+        hasBlocks |= inv.IsMsgBlk();
+        hasProofs |= inv.IsMsgProof();
+        hasTxs |= inv.IsMsgTx();
+    }
+
+    std::vector<const CBlockIndex *> blocks(size, nullptr);
+    if (hasBlocks) {
+        LOCK(cs_main);
+        for (size_t i = 0; i < size; i++) {
+            if (invs[i].IsMsgBlk()) {
+                blocks[i] = chainman.m_blockman.LookupBlockIndex(
+                    BlockHash(invs[i].hash));
+            }
+        }
     }
 
-    if (inv.IsMsgStakeContender()) {
-        return StakeContenderId(inv.hash);
+    std::vector<ProofRef> proofs(size);
+    if (hasProofs) {
+        LOCK(cs_peerManager);
+        for (size_t i = 0; i < size; i++) {
+            if (invs[i].IsMsgProof()) {
+                proofs[i] = peerManager->getProof(ProofId(invs[i].hash));
+            }
+        }
     }
 
-    if (mempool && inv.IsMsgTx()) {
+    std::vector<CTransactionRef> txs(size);
+    if (mempool && hasTxs) {
         LOCK(mempool->cs);
-        if (CTransactionRef tx = mempool->get(TxId(inv.hash))) {
-            return tx;
+        for (size_t i = 0; i < size; i++) {
+            if (!invs[i].IsMsgTx()) {
+                continue;
+            }
+
+            const TxId txid(invs[i].hash);
+            txs[i] = mempool->get(txid);
+            if (!txs[i]) {
+                txs[i] = mempool->withConflicting(
+                    [&txid](const TxConflicting &conflicting) {
+                        return conflicting.GetTx(txid);
+                    });
+            }
         }
-        if (CTransactionRef tx = mempool->withConflicting(
-                [&inv](const TxConflicting &conflicting) {
-                    return conflicting.GetTx(TxId(inv.hash));
-                })) {
-            return tx;
+    }
+
+    std::vector<AnyVoteItem> items;
+    items.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        const CInv &inv = invs[i];
+        if (inv.IsMsgBlk()) {
+            items.emplace_back(blocks[i]);
+        } else if (inv.IsMsgProof()) {
+            items.emplace_back(std::move(proofs[i]));
+        } else if (inv.IsMsgStakeContender()) {
+            items.emplace_back(StakeContenderId(inv.hash));
+        } else if (inv.IsMsgTx()) {
+            items.emplace_back(std::move(txs[i]));
+        } else {
+            items.emplace_back(static_cast<const CBlockIndex *>(nullptr));
         }
     }
 
-    return {nullptr};
+    return items;
 }
 
 bool Processor::IsWorthPolling::operator()(const CBlockIndex *pindex) const {
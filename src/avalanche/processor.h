@@ -14,7 +14,7 @@
 #include <avalanche/voterecord.h> // For AVALANCHE_MAX_INFLIGHT_POLL
 #include <blockindex.h>
 #include <blockindexcomparators.h>
-#include <common/bloom.h>
+#include <common/rollingidset.h>
 #include <eventloop.h>
 #include <interfaces/chain.h>
 #include <interfaces/handler.h>
@@ -32,6 +32,7 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -68,6 +69,25 @@ static constexpr size_t AVALANCHE_MAX_ELEMENT_POLL_LEGACY = 16;
  */
 static constexpr size_t AVALANCHE_CONTENDER_MAX_POLLABLE = 12;
 
+/**
+ * Maximum number of nodes to poll per event loop iteration. Can be overridden
+ * by the -avapollfanout option.
+ */
+static constexpr size_t AVALANCHE_DEFAULT_POLL_FANOUT = 1;
+
+/**
+ * How often the avalanche peers are saved to disk when -persistavapeers is
+ * set, so a crash doesn't lose the state gathered since the startup.
+ */
+static constexpr std::chrono::minutes AVALANCHE_PEERS_DUMP_INTERVAL{10};
+
+/**
+ * Maximum age of the avalanche peers file for its content to be trusted in
+ * place of the avaproofs messages from the network when establishing the
+ * quorum. Zero disables it. Can be overridden by -avapeersdumpmaxage.
+ */
+static constexpr std::chrono::seconds AVALANCHE_DEFAULT_PEERS_DUMP_MAX_AGE{0};
+
 /**
  * How long before we consider that a query timed out.
  */
@@ -87,6 +107,7 @@ static constexpr uint32_t AVALANCHE_FINALIZED_ITEMS_FILTER_NUM_ELEMENTS =
 
 namespace avalanche {
 
+class CompactResponse;
 class Delegation;
 class PeerManager;
 class ProofRegistrationState;
@@ -156,6 +177,7 @@ struct VoteMapComparator {
     }
 };
 using VoteMap = std::map<AnyVoteItem, VoteRecord, VoteMapComparator>;
+using VoteMapReadViews = std::vector<RWCollection<VoteMap>::ReadView>;
 
 struct query_timeout {};
 
@@ -172,9 +194,22 @@ class Processor final : public NetEventsInterface {
     CTxMemPool *mempool;
 
     /**
-     * Items to run avalanche on.
+     * Items to run avalanche on, sharded by item type so that registering
+     * votes for an item type doesn't block the others. Because VoteMap sorts
+     * by item type first, walking the shards in order is equivalent to walking
+     * a single map.
      */
-    RWCollection<VoteMap> voteRecords;
+    std::array<RWCollection<VoteMap>, std::variant_size_v<AnyVoteItem>>
+        voteRecords;
+
+    RWCollection<VoteMap> &getVoteRecords(const AnyVoteItem &item) {
+        return voteRecords[item.index()];
+    }
+    const RWCollection<VoteMap> &getVoteRecords(const AnyVoteItem &item) const {
+        return voteRecords[item.index()];
+    }
+    /** Read lock all the shards, always in the same order. */
+    VoteMapReadViews getVoteRecordsReadViews() const;
 
     /**
      * Keep track of peers and queries sent.
@@ -234,6 +269,16 @@ class Processor final : public NetEventsInterface {
     std::atomic<bool> m_canShareLocalProof{false};
     int64_t minAvaproofsNodeCount;
     std::atomic<int64_t> avaproofsNodeCounter{0};
+    /**
+     * Whether the peers were loaded from a recent enough file that the
+     * avaproofs node count requirement can be skipped. Only set during
+     * construction.
+     */
+    bool loadedRecentPeers{false};
+
+    /** Serialize the writes to the avalanche peers file. */
+    Mutex cs_peersDump;
+    void dumpPeers() EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_peersDump);
 
     /** Voting parameters. */
     const uint32_t staleVoteThreshold;
@@ -310,6 +355,21 @@ public:
 
     // TODO: Refactor the API to remove the dependency on avalanche/protocol.h
     void sendResponse(CNode *pfrom, Response response) const;
+    /**
+     * Return the number of items of the largest poll sent to the node that is
+     * still waiting for a response, so the size of the response can be
+     * checked before it is read.
+     */
+    size_t getMaxPendingPollSize(NodeId nodeid) const;
+    /**
+     * Rebuild a response received in the compact format from the invs of the
+     * matching query. The query is left untouched, and on failure disconnect
+     * and error are set the same way registerVotes would.
+     */
+    bool expandCompactResponse(NodeId nodeid,
+                               const CompactResponse &compactResponse,
+                               Response &response, bool &disconnect,
+                               std::string &error) const;
     bool registerVotes(NodeId nodeid, const Response &response,
                        std::vector<VoteItemUpdate> &updates, bool &disconnect,
                        std::string &error)
@@ -439,11 +499,26 @@ private:
     void clearInflightRequests(const std::map<CInv, uint8_t> &inflightRequests)
         EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager);
     std::vector<CInv>
-    getInvsForNextPoll(RWCollection<VoteMap>::ReadView &voteRecordsReadView,
+    getInvsForNextPoll(const VoteMapReadViews &voteRecordsReadViews,
                        size_t max_elements, bool forPoll = true) const;
+    /**
+     * Build the polls for several nodes at once in a single pass over the
+     * vote records, registering the polls. Items are handed out in priority
+     * order to every node that still has room, so the result is the same as
+     * successive getInvsForNextPoll calls would give.
+     */
+    std::vector<std::vector<CInv>>
+    getInvsForNextPolls(const VoteMapReadViews &voteRecordsReadViews,
+                        const std::vector<size_t> &max_elements) const;
     bool sendHelloInternal(CNode *pfrom)
         EXCLUSIVE_LOCKS_REQUIRED(cs_delayedAvahelloNodeIds);
-    AnyVoteItem getVoteItemFromInv(const CInv &inv) const
+    /**
+     * Retrieve the items the invs refer to, in the same order. Unknown items
+     * are returned as null. Each lock is taken at most once for the whole
+     * batch instead of once per inv.
+     */
+    std::vector<AnyVoteItem>
+    getVoteItemsFromInvs(const std::vector<CInv> &invs) const
         EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager);
 
     /**
@@ -457,27 +532,24 @@ private:
         EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_stakingRewards);
 
     /**
-     * We don't need many blocks but a low false positive rate.
-     * In the event of a false positive the node might skip polling this block.
-     * Such a block will not get marked as finalized until it is reconsidered
-     * for polling (if the filter changed its state) or another block is found.
+     * We don't need many blocks, but a block that is wrongly believed to be
+     * invalidated would not be polled. The set is exact so this can't happen.
      */
     mutable Mutex cs_invalidatedBlocks;
-    CRollingBloomFilter invalidatedBlocks GUARDED_BY(cs_invalidatedBlocks){
-        100, 0.0000001};
+    RollingIdSet invalidatedBlocks GUARDED_BY(cs_invalidatedBlocks){100};
 
     /**
-     * Rolling bloom filter to track recently finalized inventory items of any
-     * type. Once placed in this filter, those items will not be polled again
-     * unless they roll out. Note that this one filter tracks all types so
-     * blocks may be rolled out by transaction activity for example.
+     * Rolling set to track recently finalized inventory items of any type.
+     * Once placed in this set, those items will not be polled again unless
+     * they roll out. Note that this one set tracks all types so blocks may be
+     * rolled out by transaction activity for example.
      *
-     * We want a low false positive rate to prevent accidentally not polling
-     * for an item when it is first seen.
+     * The set is exact, so an item is never accidentally skipped when it is
+     * first seen.
      */
     mutable Mutex cs_finalizedItems;
-    CRollingBloomFilter finalizedItems GUARDED_BY(cs_finalizedItems){
-        AVALANCHE_FINALIZED_ITEMS_FILTER_NUM_ELEMENTS, 0.0000001};
+    RollingIdSet finalizedItems GUARDED_BY(cs_finalizedItems){
+        AVALANCHE_FINALIZED_ITEMS_FILTER_NUM_ELEMENTS};
 
     struct IsWorthPolling {
         const Processor &processor;
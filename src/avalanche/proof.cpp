@@ -179,14 +179,9 @@ bool Proof::verify(const Amount &stakeUtxoDustThreshold,
     return true;
 }
 
-bool Proof::verify(const Amount &stakeUtxoDustThreshold,
-                   const ChainstateManager &chainman,
-                   ProofValidationState &state) const {
+bool Proof::verifyAgainstChain(const ChainstateManager &chainman,
+                               ProofValidationState &state) const {
     AssertLockHeld(cs_main);
-    if (!verify(stakeUtxoDustThreshold, state)) {
-        // state is set by verify.
-        return false;
-    }
 
     const CBlockIndex *activeTip = chainman.ActiveTip();
     const int64_t tipMedianTimePast =
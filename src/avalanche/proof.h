@@ -172,12 +172,26 @@ public:
     uint32_t getScore() const { return score; }
     Amount getStakedAmount() const;
 
+    /**
+     * Stateless checks: they only depend on the proof itself, so they can be
+     * run without holding any lock.
+     */
     bool verify(const Amount &stakeUtxoDustThreshold,
                 ProofValidationState &state) const;
+    /**
+     * Checks against the chain state only, i.e. the stake utxos and the
+     * expiration. The stateless checks are assumed to have succeeded.
+     */
+    bool verifyAgainstChain(const ChainstateManager &chainman,
+                            ProofValidationState &state) const
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool verify(const Amount &stakeUtxoDustThreshold,
                 const ChainstateManager &chainman,
                 ProofValidationState &state) const
-        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        return verify(stakeUtxoDustThreshold, state) &&
+               verifyAgainstChain(chainman, state);
+    }
 };
 
 using ProofRef = RCUPtr<const Proof>;
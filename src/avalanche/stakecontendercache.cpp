@@ -10,6 +10,7 @@
 #include <util/strencodings.h>
 
 #include <algorithm>
+#include <iterator>
 
 namespace avalanche {
 
@@ -36,8 +37,9 @@ void StakeContenderCache::cleanup(const int requestedMinHeight) {
         auto [mwHashBegin, mwHashEnd] = mwHashView.equal_range(blockhash);
         mwHashView.erase(mwHashBegin, mwHashEnd);
 
-        auto &cHashView = contenders.get<by_prevblockhash>();
-        auto [cHashBegin, cHashEnd] = cHashView.equal_range(blockhash);
+        auto &cHashView = contenders.get<by_prevblockhash_rank>();
+        auto [cHashBegin, cHashEnd] =
+            cHashView.equal_range(boost::make_tuple(blockhash));
         cHashView.erase(cHashBegin, cHashEnd);
     }
 }
@@ -170,56 +172,40 @@ int StakeContenderCache::getVoteStatus(const StakeContenderId &contenderId,
 size_t StakeContenderCache::getPollableContenders(
     const BlockHash &prevblockhash, size_t maxPollable,
     std::vector<StakeContenderId> &pollableContenders) const {
-    std::vector<const StakeContenderCacheEntry *> rankedContenders;
-    auto &view = contenders.get<by_prevblockhash>();
-    auto [begin, end] = view.equal_range(prevblockhash);
-    for (auto it = begin; it != end; it++) {
-        rankedContenders.push_back(&(*it));
+    pollableContenders.clear();
+
+    auto &view = contenders.get<by_prevblockhash_rank>();
+    auto [begin, end] = view.equal_range(boost::make_tuple(prevblockhash));
+
+    // The contenders are iterated from the best reward rank to the worst.
+    // Accepted contenders are preferred, so pick them first and only fill the
+    // remaining room with the best of the others.
+    std::vector<const StakeContenderCacheEntry *> accepted;
+    std::vector<const StakeContenderCacheEntry *> others;
+    for (auto it = begin; it != end && accepted.size() < maxPollable; it++) {
+        if (it->isAccepted()) {
+            accepted.push_back(&(*it));
+        } else if (others.size() < maxPollable) {
+            others.push_back(&(*it));
+        }
     }
+    others.resize(std::min(others.size(), maxPollable - accepted.size()));
 
-    // First sort all contenders with accepted contenders first
-    std::sort(rankedContenders.begin(), rankedContenders.end(),
-              [](const StakeContenderCacheEntry *left,
-                 const StakeContenderCacheEntry *right) {
-                  if (left->isAccepted() != right->isAccepted()) {
-                      // Accepted contenders sort first
-                      return left->isAccepted();
-                  }
-
-                  double leftRank = left->computeRewardRank();
-                  double rightRank = right->computeRewardRank();
-                  const StakeContenderId &leftContenderId =
-                      left->getStakeContenderId();
-                  const StakeContenderId &rightContenderId =
-                      right->getStakeContenderId();
-                  return RewardRankComparator()(leftContenderId, leftRank,
-                                                left->proofid, rightContenderId,
-                                                rightRank, right->proofid);
-              });
-
-    // Sort again, only by reward rank, and only up to the max number of
-    // pollable contenders.
-    size_t numPollable = std::min(rankedContenders.size(), maxPollable);
-    std::sort(rankedContenders.begin(), rankedContenders.begin() + numPollable,
-              [](const StakeContenderCacheEntry *left,
-                 const StakeContenderCacheEntry *right) {
-                  double leftRank = left->computeRewardRank();
-                  double rightRank = right->computeRewardRank();
-                  const StakeContenderId &leftContenderId =
-                      left->getStakeContenderId();
-                  const StakeContenderId &rightContenderId =
-                      right->getStakeContenderId();
-                  return RewardRankComparator()(leftContenderId, leftRank,
-                                                left->proofid, rightContenderId,
-                                                rightRank, right->proofid);
-              });
-
-    // Only return up to the maximum number of contenders
-    pollableContenders.clear();
-    pollableContenders.reserve(numPollable);
-    for (size_t i = 0; i < numPollable; i++) {
-        pollableContenders.push_back(
-            rankedContenders[i]->getStakeContenderId());
+    // Both lists are sorted by reward rank, merge them so the output is too.
+    std::vector<const StakeContenderCacheEntry *> rankedContenders;
+    rankedContenders.reserve(accepted.size() + others.size());
+    std::merge(accepted.begin(), accepted.end(), others.begin(), others.end(),
+               std::back_inserter(rankedContenders),
+               [](const StakeContenderCacheEntry *left,
+                  const StakeContenderCacheEntry *right) {
+                   return RewardRankComparator()(
+                       left->contenderId, left->rewardRank, left->proofid,
+                       right->contenderId, right->rewardRank, right->proofid);
+               });
+
+    pollableContenders.reserve(rankedContenders.size());
+    for (const auto *contender : rankedContenders) {
+        pollableContenders.push_back(contender->getStakeContenderId());
     }
 
     return pollableContenders.size();
@@ -228,55 +214,47 @@ size_t StakeContenderCache::getPollableContenders(
 bool StakeContenderCache::getWinners(
     const BlockHash &prevblockhash,
     std::vector<std::pair<ProofId, CScript>> &winners) const {
-    // Winners determined by avalanche are sorted by reward rank
-    std::vector<const StakeContenderCacheEntry *> rankedWinners;
-    auto &view = contenders.get<by_prevblockhash>();
-    auto [begin, end] = view.equal_range(prevblockhash);
+    // Winners determined by avalanche are sorted by reward rank, accepted
+    // contenders first. The index already orders them by reward rank.
+    std::vector<const StakeContenderCacheEntry *> acceptedWinners;
+    std::vector<const StakeContenderCacheEntry *> otherWinners;
+    auto &view = contenders.get<by_prevblockhash_rank>();
+    auto [begin, end] = view.equal_range(boost::make_tuple(prevblockhash));
     for (auto it = begin; it != end; it++) {
-        if (it->isInWinnerSet()) {
-            rankedWinners.push_back(&(*it));
+        if (!it->isInWinnerSet()) {
+            continue;
+        }
+        if (it->isAccepted()) {
+            acceptedWinners.push_back(&(*it));
+        } else {
+            otherWinners.push_back(&(*it));
         }
     }
 
-    std::sort(rankedWinners.begin(), rankedWinners.end(),
-              [](const StakeContenderCacheEntry *left,
-                 const StakeContenderCacheEntry *right) {
-                  if (left->isAccepted() != right->isAccepted()) {
-                      // Accepted contenders sort first
-                      return left->isAccepted();
-                  }
-
-                  double leftRank = left->computeRewardRank();
-                  double rightRank = right->computeRewardRank();
-                  const StakeContenderId &leftContenderId =
-                      left->getStakeContenderId();
-                  const StakeContenderId &rightContenderId =
-                      right->getStakeContenderId();
-                  return RewardRankComparator()(leftContenderId, leftRank,
-                                                left->proofid, rightContenderId,
-                                                rightRank, right->proofid);
-              });
-
     winners.clear();
 
     // Add manual winners first, preserving order
+    const size_t numRankedWinners =
+        acceptedWinners.size() + otherWinners.size();
     auto &manualWinnersView = manualWinners.get<by_prevblockhash>();
     auto manualWinnerIt = manualWinnersView.find(prevblockhash);
     if (manualWinnerIt != manualWinners.end()) {
         winners.reserve(manualWinnerIt->payoutScripts.size() +
-                        rankedWinners.size());
+                        numRankedWinners);
 
         for (auto &payoutScript : manualWinnerIt->payoutScripts) {
             winners.push_back({ProofId(), payoutScript});
         }
     } else {
-        winners.reserve(rankedWinners.size());
+        winners.reserve(numRankedWinners);
     }
 
     // Add ranked winners, preserving reward rank order
-    for (const auto &rankedWinner : rankedWinners) {
-        winners.push_back(
-            {rankedWinner->proofid, rankedWinner->payoutScriptPubkey});
+    for (const auto *rankedWinners : {&acceptedWinners, &otherWinners}) {
+        for (const auto *rankedWinner : *rankedWinners) {
+            winners.push_back(
+                {rankedWinner->proofid, rankedWinner->payoutScriptPubkey});
+        }
     }
 
     return winners.size() > 0;
@@ -11,6 +11,7 @@
 #include <script/script.h>
 #include <util/hasher.h>
 
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -42,6 +43,10 @@ struct StakeContenderCacheEntry {
     // track past-valid proofs.
     CScript payoutScriptPubkey;
     uint32_t score;
+    // Both are derived from the fields above. They are computed once so the
+    // indexes and the rankings don't need to hash the contender again.
+    StakeContenderId contenderId;
+    double rewardRank;
 
     StakeContenderCacheEntry(const BlockHash &_prevblockhash, int _blockheight,
                              const ProofId &_proofid, uint8_t _status,
@@ -49,14 +54,12 @@ struct StakeContenderCacheEntry {
                              uint32_t _score)
         : prevblockhash(_prevblockhash), blockheight(_blockheight),
           proofid(_proofid), status(_status),
-          payoutScriptPubkey(_payoutScriptPubkey), score(_score) {}
+          payoutScriptPubkey(_payoutScriptPubkey), score(_score),
+          contenderId(_prevblockhash, _proofid),
+          rewardRank(contenderId.ComputeProofRewardRank(_score)) {}
 
-    double computeRewardRank() const {
-        return getStakeContenderId().ComputeProofRewardRank(score);
-    }
-    StakeContenderId getStakeContenderId() const {
-        return StakeContenderId{prevblockhash, proofid};
-    }
+    double computeRewardRank() const { return rewardRank; }
+    const StakeContenderId &getStakeContenderId() const { return contenderId; }
     bool isAccepted() const { return status & StakeContenderStatus::ACCEPTED; }
     bool isInWinnerSet() const {
         return status & StakeContenderStatus::IN_WINNER_SET;
@@ -74,16 +77,10 @@ struct ManualWinners {
           payoutScripts(_payoutScripts) {}
 };
 
-struct stakecontenderid_index {
-    using result_type = StakeContenderId;
-    result_type operator()(const StakeContenderCacheEntry &entry) const {
-        return entry.getStakeContenderId();
-    }
-};
-
 struct by_stakecontenderid;
 struct by_prevblockhash;
 struct by_blockheight;
+struct by_prevblockhash_rank;
 
 namespace bmi = boost::multi_index;
 
@@ -97,14 +94,26 @@ class StakeContenderCache {
         StakeContenderCacheEntry,
         bmi::indexed_by<
             // index by stake contender id
-            bmi::hashed_unique<bmi::tag<by_stakecontenderid>,
-                               stakecontenderid_index, SaltedUint256Hasher>,
-            // index by prevblockhash
-            bmi::hashed_non_unique<
-                bmi::tag<by_prevblockhash>,
-                bmi::member<StakeContenderCacheEntry, BlockHash,
-                            &StakeContenderCacheEntry::prevblockhash>,
+            bmi::hashed_unique<
+                bmi::tag<by_stakecontenderid>,
+                bmi::member<StakeContenderCacheEntry, StakeContenderId,
+                            &StakeContenderCacheEntry::contenderId>,
                 SaltedUint256Hasher>,
+            // index by prevblockhash, then by reward rank. The rank
+            // tie-breakers match the RewardRankComparator so iterating over
+            // the contenders for a block yields them from best to worst.
+            bmi::ordered_unique<
+                bmi::tag<by_prevblockhash_rank>,
+                bmi::composite_key<
+                    StakeContenderCacheEntry,
+                    bmi::member<StakeContenderCacheEntry, BlockHash,
+                                &StakeContenderCacheEntry::prevblockhash>,
+                    bmi::member<StakeContenderCacheEntry, double,
+                                &StakeContenderCacheEntry::rewardRank>,
+                    bmi::member<StakeContenderCacheEntry, StakeContenderId,
+                                &StakeContenderCacheEntry::contenderId>,
+                    bmi::member<StakeContenderCacheEntry, ProofId,
+                                &StakeContenderCacheEntry::proofid>>>,
             // index by block height
             bmi::ordered_non_unique<
                 bmi::tag<by_blockheight>,
@@ -179,6 +188,8 @@ public:
      * Get the best ranking contenders, accepted contenders ranking first. The
      * output of this function is only reliable to select contenders to
      * reconcile and should not be called after contender polling begins.
+     * The contenders are kept sorted by reward rank, so this only visits the
+     * contenders for the block until enough of them are found.
      */
     size_t getPollableContenders(
         const BlockHash &prevblockhash, size_t maxPollable,
@@ -0,0 +1,288 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/compactpoll.h>
+
+#include <random.h>
+#include <streams.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+#include <vector>
+
+using namespace avalanche;
+
+namespace {
+struct CompactPollTestingSetup : public BasicTestingSetup {
+    std::vector<CInv> makeInvs(size_t count) {
+        std::vector<CInv> invs;
+        invs.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            invs.emplace_back(i % 2 ? MSG_BLOCK : MSG_TX, m_rng.rand256());
+        }
+        return invs;
+    }
+
+    template <typename T> T roundTrip(const T &obj, T res = T{}) {
+        DataStream ss{};
+        ss << obj;
+        ss >> res;
+        BOOST_CHECK(ss.empty());
+        return res;
+    }
+
+    static bool sameInvs(const std::vector<CInv> &a,
+                         const std::vector<CInv> &b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].type != b[i].type || a[i].hash != b[i].hash) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(compactpoll_tests, CompactPollTestingSetup)
+
+BOOST_AUTO_TEST_CASE(poll_session) {
+    PollSessionEncoder encoder;
+    PollSessionDecoder decoder;
+
+    const auto invs = makeInvs(16);
+    std::vector<CInv> decoded;
+
+    // All the items are new on the first poll
+    CompactPoll poll =
+        roundTrip(encoder.encode(0, invs), CompactPoll(invs.size()));
+    BOOST_CHECK_EQUAL(poll.getRound(), 0);
+    BOOST_CHECK(!poll.isSessionReset());
+    BOOST_CHECK_EQUAL(poll.getItems().size(), invs.size());
+    for (const CompactPollItem &item : poll.getItems()) {
+        BOOST_CHECK(item.isNew());
+    }
+    BOOST_CHECK(decoder.decode(poll, decoded));
+    BOOST_CHECK(sameInvs(decoded, invs));
+
+    // Polling again a subset in a different order only uses session ids, and
+    // the new items are appended to the session.
+    std::vector<CInv> invs2{invs[5], invs[3], invs[15]};
+    const auto newInvs = makeInvs(2);
+    invs2.insert(invs2.begin() + 1, newInvs[0]);
+    invs2.push_back(newInvs[1]);
+
+    poll = roundTrip(encoder.encode(1, invs2), CompactPoll(invs2.size()));
+    BOOST_CHECK_EQUAL(poll.getRound(), 1);
+    BOOST_CHECK(!poll.isSessionReset());
+    const auto &items = poll.getItems();
+    BOOST_REQUIRE_EQUAL(items.size(), 5);
+    BOOST_CHECK_EQUAL(items[0].code, 6);
+    BOOST_CHECK(items[1].isNew());
+    BOOST_CHECK_EQUAL(items[2].code, 4);
+    BOOST_CHECK_EQUAL(items[3].code, 16);
+    BOOST_CHECK(items[4].isNew());
+    BOOST_CHECK(decoder.decode(poll, decoded));
+    BOOST_CHECK(sameInvs(decoded, invs2));
+
+    // The compact poll is smaller than the legacy one as soon as the items
+    // are known.
+    BOOST_CHECK_LT(GetSerializeSize(encoder.encode(2, invs)),
+                   GetSerializeSize(Poll(2, invs)));
+}
+
+BOOST_AUTO_TEST_CASE(poll_session_reset) {
+    PollSessionEncoder encoder;
+    PollSessionDecoder decoder;
+    std::vector<CInv> decoded;
+
+    // Fill the session up to the cap
+    const auto invs = makeInvs(16);
+    for (size_t i = 0; i < AVALANCHE_MAX_POLL_SESSION_IDS / invs.size(); i++) {
+        CompactPoll poll = encoder.encode(i, makeInvs(invs.size()));
+        BOOST_CHECK(!poll.isSessionReset());
+        BOOST_CHECK(decoder.decode(poll, decoded));
+    }
+
+    // Any new item resets the session, and all the items are sent in full
+    CompactPoll poll =
+        roundTrip(encoder.encode(0, invs), CompactPoll(invs.size()));
+    BOOST_CHECK(poll.isSessionReset());
+    for (const CompactPollItem &item : poll.getItems()) {
+        BOOST_CHECK(item.isNew());
+    }
+    BOOST_CHECK(decoder.decode(poll, decoded));
+    BOOST_CHECK(sameInvs(decoded, invs));
+
+    // The ids are assigned from scratch after the reset
+    poll = encoder.encode(1, {invs[0]});
+    BOOST_CHECK(!poll.isSessionReset());
+    BOOST_REQUIRE_EQUAL(poll.getItems().size(), 1);
+    BOOST_CHECK_EQUAL(poll.getItems()[0].code, 1);
+    BOOST_CHECK(decoder.decode(poll, decoded));
+    BOOST_CHECK(sameInvs(decoded, {invs[0]}));
+}
+
+BOOST_AUTO_TEST_CASE(poll_session_invalid) {
+    std::vector<CInv> decoded;
+
+    // Unknown session id
+    {
+        PollSessionDecoder decoder;
+        BOOST_CHECK(!decoder.decode(CompactPoll(0, false, {{1, CInv()}}),
+                                    decoded));
+    }
+    {
+        PollSessionDecoder decoder;
+        const auto invs = makeInvs(2);
+        BOOST_CHECK(decoder.decode(
+            CompactPoll(0, false, {{0, invs[0]}, {0, invs[1]}}), decoded));
+        BOOST_CHECK(decoder.decode(CompactPoll(1, false, {{2, CInv()}}),
+                                   decoded));
+        BOOST_CHECK(sameInvs(decoded, {invs[1]}));
+        BOOST_CHECK(!decoder.decode(CompactPoll(2, false, {{3, CInv()}}),
+                                    decoded));
+
+        // The ids are no longer valid after a reset
+        BOOST_CHECK(!decoder.decode(CompactPoll(3, true, {{1, CInv()}}),
+                                    decoded));
+    }
+
+    // The session can't grow past the cap
+    {
+        PollSessionDecoder decoder;
+        std::vector<CompactPollItem> items;
+        for (const CInv &inv : makeInvs(AVALANCHE_MAX_POLL_SESSION_IDS)) {
+            items.push_back({0, inv});
+        }
+        BOOST_CHECK(decoder.decode(CompactPoll(0, false, items), decoded));
+        BOOST_CHECK(!decoder.decode(
+            CompactPoll(1, false, {{0, makeInvs(1)[0]}}), decoded));
+    }
+
+    // Out of range ids fail to deserialize
+    {
+        DataStream ss{};
+        ss << uint64_t(0) << false;
+        WriteCompactSize(ss, 1);
+        WriteCompactSize(ss, AVALANCHE_MAX_POLL_SESSION_IDS + 1);
+        CompactPoll poll{1};
+        BOOST_CHECK_THROW(ss >> poll, std::ios_base::failure);
+    }
+
+    // More items than can be polled at once, the items are not read
+    {
+        PollSessionEncoder encoder;
+        DataStream ss{};
+        ss << encoder.encode(0, makeInvs(5));
+        CompactPoll poll{4};
+        BOOST_CHECK_THROW(ss >> poll, std::ios_base::failure);
+        BOOST_CHECK_EQUAL(ss.size(), 5 * (1 + 4 + 32));
+
+        ss.clear();
+        ss << encoder.encode(1, makeInvs(5));
+        CompactPoll exactPoll{5};
+        ss >> exactPoll;
+        BOOST_CHECK_EQUAL(exactPoll.getItems().size(), 5);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(compact_response) {
+    const auto invs = makeInvs(11);
+    const std::vector<uint32_t> errors{
+        0, 1, 0, std::numeric_limits<uint32_t>::max(), 2, 0, 0, 1, 42, 0,
+        std::numeric_limits<uint32_t>::max() - 1};
+
+    std::vector<Vote> votes;
+    for (size_t i = 0; i < invs.size(); i++) {
+        votes.emplace_back(errors[i], invs[i].hash);
+    }
+    const Response response(1234, 567, votes);
+
+    const CompactResponse compactResponse = roundTrip(
+        CompactResponse(response), CompactResponse(invs.size()));
+    BOOST_CHECK_EQUAL(compactResponse.getRound(), 1234);
+    BOOST_CHECK_EQUAL(compactResponse.getCooldown(), 567);
+    BOOST_CHECK(compactResponse.getErrors() == errors);
+
+    // 8 + 4 bytes for round and cooldown, 1 for the count, 3 for the packed
+    // votes and 3 escaped votes.
+    BOOST_CHECK_EQUAL(GetSerializeSize(compactResponse), 8 + 4 + 1 + 3 + 12);
+    BOOST_CHECK_LT(GetSerializeSize(compactResponse),
+                   GetSerializeSize(response));
+
+    // Expanding gives back the same response, hence the same signature hash
+    Response expanded;
+    BOOST_CHECK(compactResponse.expand(invs, expanded));
+    BOOST_CHECK_EQUAL(expanded.getRound(), response.getRound());
+    BOOST_CHECK_EQUAL(expanded.getCooldown(), response.getCooldown());
+    BOOST_CHECK((HashWriter{} << expanded).GetHash() ==
+                (HashWriter{} << response).GetHash());
+
+    // The vote count must match the poll
+    BOOST_CHECK(!compactResponse.expand(makeInvs(10), expanded));
+    BOOST_CHECK(!compactResponse.expand(makeInvs(12), expanded));
+
+    // Empty response
+    const CompactResponse emptyResponse =
+        roundTrip(CompactResponse(Response(0, 0, {})), CompactResponse(0));
+    BOOST_CHECK(emptyResponse.getErrors().empty());
+    BOOST_CHECK(emptyResponse.expand({}, expanded));
+}
+
+BOOST_AUTO_TEST_CASE(compact_response_invalid) {
+    // Escaped vote values that have a short encoding are rejected
+    for (uint32_t error : {uint32_t(0), uint32_t(1),
+                           std::numeric_limits<uint32_t>::max()}) {
+        DataStream ss{};
+        ss << uint64_t(0) << uint32_t(0);
+        WriteCompactSize(ss, 1);
+        ss << uint8_t(0x03) << error;
+        CompactResponse compactResponse{5};
+        BOOST_CHECK_THROW(ss >> compactResponse, std::ios_base::failure);
+    }
+
+    // Truncated packed votes
+    {
+        DataStream ss{};
+        ss << uint64_t(0) << uint32_t(0);
+        WriteCompactSize(ss, 5);
+        ss << uint8_t(0x00);
+        CompactResponse compactResponse{5};
+        BOOST_CHECK_THROW(ss >> compactResponse, std::ios_base::failure);
+    }
+
+    // More votes than items polled, the votes are not read
+    {
+        const Response response(0, 0, std::vector<Vote>(5));
+        DataStream ss{};
+        ss << CompactResponse(response);
+        CompactResponse compactResponse{4};
+        BOOST_CHECK_THROW(ss >> compactResponse, std::ios_base::failure);
+        BOOST_CHECK_EQUAL(ss.size(), 2);
+
+        ss.clear();
+        ss << CompactResponse(response);
+        CompactResponse exactResponse{5};
+        ss >> exactResponse;
+        BOOST_CHECK_EQUAL(exactResponse.getErrors().size(), 5);
+    }
+
+    // Missing escaped vote
+    {
+        DataStream ss{};
+        ss << uint64_t(0) << uint32_t(0);
+        WriteCompactSize(ss, 1);
+        ss << uint8_t(0x03);
+        CompactResponse compactResponse{5};
+        BOOST_CHECK_THROW(ss >> compactResponse, std::ios_base::failure);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <deque>
 #include <limits>
 #include <optional>
 #include <unordered_map>
@@ -60,6 +62,14 @@ namespace {
             return getPeerIdForProofId(pm, proof->getId());
         }
 
+        static size_t getSlotsSize(const PeerManager &pm) {
+            return pm.slots.size();
+        }
+
+        static size_t getCompactMinSlots() {
+            return PeerManager::COMPACT_MIN_SLOTS;
+        }
+
         static std::vector<uint32_t> getOrderedScores(const PeerManager &pm) {
             std::vector<uint32_t> scores;
 
@@ -392,6 +402,119 @@ BOOST_AUTO_TEST_CASE(peer_probabilities) {
     BOOST_CHECK(abs(results[0] - results[1] + results[2]) < 500);
 }
 
+BOOST_AUTO_TEST_CASE(select_nodes) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+    BOOST_CHECK(pm.selectNodes(3).empty());
+
+    const NodeId node0 = 42, node1 = 69, node2 = 37;
+    Chainstate &active_chainstate = chainman.ActiveChainstate();
+    addNodeWithScore(active_chainstate, pm, node0, MIN_VALID_PROOF_SCORE);
+    addNodeWithScore(active_chainstate, pm, node1, 2 * MIN_VALID_PROOF_SCORE);
+    addNodeWithScore(active_chainstate, pm, node2, MIN_VALID_PROOF_SCORE);
+
+    // Every peer is returned once when asking for as many nodes or more.
+    for (size_t count : {3, 4, 10}) {
+        std::vector<NodeId> nodeids = pm.selectNodes(count);
+        std::sort(nodeids.begin(), nodeids.end());
+        BOOST_CHECK(nodeids == std::vector<NodeId>({node2, node0, node1}));
+    }
+
+    // The first node is drawn by score, the next ones among the other peers.
+    std::unordered_map<NodeId, int> first, second;
+    for (int i = 0; i < 10000; i++) {
+        const std::vector<NodeId> nodeids = pm.selectNodes(2);
+        BOOST_REQUIRE_EQUAL(nodeids.size(), 2);
+        BOOST_CHECK(nodeids[0] != nodeids[1]);
+        first[nodeids[0]]++;
+        second[nodeids[1]]++;
+    }
+    BOOST_CHECK(abs(first[node1] - 5000) < 500);
+    BOOST_CHECK(abs(first[node0] - first[node2]) < 500);
+    // Each node is the second one a third of the time.
+    for (const NodeId n : {node0, node1, node2}) {
+        BOOST_CHECK(abs(3 * second[n] - 10000) < 1500);
+    }
+
+    // The peers without an available node are skipped, and the selection
+    // doesn't alter the scores of the peers.
+    BOOST_CHECK(pm.updateNextRequestTimeForPoll(
+        node1, Now<SteadyMilliseconds>() + std::chrono::hours(24), 0));
+    std::unordered_map<NodeId, int> results;
+    for (int i = 0; i < 1000; i++) {
+        const std::vector<NodeId> nodeids = pm.selectNodes(3);
+        BOOST_CHECK_EQUAL(nodeids.size(), 2);
+        for (const NodeId n : nodeids) {
+            results[n]++;
+        }
+        results[pm.selectNode()]++;
+    }
+    BOOST_CHECK_EQUAL(results[node1], 0);
+    BOOST_CHECK_EQUAL(results[node0] + results[node2] + results[NO_NODE],
+                      3000);
+
+    BOOST_CHECK(pm.updateNextRequestTimeForPoll(
+        node0, Now<SteadyMilliseconds>() + std::chrono::hours(24), 1));
+    BOOST_CHECK(pm.updateNextRequestTimeForPoll(
+        node2, Now<SteadyMilliseconds>() + std::chrono::hours(24), 2));
+    BOOST_CHECK(pm.selectNodes(3).empty());
+    BOOST_CHECK(pm.shouldRequestMoreNodes());
+}
+
+BOOST_AUTO_TEST_CASE(slot_score_tree) {
+    SlotScoreTree tree;
+    BOOST_CHECK_EQUAL(tree.size(), 0);
+    BOOST_CHECK_EQUAL(tree.getTotal(), 0);
+
+    // Check every value maps to the expected slot index.
+    auto checkFind = [&](const std::vector<uint32_t> &scores) {
+        BOOST_CHECK_EQUAL(tree.size(), scores.size());
+
+        uint64_t value = 0;
+        for (size_t i = 0; i < scores.size(); i++) {
+            BOOST_CHECK_EQUAL(tree.getScore(i), scores[i]);
+            for (uint32_t j = 0; j < scores[i]; j++) {
+                BOOST_CHECK_EQUAL(tree.find(value++), i);
+            }
+        }
+
+        BOOST_CHECK_EQUAL(tree.getTotal(), value);
+    };
+
+    std::vector<uint32_t> scores;
+    for (uint32_t i = 0; i < 37; i++) {
+        scores.push_back(i % 5 + 1);
+        tree.push_back(scores.back());
+        checkFind(scores);
+    }
+
+    // Null scores are skipped.
+    for (size_t i : {0, 3, 15, 16, 17, 32, 35}) {
+        tree.setNullScore(i);
+        scores[i] = 0;
+        checkFind(scores);
+    }
+
+    // Setting a null score twice is a no-op.
+    tree.setNullScore(15);
+    checkFind(scores);
+
+    // Pop a few slots and add some new ones.
+    for (int i = 0; i < 6; i++) {
+        tree.pop_back();
+        scores.pop_back();
+        checkFind(scores);
+    }
+    for (uint32_t i = 0; i < 12; i++) {
+        scores.push_back(i + 1);
+        tree.push_back(scores.back());
+        checkFind(scores);
+    }
+
+    tree.clear();
+    checkFind({});
+}
+
 BOOST_AUTO_TEST_CASE(remove_peer) {
     ChainstateManager &chainman = *Assert(m_node.chainman);
     // No peers.
@@ -422,6 +545,12 @@ BOOST_AUTO_TEST_CASE(remove_peer) {
     BOOST_CHECK_EQUAL(pm.getSlotCount(), 40000);
     BOOST_CHECK_EQUAL(pm.getFragmentation(), 10000);
 
+    // The dead slot is never selected, even before compaction.
+    for (int i = 0; i < 100; i++) {
+        PeerId p = pm.selectPeer();
+        BOOST_CHECK(p == peerids[0] || p == peerids[1] || p == peerids[3]);
+    }
+
     // Make sure we compact to never get NO_PEER.
     BOOST_CHECK_EQUAL(pm.compact(), 10000);
     BOOST_CHECK(pm.verify());
@@ -549,6 +678,64 @@ BOOST_AUTO_TEST_CASE(compact_slots_non_uniform_scores) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(compact_slots_on_removal) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+
+    const size_t numPeers = TestPeerManager::getCompactMinSlots();
+    std::vector<PeerId> peerids;
+    for (size_t i = 0; i < numPeers; i++) {
+        auto p = buildRandomProof(chainman.ActiveChainstate(),
+                                  MIN_VALID_PROOF_SCORE);
+        peerids.push_back(TestPeerManager::registerAndGetPeerId(pm, p));
+        BOOST_CHECK(pm.addNode(m_rng.rand32(), p->getId(),
+                               DEFAULT_AVALANCHE_MAX_ELEMENT_POLL));
+    }
+
+    const uint64_t slotCount = numPeers * MIN_VALID_PROOF_SCORE;
+    BOOST_CHECK_EQUAL(pm.getSlotCount(), slotCount);
+
+    // Remove the peers from the front. The dead slots are kept as long as
+    // they account for no more than half of the slot space.
+    const size_t half = numPeers / 2;
+    for (size_t i = 0; i < half; i++) {
+        BOOST_CHECK(pm.removePeer(peerids[i]));
+    }
+    BOOST_CHECK_EQUAL(TestPeerManager::getSlotsSize(pm), numPeers);
+    BOOST_CHECK_EQUAL(pm.getSlotCount(), slotCount);
+    BOOST_CHECK_EQUAL(pm.getFragmentation(), half * MIN_VALID_PROOF_SCORE);
+    BOOST_CHECK(pm.verify());
+
+    // One more dead slot and they are reclaimed.
+    BOOST_CHECK(pm.removePeer(peerids[half]));
+    const size_t remaining = numPeers - half - 1;
+    BOOST_CHECK_EQUAL(TestPeerManager::getSlotsSize(pm), remaining);
+    BOOST_CHECK_EQUAL(pm.getSlotCount(), remaining * MIN_VALID_PROOF_SCORE);
+    BOOST_CHECK_EQUAL(pm.getFragmentation(), 0);
+    BOOST_CHECK(pm.verify());
+
+    for (int i = 0; i < 100; i++) {
+        const PeerId p = pm.selectPeer();
+        BOOST_CHECK(std::find(peerids.begin() + half + 1, peerids.end(), p) !=
+                    peerids.end());
+    }
+
+    // Peers coming and going don't make the slots grow without bound.
+    std::deque<PeerId> livePeers(peerids.begin() + half + 1, peerids.end());
+    for (size_t i = 0; i < 10 * numPeers; i++) {
+        auto p = buildRandomProof(chainman.ActiveChainstate(),
+                                  MIN_VALID_PROOF_SCORE);
+        livePeers.push_back(TestPeerManager::registerAndGetPeerId(pm, p));
+        BOOST_CHECK(pm.addNode(m_rng.rand32(), p->getId(),
+                               DEFAULT_AVALANCHE_MAX_ELEMENT_POLL));
+        BOOST_CHECK(pm.removePeer(livePeers.front()));
+        livePeers.pop_front();
+
+        BOOST_CHECK_LE(TestPeerManager::getSlotsSize(pm), 2 * numPeers);
+    }
+    BOOST_CHECK(pm.verify());
+}
+
 BOOST_AUTO_TEST_CASE(node_crud) {
     ChainstateManager &chainman = *Assert(m_node.chainman);
     avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
@@ -798,6 +985,103 @@ BOOST_AUTO_TEST_CASE(node_binding_reorg) {
     BOOST_CHECK(pm.verify());
 }
 
+BOOST_AUTO_TEST_CASE(register_proofs) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    Chainstate &active_chainstate = chainman.ActiveChainstate();
+    const int tipHeight = WITH_LOCK(cs_main, return chainman.ActiveHeight());
+
+    std::vector<ProofRef> proofs;
+    for (int i = 0; i < 10; i++) {
+        proofs.push_back(
+            buildRandomProof(active_chainstate, MIN_VALID_PROOF_SCORE));
+    }
+    // Duplicated proof
+    proofs.push_back(proofs[0]);
+    // Below the dust threshold
+    proofs.push_back(
+        buildRandomProof(active_chainstate, MIN_VALID_PROOF_SCORE - 1));
+    // Immature
+    proofs.push_back(buildRandomProof(active_chainstate, MIN_VALID_PROOF_SCORE,
+                                      tipHeight + 1));
+
+    // The batch verification is used when loading the peers from a file
+    const fs::path dumpPath = "test_register_proofs_avapeers.dat";
+    {
+        FILE *f = fsbridge::fopen(dumpPath, "wb");
+        BOOST_CHECK(f);
+        const int64_t now = GetTime();
+        AutoFile file{f};
+        file << static_cast<uint64_t>(1); // Version
+        file << uint64_t(proofs.size());  // Number of peers
+        for (const ProofRef &proof : proofs) {
+            file << proof;
+            file << false;
+            file << now;
+            file << now;
+        }
+        BOOST_CHECK(FileCommit(file.Get()));
+        file.fclose();
+    }
+
+    auto checkLoaded =
+        [&](const avalanche::PeerManager &pm,
+            const std::unordered_set<ProofRef, SaltedProofHasher> &loaded) {
+            // The loaded proofs are new instances, so compare the ids
+            std::unordered_set<ProofId, SaltedProofIdHasher> loadedIds;
+            for (const ProofRef &proof : loaded) {
+                loadedIds.insert(proof->getId());
+            }
+            BOOST_CHECK_EQUAL(loadedIds.size(), 10);
+            for (size_t i = 0; i < 10; i++) {
+                BOOST_CHECK_EQUAL(loadedIds.count(proofs[i]->getId()), 1);
+                BOOST_CHECK(pm.isBoundToPeer(proofs[i]->getId()));
+            }
+            BOOST_CHECK(!pm.exists(proofs[11]->getId()));
+            BOOST_CHECK(pm.isImmature(proofs[12]->getId()));
+            BOOST_CHECK(pm.verify());
+        };
+
+    // Without a check queue
+    {
+        avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+        std::unordered_set<ProofRef, SaltedProofHasher> registeredProofs;
+        BOOST_CHECK(pm.loadPeersFromFile(dumpPath, registeredProofs));
+        checkLoaded(pm, registeredProofs);
+
+        // Loading the file again registers nothing more
+        BOOST_CHECK(pm.loadPeersFromFile(dumpPath, registeredProofs));
+        BOOST_CHECK(registeredProofs.empty());
+        BOOST_CHECK(pm.verify());
+    }
+
+    // With a check queue
+    {
+        ProofCheckQueue checkQueue(/*batch_size=*/2, /*worker_threads_num=*/2);
+        avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+        std::unordered_set<ProofRef, SaltedProofHasher> registeredProofs;
+        BOOST_CHECK(
+            pm.loadPeersFromFile(dumpPath, registeredProofs, &checkQueue));
+        checkLoaded(pm, registeredProofs);
+    }
+
+    // Register with the stateless checks done upfront
+    {
+        avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+        for (size_t i = 0; i < proofs.size(); i++) {
+            ProofValidationState statelessState;
+            proofs[i]->verify(PROOF_DUST_THRESHOLD, statelessState);
+
+            ProofRegistrationState state;
+            BOOST_CHECK_EQUAL(
+                pm.registerVerifiedProof(proofs[i], statelessState, state),
+                i < 10);
+            BOOST_CHECK_EQUAL(state.IsValid(), i < 10);
+        }
+        BOOST_CHECK(pm.isImmature(proofs[12]->getId()));
+        BOOST_CHECK(pm.verify());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(proof_conflict) {
     auto key = CKey::MakeCompressedKey();
 
@@ -3111,6 +3395,127 @@ BOOST_AUTO_TEST_CASE(avapeers_dump) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(avapeers_dump_pools, NoCoolDownFixture) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+    Chainstate &active_chainstate = chainman.ActiveChainstate();
+
+    auto mockTime = GetTime<std::chrono::seconds>();
+    SetMockTime(mockTime);
+
+    const CKey key = CKey::MakeCompressedKey();
+    const COutPoint conflictingOutpoint = createUtxo(active_chainstate, key);
+
+    auto proofSeq20 = buildProofWithSequence(key, {conflictingOutpoint}, 20);
+    BOOST_CHECK(pm.registerProof(proofSeq20));
+
+    auto proofSeq10 = buildProofWithSequence(key, {conflictingOutpoint}, 10);
+    ProofRegistrationState state;
+    BOOST_CHECK(!pm.registerProof(proofSeq10, state));
+    BOOST_CHECK(state.GetResult() == ProofRegistrationResult::CONFLICTING);
+    BOOST_CHECK(pm.isInConflictingPool(proofSeq10->getId()));
+
+    const int tipHeight = WITH_LOCK(cs_main, return chainman.ActiveHeight());
+    auto immatureProof = buildRandomProof(
+        active_chainstate, MIN_VALID_PROOF_SCORE, tipHeight + 1);
+    BOOST_CHECK(!pm.registerProof(immatureProof, state));
+    BOOST_CHECK(state.GetResult() == ProofRegistrationResult::IMMATURE);
+    BOOST_CHECK(pm.isImmature(immatureProof->getId()));
+
+    const fs::path testDumpPath = "test_avapeers_dump_pools.dat";
+    BOOST_CHECK(pm.dumpPeersToFile(testDumpPath));
+
+    // The snapshot holds the same data as the file
+    auto snapshot = pm.getPeersSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.time.count(), mockTime.count());
+    BOOST_CHECK_EQUAL(snapshot.peers.size(), 1);
+    BOOST_CHECK_EQUAL(snapshot.poolProofs.size(), 2);
+
+    // Restart from scratch, the pools content is restored along with the peers
+    avalanche::PeerManager pm2(PROOF_DUST_THRESHOLD, chainman);
+
+    SetMockTime(mockTime + 60s);
+
+    std::unordered_set<ProofRef, SaltedProofHasher> registeredProofs;
+    std::chrono::seconds dumpTime{0};
+    BOOST_CHECK(pm2.loadPeersFromFile(testDumpPath, registeredProofs,
+                                      /*checkQueue=*/nullptr, &dumpTime));
+    BOOST_CHECK_EQUAL(dumpTime.count(), mockTime.count());
+    BOOST_CHECK_EQUAL(registeredProofs.size(), 1);
+    BOOST_CHECK_EQUAL((*registeredProofs.begin())->getId(),
+                      proofSeq20->getId());
+
+    BOOST_CHECK(pm2.isBoundToPeer(proofSeq20->getId()));
+    BOOST_CHECK(pm2.isInConflictingPool(proofSeq10->getId()));
+    BOOST_CHECK(pm2.isImmature(immatureProof->getId()));
+
+    // A version 1 file has no dump time
+    {
+        FILE *f = fsbridge::fopen("test_v1_avapeers.dat", "wb");
+        BOOST_CHECK(f);
+        AutoFile file{f};
+        file << static_cast<uint64_t>(1); // Version
+        file << uint64_t{1};              // Number of peers
+        file << proofSeq20;
+        file << true;
+        file << int64_t(mockTime.count());
+        file << int64_t(mockTime.count());
+        BOOST_CHECK(FileCommit(file.Get()));
+        file.fclose();
+    }
+
+    avalanche::PeerManager pm3(PROOF_DUST_THRESHOLD, chainman);
+    BOOST_CHECK(pm3.loadPeersFromFile("test_v1_avapeers.dat", registeredProofs,
+                                      /*checkQueue=*/nullptr, &dumpTime));
+    BOOST_CHECK_EQUAL(dumpTime.count(), 0);
+    BOOST_CHECK_EQUAL(registeredProofs.size(), 1);
+    BOOST_CHECK(pm3.isBoundToPeer(proofSeq20->getId()));
+}
+
+BOOST_AUTO_TEST_CASE(avapeers_dump_conflicting_cooldown) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+    Chainstate &active_chainstate = chainman.ActiveChainstate();
+
+    const auto cooldown =
+        std::chrono::seconds{AVALANCHE_DEFAULT_CONFLICTING_PROOF_COOLDOWN};
+    auto mockTime = GetTime<std::chrono::seconds>();
+    SetMockTime(mockTime);
+
+    const CKey key = CKey::MakeCompressedKey();
+    const COutPoint conflictingOutpoint = createUtxo(active_chainstate, key);
+
+    auto proofSeq20 = buildProofWithSequence(key, {conflictingOutpoint}, 20);
+    BOOST_CHECK(pm.registerProof(proofSeq20));
+
+    // Wait for the cooldown so the conflicting proof makes it to the pool
+    mockTime += cooldown;
+    SetMockTime(mockTime);
+    auto proofSeq10 = buildProofWithSequence(key, {conflictingOutpoint}, 10);
+    ProofRegistrationState state;
+    BOOST_CHECK(!pm.registerProof(proofSeq10, state));
+    BOOST_CHECK(state.GetResult() == ProofRegistrationResult::CONFLICTING);
+    BOOST_CHECK(pm.isInConflictingPool(proofSeq10->getId()));
+
+    const fs::path testDumpPath = "test_avapeers_dump_cooldown.dat";
+    BOOST_CHECK(pm.dumpPeersToFile(testDumpPath));
+
+    // Restart before the cooldown of the restored peer has elapsed. The
+    // conflicting proof is still restored to the conflicting pool.
+    SetMockTime(mockTime + cooldown / 2);
+    avalanche::PeerManager pm2(PROOF_DUST_THRESHOLD, chainman);
+    std::unordered_set<ProofRef, SaltedProofHasher> registeredProofs;
+    BOOST_CHECK(pm2.loadPeersFromFile(testDumpPath, registeredProofs));
+    BOOST_CHECK_EQUAL(registeredProofs.size(), 1);
+    BOOST_CHECK_EQUAL((*registeredProofs.begin())->getId(),
+                      proofSeq20->getId());
+
+    BOOST_CHECK(pm2.isBoundToPeer(proofSeq20->getId()));
+    BOOST_CHECK(!pm2.isBoundToPeer(proofSeq10->getId()));
+    BOOST_CHECK(pm2.isInConflictingPool(proofSeq10->getId()));
+    BOOST_CHECK(!pm2.isImmature(proofSeq10->getId()));
+}
+
 BOOST_AUTO_TEST_CASE(dangling_proof_invalidation) {
     ChainstateManager &chainman = *Assert(m_node.chainman);
     avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
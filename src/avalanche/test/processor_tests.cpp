@@ -45,11 +45,18 @@ namespace {
 
         static std::vector<CInv> getInvsForNextPoll(Processor &p,
                                                     bool forPoll = false) {
-            auto r = p.voteRecords.getReadView();
+            auto r = p.getVoteRecordsReadViews();
             return p.getInvsForNextPoll(r, DEFAULT_AVALANCHE_MAX_ELEMENT_POLL,
                                         forPoll);
         }
 
+        static std::vector<std::vector<CInv>>
+        getInvsForNextPolls(Processor &p,
+                            const std::vector<size_t> &max_elements) {
+            auto r = p.getVoteRecordsReadViews();
+            return p.getInvsForNextPolls(r, max_elements);
+        }
+
         static NodeId getSuitableNodeToQuery(Processor &p) {
             return WITH_LOCK(p.cs_peerManager,
                              return p.peerManager->selectNode());
@@ -71,12 +78,12 @@ namespace {
 
         static void addVoteRecord(Processor &p, AnyVoteItem &item,
                                   VoteRecord &voteRecord) {
-            p.voteRecords.getWriteView()->insert(
+            p.getVoteRecords(item).getWriteView()->insert(
                 std::make_pair(item, voteRecord));
         }
 
         static void removeVoteRecord(Processor &p, AnyVoteItem &item) {
-            p.voteRecords.getWriteView()->erase(item);
+            p.getVoteRecords(item).getWriteView()->erase(item);
         }
 
         static void setFinalizationTip(Processor &p,
@@ -224,6 +231,12 @@ struct AvalancheProcessorTestingSetup : public AvalancheTestChain100Setup {
         return AvalancheTest::getInvsForNextPoll(*m_node.avalanche, forPoll);
     }
 
+    std::vector<std::vector<CInv>>
+    getInvsForNextPolls(const std::vector<size_t> &max_elements) {
+        return AvalancheTest::getInvsForNextPolls(*m_node.avalanche,
+                                                  max_elements);
+    }
+
     uint64_t getRound() const {
         return AvalancheTest::getRound(*m_node.avalanche);
     }
@@ -1032,6 +1045,11 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(poll_and_response, P, VoteItemProviders) {
     uint64_t queryRound = getRound();
     runEventLoop();
 
+    // The size of the responses is bounded by the pending poll.
+    BOOST_CHECK_EQUAL(m_node.avalanche->getMaxPendingPollSize(avanodeid), 1);
+    BOOST_CHECK_EQUAL(
+        m_node.avalanche->getMaxPendingPollSize(avanodeid + 1234), 0);
+
     resp = {queryRound + 1, 0, {Vote()}};
     checkRegisterVotesError(avanodeid, resp, "unexpected-ava-response");
 
@@ -1048,6 +1066,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(poll_and_response, P, VoteItemProviders) {
     BOOST_CHECK(registerVotes(avanodeid, resp, updates));
     BOOST_CHECK_EQUAL(updates.size(), 0);
     BOOST_CHECK_EQUAL(getSuitableNodeToQuery(), avanodeid);
+    BOOST_CHECK_EQUAL(m_node.avalanche->getMaxPendingPollSize(avanodeid), 0);
 
     // Out of order response are rejected.
     const auto item2 = provider.buildVoteItem();
@@ -1329,6 +1348,99 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(clear_inflight_requests, P, VoteItemProviders) {
     BOOST_CHECK(getInvsForNextPoll().empty());
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(poll_fanout, P, VoteItemProviders) {
+    P provider(this);
+
+    constexpr size_t numItems = 3;
+    for (size_t i = 0; i < numItems; i++) {
+        BOOST_CHECK(addToReconcile(provider.buildVoteItem()));
+    }
+    const std::vector<CInv> allInvs = getInvsForNextPoll();
+    BOOST_CHECK_EQUAL(allInvs.size(), numItems);
+
+    auto checkInvs = [&](const std::vector<CInv> &invs, size_t begin,
+                         size_t end) {
+        BOOST_CHECK_EQUAL(invs.size(), end - begin);
+        for (size_t i = 0; i < invs.size(); i++) {
+            BOOST_CHECK_EQUAL(invs[i].type, allInvs[begin + i].type);
+            BOOST_CHECK(invs[i].hash == allInvs[begin + i].hash);
+        }
+    };
+
+    // Every poll gets all the items as long as there is room for them.
+    auto polls = getInvsForNextPolls({numItems, numItems, 2, 0});
+    BOOST_CHECK_EQUAL(polls.size(), 4);
+    checkInvs(polls[0], 0, numItems);
+    checkInvs(polls[1], 0, numItems);
+    checkInvs(polls[2], 0, 2);
+    BOOST_CHECK(polls[3].empty());
+
+    // The polls are accounted for: the first items have been polled 3 times,
+    // the last one only twice.
+    for (int i = 3; i < AVALANCHE_MAX_INFLIGHT_POLL; i++) {
+        BOOST_CHECK_EQUAL(getInvsForNextPoll(/*forPoll=*/true).size(),
+                          numItems);
+    }
+    checkInvs(getInvsForNextPoll(), 2, numItems);
+
+    // Once the items are saturated the following polls are left empty.
+    polls = getInvsForNextPolls({numItems, numItems});
+    checkInvs(polls[0], 2, numItems);
+    BOOST_CHECK(polls[1].empty());
+    BOOST_CHECK(getInvsForNextPoll().empty());
+}
+
+BOOST_AUTO_TEST_CASE(poll_fanout_dispatch) {
+    constexpr size_t pollFanout = 3;
+    setArg("-avapollfanout", ToString(pollFanout));
+    setArg("-avalanchestakingpreconsensus", "0");
+
+    SyncWithValidationInterfaceQueue();
+    bilingual_str error;
+    m_node.avalanche = Processor::MakeProcessor(
+        *m_node.args, *m_node.chain, m_node.connman.get(),
+        *Assert(m_node.chainman), m_node.mempool.get(), *m_node.scheduler,
+        error);
+    BOOST_CHECK(m_node.avalanche);
+
+    // One node per peer, so several of them can be selected for the same
+    // poll, and enough of them for the quorum.
+    constexpr size_t numNodes = 8;
+    std::vector<NodeId> nodeids;
+    for (size_t i = 0; i < numNodes; i++) {
+        CNode *n = ConnectNode(NODE_AVALANCHE);
+        BOOST_CHECK(addNode(n->GetId()));
+        nodeids.push_back(n->GetId());
+    }
+
+    BlockProvider provider(this);
+    const auto item = provider.buildVoteItem();
+    const auto itemid = provider.getVoteItemId(item);
+    BOOST_CHECK(addToReconcile(item));
+
+    const uint64_t firstRound = getRound();
+    runEventLoop();
+
+    // A single poll is sent to pollFanout distinct nodes, each of them with
+    // its own round.
+    BOOST_CHECK_EQUAL(getRound(), firstRound + pollFanout);
+    std::set<NodeId> polledNodes;
+    std::set<uint64_t> rounds;
+    std::vector<avalanche::VoteItemUpdate> updates;
+    for (const NodeId nodeid : nodeids) {
+        for (uint64_t r = firstRound; r < firstRound + pollFanout; r++) {
+            if (registerVotes(nodeid, Response(r, 0, {Vote(0, itemid)}),
+                              updates)) {
+                polledNodes.insert(nodeid);
+                rounds.insert(r);
+                break;
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(polledNodes.size(), pollFanout);
+    BOOST_CHECK_EQUAL(rounds.size(), pollFanout);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(poll_inflight_accounting, P, VoteItemProviders) {
     P provider(this);
     const uint32_t invType = provider.invType;
@@ -1926,6 +2038,30 @@ BOOST_AUTO_TEST_CASE(quorum_detection_parameter_validation) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(poll_fanout_parameter_validation) {
+    const std::vector<std::pair<std::string, bool>> testCases = {
+        {"-1", false},
+        {"0", false},
+        {ToString(uint64_t{std::numeric_limits<uint32_t>::max()} + 1), false},
+        {"1", true},
+        {"2", true},
+        {ToString(std::numeric_limits<uint32_t>::max()), true},
+    };
+
+    for (const auto &[pollFanout, success] : testCases) {
+        setArg("-avapollfanout", pollFanout);
+
+        bilingual_str error;
+        std::unique_ptr<Processor> processor = Processor::MakeProcessor(
+            *m_node.args, *m_node.chain, m_node.connman.get(),
+            *Assert(m_node.chainman), m_node.mempool.get(), *m_node.scheduler,
+            error);
+
+        BOOST_CHECK_EQUAL(processor != nullptr, success);
+        BOOST_CHECK_EQUAL(error.empty(), success);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(min_avaproofs_messages) {
     ChainstateManager &chainman = *Assert(m_node.chainman);
 
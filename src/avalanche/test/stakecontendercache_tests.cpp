@@ -5,6 +5,7 @@
 #include <avalanche/stakecontendercache.h>
 
 #include <avalanche/peermanager.h>
+#include <avalanche/rewardrankcomparator.h>
 #include <script/script.h>
 
 #include <avalanche/test/util.h>
@@ -15,6 +16,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <limits>
 
 using namespace avalanche;
@@ -597,4 +599,82 @@ BOOST_AUTO_TEST_CASE(pollable_contenders_tests) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(ranking_tests) {
+    Chainstate &active_chainstate = Assert(m_node.chainman)->ActiveChainstate();
+    StakeContenderCache cache;
+
+    CBlockIndex *pindex = active_chainstate.m_chain.Tip();
+    const BlockHash &blockhash = pindex->GetBlockHash();
+
+    // Contenders with various scores, so the ranking is not only driven by the
+    // contender id.
+    struct Contender {
+        StakeContenderId id;
+        ProofId proofid;
+        double rank;
+        bool accepted;
+    };
+    std::vector<Contender> expected;
+    for (size_t i = 0; i < 50; i++) {
+        const uint32_t score = MIN_VALID_PROOF_SCORE * (1 + m_rng.randrange(5));
+        auto proof = buildRandomProof(active_chainstate, score);
+        const bool accepted = m_rng.randbool();
+        BOOST_CHECK(cache.add(pindex, proof,
+                              accepted ? StakeContenderStatus::ACCEPTED
+                                       : StakeContenderStatus::UNKNOWN));
+
+        StakeContenderId contenderId(blockhash, proof->getId());
+        expected.push_back({contenderId, proof->getId(),
+                            contenderId.ComputeProofRewardRank(score),
+                            accepted});
+    }
+
+    // Accepted contenders first, then by reward rank
+    std::sort(expected.begin(), expected.end(),
+              [](const Contender &left, const Contender &right) {
+                  if (left.accepted != right.accepted) {
+                      return left.accepted;
+                  }
+                  return RewardRankComparator()(left.id, left.rank,
+                                                left.proofid, right.id,
+                                                right.rank, right.proofid);
+              });
+
+    for (size_t maxPollable : {0, 1, 12, 50, 100}) {
+        std::vector<StakeContenderId> contenders;
+        const size_t numPollable = std::min(maxPollable, expected.size());
+        BOOST_CHECK_EQUAL(
+            cache.getPollableContenders(blockhash, maxPollable, contenders),
+            numPollable);
+
+        // The selected contenders are returned sorted by reward rank only
+        std::vector<Contender> selected(expected.begin(),
+                                        expected.begin() + numPollable);
+        std::sort(selected.begin(), selected.end(),
+                  [](const Contender &left, const Contender &right) {
+                      return RewardRankComparator()(left.id, left.rank,
+                                                    left.proofid, right.id,
+                                                    right.rank, right.proofid);
+                  });
+        for (size_t i = 0; i < numPollable; i++) {
+            BOOST_CHECK_EQUAL(contenders[i], selected[i].id);
+        }
+    }
+
+    // All the contenders are winners, the order is the same as above
+    for (const auto &contender : expected) {
+        BOOST_CHECK(cache.finalize(contender.id));
+        if (!contender.accepted) {
+            BOOST_CHECK(cache.reject(contender.id));
+        }
+    }
+
+    std::vector<std::pair<ProofId, CScript>> winners;
+    BOOST_CHECK(cache.getWinners(blockhash, winners));
+    BOOST_CHECK_EQUAL(winners.size(), expected.size());
+    for (size_t i = 0; i < winners.size(); i++) {
+        BOOST_CHECK_EQUAL(winners[i].first, expected[i].proofid);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
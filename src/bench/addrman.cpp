@@ -8,7 +8,9 @@
 #include <util/check.h>
 #include <util/time.h>
 
+#include <atomic>
 #include <optional>
+#include <thread>
 #include <vector>
 
 /*
@@ -22,6 +24,23 @@ static constexpr size_t NUM_ADDRESSES_PER_SOURCE = 256;
 static std::vector<CAddress> g_sources;
 static std::vector<std::vector<CAddress>> g_addresses;
 
+static CAddress RandAddr(FastRandomContext &rng) {
+    in6_addr addr;
+    memcpy(&addr, rng.randbytes(sizeof(addr)).data(), sizeof(addr));
+
+    uint16_t port;
+    memcpy(&port, rng.randbytes(sizeof(port)).data(), sizeof(port));
+    if (port == 0) {
+        port = 1;
+    }
+
+    CAddress ret(CService(addr, port), NODE_NETWORK);
+
+    ret.nTime = Now<NodeSeconds>();
+
+    return ret;
+}
+
 static void CreateAddresses() {
     // already created
     if (g_sources.size() > 0) {
@@ -30,28 +49,11 @@ static void CreateAddresses() {
 
     FastRandomContext rng(uint256(std::vector<uint8_t>(32, 123)));
 
-    auto randAddr = [&rng]() {
-        in6_addr addr;
-        memcpy(&addr, rng.randbytes(sizeof(addr)).data(), sizeof(addr));
-
-        uint16_t port;
-        memcpy(&port, rng.randbytes(sizeof(port)).data(), sizeof(port));
-        if (port == 0) {
-            port = 1;
-        }
-
-        CAddress ret(CService(addr, port), NODE_NETWORK);
-
-        ret.nTime = Now<NodeSeconds>();
-
-        return ret;
-    };
-
     for (size_t source_i = 0; source_i < NUM_SOURCES; ++source_i) {
-        g_sources.emplace_back(randAddr());
+        g_sources.emplace_back(RandAddr(rng));
         g_addresses.emplace_back();
         for (size_t addr_i = 0; addr_i < NUM_ADDRESSES_PER_SOURCE; ++addr_i) {
-            g_addresses[source_i].emplace_back(randAddr());
+            g_addresses[source_i].emplace_back(RandAddr(rng));
         }
     }
 }
@@ -94,6 +96,36 @@ static void AddrManSelect(benchmark::Bench &bench) {
     });
 }
 
+static void AddrManSelectConcurrentAdd(benchmark::Bench &bench) {
+    AddrMan addrman(/*asmap=*/std::vector<bool>(),
+                    /*deterministic=*/false,
+                    /*consistency_check_ratio=*/0);
+
+    FillAddrMan(addrman);
+
+    // Keep another thread busy adding new addresses, like the message handler
+    // thread does when processing addr messages, so the lock is contended.
+    std::atomic<bool> stop{false};
+    std::thread adder([&] {
+        FastRandomContext rng{/*fDeterministic=*/true};
+        std::vector<CAddress> addresses(NUM_ADDRESSES_PER_SOURCE);
+        while (!stop) {
+            for (CAddress &address : addresses) {
+                address = RandAddr(rng);
+            }
+            addrman.Add(addresses, RandAddr(rng));
+        }
+    });
+
+    bench.run([&] {
+        const auto &address = addrman.Select();
+        assert(address.first.GetPort() > 0);
+    });
+
+    stop = true;
+    adder.join();
+}
+
 static void AddrManGetAddr(benchmark::Bench &bench) {
     AddrMan addrman(/*asmap=*/std::vector<bool>(),
                     /*deterministic=*/false,
@@ -142,5 +174,6 @@ static void AddrManAddThenGood(benchmark::Bench &bench) {
 
 BENCHMARK(AddrManAdd);
 BENCHMARK(AddrManSelect);
+BENCHMARK(AddrManSelectConcurrentAdd);
 BENCHMARK(AddrManGetAddr);
 BENCHMARK(AddrManAddThenGood);
@@ -0,0 +1,114 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/peermanager.h>
+#include <avalanche/proofbuilder.h>
+#include <bench/bench.h>
+#include <common/args.h>
+#include <consensus/amount.h>
+#include <key.h>
+#include <random.h>
+#include <script/standard.h>
+#include <test/util/setup_common.h>
+#include <util/chaintype.h>
+#include <validation.h>
+
+#include <cassert>
+#include <limits>
+#include <vector>
+
+using namespace avalanche;
+
+static constexpr size_t NUM_PEERS = 2000;
+
+static ProofRef BuildProof(Chainstate &chainstate, uint32_t score) {
+    auto key = CKey::MakeCompressedKey();
+
+    const COutPoint outpoint(TxId(GetRandHash()), 0);
+    const Amount amount = (int64_t(score) * COIN) / 100;
+    const int height = 0;
+    const bool is_coinbase = false;
+
+    CScript script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    {
+        LOCK(cs_main);
+        chainstate.CoinsTip().AddCoin(
+            outpoint, Coin(CTxOut(amount, script), height, is_coinbase),
+            false);
+    }
+
+    ProofBuilder pb(0, std::numeric_limits<uint32_t>::max(),
+                    CKey::MakeCompressedKey(), script);
+    bool success =
+        pb.addUTXO(outpoint, amount, height, is_coinbase, std::move(key));
+    assert(success);
+    return pb.build();
+}
+
+/**
+ * Fill a peer manager with peers of various scores, each with a single node
+ * attached. If fragmented, one peer out of two is removed afterwards, leaving
+ * a dead slot behind.
+ */
+static void SelectBench(benchmark::Bench &bench, bool fragmented,
+                        bool selectNode) {
+    const auto testing_setup =
+        MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST);
+    ChainstateManager &chainman = *Assert(testing_setup->m_node.chainman);
+
+    // The proof verification reads the global args.
+    gArgs.ForceSetArg("-avaproofstakeutxoconfirmations", "1");
+
+    const uint32_t minScore = 100 * PROOF_DUST_THRESHOLD / COIN;
+
+    avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+    FastRandomContext rng(/*fDeterministic=*/true);
+    std::vector<ProofRef> proofs;
+    proofs.reserve(NUM_PEERS);
+    for (size_t i = 0; i < NUM_PEERS; i++) {
+        proofs.push_back(BuildProof(chainman.ActiveChainstate(),
+                                    minScore * (1 + rng.randrange(100))));
+        bool success = pm.registerProof(proofs.back()) &&
+                       pm.addNode(NodeId(i), proofs.back()->getId(),
+                                  DEFAULT_AVALANCHE_MAX_ELEMENT_POLL);
+        assert(success);
+    }
+
+    if (fragmented) {
+        for (size_t i = 0; i < NUM_PEERS; i += 2) {
+            bool success = pm.removeNode(NodeId(i));
+            assert(success);
+        }
+    }
+
+    gArgs.ClearForcedArg("-avaproofstakeutxoconfirmations");
+
+    if (selectNode) {
+        bench.run([&] { assert(pm.selectNode() != NO_NODE); });
+        return;
+    }
+
+    bench.run([&] { assert(pm.selectPeer() != NO_PEER); });
+}
+
+static void AvalancheSelectPeer(benchmark::Bench &bench) {
+    SelectBench(bench, /*fragmented=*/false, /*selectNode=*/false);
+}
+
+static void AvalancheSelectPeerFragmented(benchmark::Bench &bench) {
+    SelectBench(bench, /*fragmented=*/true, /*selectNode=*/false);
+}
+
+static void AvalancheSelectNode(benchmark::Bench &bench) {
+    SelectBench(bench, /*fragmented=*/false, /*selectNode=*/true);
+}
+
+static void AvalancheSelectNodeFragmented(benchmark::Bench &bench) {
+    SelectBench(bench, /*fragmented=*/true, /*selectNode=*/true);
+}
+
+BENCHMARK(AvalancheSelectPeer);
+BENCHMARK(AvalancheSelectPeerFragmented);
+BENCHMARK(AvalancheSelectNode);
+BENCHMARK(AvalancheSelectNodeFragmented);
@@ -0,0 +1,471 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/peermanager.h>
+#include <avalanche/processor.h>
+#include <avalanche/proofbuilder.h>
+#include <avalanche/protocol.h>
+#include <bench/bench.h>
+#include <consensus/amount.h>
+#include <key.h>
+#include <net.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/standard.h>
+#include <sync.h>
+#include <txmempool.h>
+#include <util/chaintype.h>
+#include <validation.h>
+
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// This file contains an end-to-end simulation of the avalanche polling: an
+/// in-process Processor polls synthetic staked peers that answer after a
+/// configurable number of event loop iterations, with configurable error and
+/// conflicting vote rates. The benchmarks measure the finalization throughput,
+/// and print the polls/s and the finalization latency distribution.
+
+using namespace avalanche;
+
+namespace avalanche {
+namespace {
+    struct AvalancheTest {
+        static void runEventLoop(Processor &p) { p.runEventLoop(); }
+
+        static void setQuorumEstablished(Processor &p) {
+            p.quorumIsEstablished = true;
+        }
+
+        struct SentPoll {
+            NodeId nodeid;
+            uint64_t round;
+            std::vector<CInv> invs;
+        };
+
+        /** Get the polls sent since the last call. */
+        static std::vector<SentPoll> getNewPolls(Processor &p,
+                                                 uint64_t &nextRound) {
+            std::vector<SentPoll> polls;
+            auto r = p.queries.getReadView();
+            for (const auto &query : r) {
+                if (query.round >= nextRound) {
+                    polls.push_back({query.nodeid, query.round, query.invs});
+                }
+            }
+            nextRound = p.round;
+            return polls;
+        }
+    };
+} // namespace
+} // namespace avalanche
+
+namespace {
+
+struct SimulationParams {
+    size_t numPeers{64};
+    /** Number of items of each type (block, proof, tx) being voted on. */
+    size_t itemsPerType{16};
+    /** Number of event loop iterations before a peer answers a poll. */
+    uint64_t latency{1};
+    /** Percentage of votes for which the peer doesn't know the item. */
+    uint32_t errorRate{0};
+    /** Percentage of votes that disagree with the expected outcome. */
+    uint32_t conflictRate{0};
+    size_t pollFanout{1};
+    /** Register the responses from a different thread than the polls. */
+    bool concurrent{false};
+};
+
+class Simulation {
+    const SimulationParams params;
+    std::unique_ptr<const AvalancheTestingSetup> setup;
+    Processor &processor;
+    ChainstateManager &chainman;
+    CTxMemPool &mempool;
+    // The votes are drawn by the polling thread and the new items are built by
+    // the responding thread, so they each get their own randomness.
+    FastRandomContext voteRng{/*fDeterministic=*/true};
+    FastRandomContext itemRng{/*fDeterministic=*/true};
+
+    std::vector<CNode *> nodes;
+    uint64_t nextRound{0};
+    std::atomic<uint64_t> tick{0};
+
+    struct PendingResponse {
+        uint64_t dueTick;
+        NodeId nodeid;
+        Response response;
+    };
+    Mutex cs_pending;
+    std::deque<PendingResponse> pending GUARDED_BY(cs_pending);
+
+    /** Tick at which each item in flight was added. */
+    std::unordered_map<uint256, uint64_t, SaltedUint256Hasher> itemsAddedAt;
+    uint32_t blockNonce{0};
+
+public:
+    std::atomic<uint64_t> numPolls{0};
+    std::atomic<uint64_t> numFinalized{0};
+    uint64_t numStale{0};
+    uint64_t numInvalid{0};
+    std::vector<uint64_t> finalizationLatencies;
+
+    static std::vector<std::string> MakeArgs(const SimulationParams &params) {
+        return {"-avapollfanout=" + std::to_string(params.pollFanout)};
+    }
+
+    static std::unique_ptr<const AvalancheTestingSetup>
+    MakeSetup(const SimulationParams &params) {
+        const auto args = MakeArgs(params);
+        std::vector<const char *> extra_args;
+        for (const auto &arg : args) {
+            extra_args.push_back(arg.c_str());
+        }
+        return MakeNoLogFileContext<const AvalancheTestingSetup>(
+            ChainType::REGTEST, extra_args);
+    }
+
+    explicit Simulation(const SimulationParams &paramsIn)
+        : params(paramsIn), setup(MakeSetup(params)),
+          processor(*setup->m_node.avalanche),
+          chainman(*Assert(setup->m_node.chainman)),
+          mempool(*Assert(setup->m_node.mempool)) {
+        // Synthetic staked peers, each with a single node attached.
+        for (size_t i = 0; i < params.numPeers; i++) {
+            const ProofRef proof = buildProof(1 + itemRng.randrange(100));
+            const NodeId nodeid = NodeId(i);
+
+            auto node = new CNode(nodeid, /*sock=*/nullptr,
+                                  CAddress(ip(i), NODE_NONE),
+                                  /*nKeyedNetGroupIn=*/0,
+                                  /*nLocalHostNonceIn=*/0,
+                                  /*nLocalExtraEntropyIn=*/0, CAddress(),
+                                  /*pszDest=*/"",
+                                  ConnectionType::OUTBOUND_FULL_RELAY,
+                                  /*inbound_onion=*/false);
+            node->SetCommonVersion(PROTOCOL_VERSION);
+            node->nVersion = 1;
+            node->fSuccessfullyConnected = true;
+            setup->m_connman->AddTestNode(*node);
+            nodes.push_back(node);
+
+            bool success =
+                processor.withPeerManager([&](avalanche::PeerManager &pm) {
+                    return pm.registerProof(proof) &&
+                           pm.addNode(nodeid, proof->getId(),
+                                      DEFAULT_AVALANCHE_MAX_ELEMENT_POLL);
+                });
+            assert(success);
+        }
+
+        // The quorum conditions other than the node count are not what this
+        // simulation is about.
+        AvalancheTest::setQuorumEstablished(processor);
+
+        for (size_t i = 0; i < params.itemsPerType; i++) {
+            addBlock();
+            addProof();
+            addTx();
+        }
+    }
+
+    /** Run the simulation until the given number of items finalized. */
+    void runUntilFinalized(uint64_t count) {
+        const uint64_t target = numFinalized + count;
+
+        if (!params.concurrent) {
+            while (numFinalized < target) {
+                poll();
+                respond();
+            }
+            return;
+        }
+
+        std::atomic<bool> done{false};
+        std::thread responder([&] {
+            while (!done) {
+                respond();
+            }
+        });
+        while (numFinalized < target) {
+            poll();
+        }
+        done = true;
+        responder.join();
+    }
+
+private:
+    static CService ip(uint32_t i) {
+        struct in_addr s;
+        s.s_addr = 0x0100000a + i;
+        return CService(CNetAddr(s), Params().GetDefaultPort());
+    }
+
+    ProofRef buildProof(uint32_t scoreFactor) {
+        auto key = CKey::MakeCompressedKey();
+
+        const COutPoint outpoint(TxId(itemRng.rand256()), 0);
+        const Amount amount = int64_t(scoreFactor) * PROOF_DUST_THRESHOLD;
+        const int height = 0;
+
+        CScript script = GetScriptForDestination(PKHash(key.GetPubKey()));
+        {
+            LOCK(cs_main);
+            chainman.ActiveChainstate().CoinsTip().AddCoin(
+                outpoint, Coin(CTxOut(amount, script), height, false), false);
+        }
+
+        ProofBuilder pb(0, std::numeric_limits<uint32_t>::max(),
+                        CKey::MakeCompressedKey(), script);
+        bool success = pb.addUTXO(outpoint, amount, height, false, key);
+        assert(success);
+        return pb.build();
+    }
+
+    void track(const uint256 &itemid) { itemsAddedAt.emplace(itemid, tick); }
+
+    void addBlock() {
+        // Competing headers on top of genesis, so finalizing one of them
+        // doesn't prevent polling for the others.
+        const CBlockIndex *pindex;
+        {
+            LOCK(cs_main);
+            const CBlockIndex *genesis = chainman.ActiveChain().Genesis();
+
+            CBlockHeader header;
+            header.nVersion = 1;
+            header.hashPrevBlock = genesis->GetBlockHash();
+            header.nTime = genesis->nTime + 1;
+            header.nBits = genesis->nBits;
+            header.nNonce = ++blockNonce;
+            pindex = chainman.m_blockman.AddToBlockIndex(
+                header, header.GetHash(), chainman.m_best_header);
+        }
+
+        bool success = processor.addToReconcile(pindex);
+        assert(success);
+        track(pindex->GetBlockHash());
+    }
+
+    void addProof() {
+        const ProofRef proof = buildProof(1);
+        bool success =
+            processor.withPeerManager([&](avalanche::PeerManager &pm) {
+                return pm.registerProof(proof);
+            });
+        success &= processor.addToReconcile(proof);
+        assert(success);
+        track(proof->getId());
+    }
+
+    void addTx() {
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(COutPoint(TxId(itemRng.rand256()), 0));
+        mtx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+        const CTransactionRef tx = MakeTransactionRef(mtx);
+        {
+            LOCK2(cs_main, mempool.cs);
+            mempool.addUnchecked(
+                TestMemPoolEntryHelper().Fee(10000 * SATOSHI).FromTx(tx));
+        }
+
+        bool success = processor.addToReconcile(tx);
+        assert(success);
+        track(tx->GetId());
+    }
+
+    /** Run one event loop iteration and queue the answers from the peers. */
+    void poll() {
+        const uint64_t now = ++tick;
+
+        AvalancheTest::runEventLoop(processor);
+
+        auto polls = AvalancheTest::getNewPolls(processor, nextRound);
+        if (polls.empty()) {
+            return;
+        }
+
+        std::vector<PendingResponse> responses;
+        responses.reserve(polls.size());
+        for (auto &poll : polls) {
+            // The poll messages are not read, drop them.
+            CNode *node = nodes[poll.nodeid];
+            {
+                LOCK(node->cs_vSend);
+                node->vSendMsg.clear();
+                node->nSendSize = 0;
+            }
+
+            std::vector<Vote> votes;
+            votes.reserve(poll.invs.size());
+            for (const CInv &inv : poll.invs) {
+                uint32_t error = 0;
+                const uint32_t roll = voteRng.randrange(100);
+                if (roll < params.errorRate) {
+                    // Unknown item
+                    error = uint32_t(-1);
+                } else if (roll < params.errorRate + params.conflictRate) {
+                    error = 1;
+                }
+                votes.emplace_back(error, inv.hash);
+            }
+
+            responses.push_back({now + params.latency, poll.nodeid,
+                                 Response(poll.round, 0, std::move(votes))});
+        }
+
+        LOCK(cs_pending);
+        pending.insert(pending.end(), responses.begin(), responses.end());
+    }
+
+    /** Register the responses that are due. */
+    void respond() {
+        std::vector<PendingResponse> due;
+        {
+            LOCK(cs_pending);
+            while (!pending.empty() && pending.front().dueTick <= tick) {
+                due.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+        }
+
+        for (const auto &r : due) {
+            std::vector<VoteItemUpdate> updates;
+            bool disconnect;
+            std::string error;
+            bool success = processor.registerVotes(r.nodeid, r.response,
+                                                   updates, disconnect, error);
+            assert(success);
+            numPolls++;
+
+            for (const auto &update : updates) {
+                handleUpdate(update);
+            }
+        }
+    }
+
+    void handleUpdate(const VoteItemUpdate &update) {
+        const VoteStatus status = update.getStatus();
+        if (status != VoteStatus::Finalized && status != VoteStatus::Invalid &&
+            status != VoteStatus::Stale) {
+            return;
+        }
+
+        const AnyVoteItem &item = update.getVoteItem();
+        uint256 itemid;
+        if (auto pindex = std::get_if<const CBlockIndex *>(&item)) {
+            itemid = (*pindex)->GetBlockHash();
+            addBlock();
+        } else if (auto proof = std::get_if<const ProofRef>(&item)) {
+            itemid = (*proof)->getId();
+            addProof();
+        } else if (auto tx = std::get_if<const CTransactionRef>(&item)) {
+            itemid = (*tx)->GetId();
+            addTx();
+        }
+
+        auto it = itemsAddedAt.find(itemid);
+        assert(it != itemsAddedAt.end());
+        const uint64_t latency = tick - it->second;
+        itemsAddedAt.erase(it);
+
+        if (status == VoteStatus::Stale) {
+            numStale++;
+            return;
+        }
+        if (status == VoteStatus::Invalid) {
+            numInvalid++;
+            return;
+        }
+
+        finalizationLatencies.push_back(latency);
+        numFinalized++;
+    }
+};
+
+} // namespace
+
+/** Items to finalize per benchmark iteration. */
+static constexpr uint64_t FINALIZED_PER_ITERATION{16};
+
+static void RunSimulation(benchmark::Bench &bench,
+                          const SimulationParams &params) {
+    Simulation sim(params);
+
+    const auto start = std::chrono::steady_clock::now();
+    bench.unit("item").batch(FINALIZED_PER_ITERATION).run([&] {
+        sim.runUntilFinalized(FINALIZED_PER_ITERATION);
+    });
+    const auto elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+    auto *out = bench.output();
+    if (!out || sim.finalizationLatencies.empty()) {
+        return;
+    }
+
+    auto &latencies = sim.finalizationLatencies;
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](size_t p) {
+        return latencies[std::min(latencies.size() - 1,
+                                  latencies.size() * p / 100)];
+    };
+    *out << strprintf("%s: %.0f polls/s, %d finalized, %d invalid, %d stale, "
+                      "finalization latency in event loop iterations "
+                      "p50=%d p90=%d p99=%d max=%d\n",
+                      bench.name(), sim.numPolls / elapsed,
+                      sim.numFinalized.load(), sim.numInvalid, sim.numStale,
+                      percentile(50), percentile(90), percentile(99),
+                      latencies.back());
+}
+
+static void AvalancheSimulation(benchmark::Bench &bench) {
+    RunSimulation(bench, {});
+}
+
+static void AvalancheSimulationLatency(benchmark::Bench &bench) {
+    SimulationParams params;
+    params.latency = 5;
+    RunSimulation(bench, params);
+}
+
+static void AvalancheSimulationConflicts(benchmark::Bench &bench) {
+    SimulationParams params;
+    params.errorRate = 5;
+    params.conflictRate = 10;
+    RunSimulation(bench, params);
+}
+
+static void AvalancheSimulationFanout(benchmark::Bench &bench) {
+    SimulationParams params;
+    params.pollFanout = 4;
+    RunSimulation(bench, params);
+}
+
+static void AvalancheSimulationConcurrent(benchmark::Bench &bench) {
+    SimulationParams params;
+    params.pollFanout = 4;
+    params.concurrent = true;
+    RunSimulation(bench, params);
+}
+
+BENCHMARK(AvalancheSimulation);
+BENCHMARK(AvalancheSimulationLatency);
+BENCHMARK(AvalancheSimulationConflicts);
+BENCHMARK(AvalancheSimulationFanout);
+BENCHMARK(AvalancheSimulationConcurrent);
@@ -6,6 +6,7 @@
 
 #include <clientversion.h>
 #include <common/args.h>
+#include <crypto/muhash.h>
 #include <crypto/sha256.h>
 #include <util/fs.h>
 #include <util/strencodings.h>
@@ -66,6 +67,7 @@ int main(int argc, char **argv) {
     ArgsManager argsman;
     SetupBenchArgs(argsman);
     SHA256AutoDetect();
+    MuHash3072AutoDetect();
     std::string error;
     if (!argsman.ParseParameters(argc, argv, error)) {
         tfm::format(std::cerr, "Error parsing command line arguments: %s\n",
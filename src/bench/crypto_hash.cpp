@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <crypto/common.h>
 #include <crypto/muhash.h>
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
@@ -95,6 +96,18 @@ static void MuHash(benchmark::Bench &bench) {
     });
 }
 
+static void MuHashInsert(benchmark::Bench &bench) {
+    MuHash3072 acc;
+    FastRandomContext rng(true);
+    std::vector<uint8_t> key{rng.randbytes(32)};
+    uint32_t i = 0;
+
+    bench.run([&] {
+        WriteLE32(key.data(), ++i);
+        acc.Insert(key);
+    });
+}
+
 static void MuHashMul(benchmark::Bench &bench) {
     MuHash3072 acc;
     FastRandomContext rng(true);
@@ -144,6 +157,7 @@ BENCHMARK(FastRandom_32bit);
 BENCHMARK(FastRandom_1bit);
 
 BENCHMARK(MuHash);
+BENCHMARK(MuHashInsert);
 BENCHMARK(MuHashMul);
 BENCHMARK(MuHashDiv);
 BENCHMARK(MuHashPrecompute);
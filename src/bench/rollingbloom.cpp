@@ -4,6 +4,8 @@
 
 #include <bench/bench.h>
 #include <common/bloom.h>
+#include <common/rollingidset.h>
+#include <uint256.h>
 
 static void RollingBloom(benchmark::Bench &bench) {
     CRollingBloomFilter filter(120000, 0.000001);
@@ -30,5 +32,33 @@ static void RollingBloomReset(benchmark::Bench &bench) {
     bench.run([&] { filter.reset(); });
 }
 
+// Same workload as RollingBloom, for comparison.
+static void RollingIdSetBench(benchmark::Bench &bench) {
+    RollingIdSet set(120000);
+    uint256 data;
+    uint32_t count = 0;
+    bench.run([&] {
+        count++;
+        data.data()[0] = count & 0xFF;
+        data.data()[1] = (count >> 8) & 0xFF;
+        data.data()[2] = (count >> 16) & 0xFF;
+        data.data()[3] = (count >> 24) & 0xFF;
+        set.insert(data);
+
+        data.data()[0] = (count >> 24) & 0xFF;
+        data.data()[1] = (count >> 16) & 0xFF;
+        data.data()[2] = (count >> 8) & 0xFF;
+        data.data()[3] = count & 0xFF;
+        set.contains(data);
+    });
+}
+
+static void RollingIdSetReset(benchmark::Bench &bench) {
+    RollingIdSet set(120000);
+    bench.run([&] { set.reset(); });
+}
+
 BENCHMARK(RollingBloom);
 BENCHMARK(RollingBloomReset);
+BENCHMARK(RollingIdSetBench);
+BENCHMARK(RollingIdSetReset);
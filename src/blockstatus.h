@@ -116,6 +116,18 @@ public:
 
     SERIALIZE_METHODS(BlockStatus, obj) { READWRITE(VARINT(obj.status)); }
 
+    /** Serialize as a fixed size integer, for fixed size records. */
+    struct FixedSizeFormatter {
+        template <typename Stream>
+        static void Ser(Stream &s, const BlockStatus &obj) {
+            ::Serialize(s, obj.status);
+        }
+        template <typename Stream>
+        static void Unser(Stream &s, BlockStatus &obj) {
+            ::Unserialize(s, obj.status);
+        }
+    };
+
     friend constexpr bool operator==(const BlockStatus a, const BlockStatus b) {
         return a.status == b.status;
     }
@@ -0,0 +1,111 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <common/rollingidset.h>
+
+#include <crypto/siphash.h>
+#include <memusage.h>
+#include <random.h>
+#include <uint256.h>
+#include <util/fastrange.h>
+
+#include <algorithm>
+#include <cassert>
+
+RollingIdSet::RollingIdSet(const uint32_t nElements) {
+    /* Keep GENERATIONS - 1 full generations on top of the current one, so at
+     * least nElements entries are remembered. */
+    nEntriesPerGeneration = std::max<uint32_t>(
+        1, (nElements + GENERATIONS - 2) / (GENERATIONS - 1));
+    /* Keep the load factor below 80% so the probe sequences stay short. */
+    const uint64_t nMaxEntries = uint64_t(nEntriesPerGeneration) * GENERATIONS;
+    table.resize(nMaxEntries * 5 / 4 + 1);
+    reset();
+}
+
+uint64_t RollingIdSet::GetKey(const uint256 &id) const {
+    return SipHashUint256(k0, k1, id) & ~TAG_MASK;
+}
+
+size_t RollingIdSet::GetPosition(uint64_t entry) const {
+    /* FastRange64 only uses the upper bits, so the tag is ignored. */
+    return FastRange64(entry, table.size());
+}
+
+size_t RollingIdSet::Find(uint64_t key) const {
+    size_t pos = GetPosition(key);
+    while (table[pos] != 0 && (table[pos] & ~TAG_MASK) != key) {
+        if (++pos == table.size()) {
+            pos = 0;
+        }
+    }
+    return pos;
+}
+
+void RollingIdSet::Erase(size_t pos) {
+    /* Shift the following entries of the cluster back so that none of them
+     * becomes unreachable (Knuth's algorithm R). */
+    size_t next = pos;
+    while (true) {
+        if (++next == table.size()) {
+            next = 0;
+        }
+        if (table[next] == 0) {
+            break;
+        }
+
+        /* The entry can stay if its position is cyclically in (pos, next]. */
+        const size_t home = GetPosition(table[next]);
+        if (pos <= next ? (pos < home && home <= next)
+                        : (pos < home || home <= next)) {
+            continue;
+        }
+
+        table[pos] = table[next];
+        pos = next;
+    }
+    table[pos] = 0;
+}
+
+void RollingIdSet::ExpireGeneration(uint8_t generation) {
+    for (size_t pos = 0; pos < table.size(); pos++) {
+        /* Erasing moves another entry in this slot, that may need to be
+         * erased as well. */
+        while ((table[pos] & TAG_MASK) == generation) {
+            Erase(pos);
+        }
+    }
+}
+
+void RollingIdSet::insert(const uint256 &id) {
+    if (nEntriesThisGeneration == nEntriesPerGeneration) {
+        nEntriesThisGeneration = 0;
+        nGeneration = nGeneration % GENERATIONS + 1;
+        /* All the tags are in use, so the next one is the oldest. */
+        ExpireGeneration(nGeneration);
+    }
+    nEntriesThisGeneration++;
+
+    const uint64_t key = GetKey(id);
+    const size_t pos = Find(key);
+    assert(table[pos] == 0 || (table[pos] & ~TAG_MASK) == key);
+    table[pos] = key | nGeneration;
+}
+
+bool RollingIdSet::contains(const uint256 &id) const {
+    return table[Find(GetKey(id))] != 0;
+}
+
+void RollingIdSet::reset() {
+    FastRandomContext rng;
+    k0 = rng.rand64();
+    k1 = rng.rand64();
+    nEntriesThisGeneration = 0;
+    nGeneration = 1;
+    std::fill(table.begin(), table.end(), 0);
+}
+
+size_t RollingIdSet::DynamicMemoryUsage() const {
+    return memusage::DynamicUsage(table);
+}
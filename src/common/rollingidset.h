@@ -0,0 +1,63 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_COMMON_ROLLINGIDSET_H
+#define BITCOIN_COMMON_ROLLINGIDSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class uint256;
+
+/**
+ * RollingIdSet remembers the most recently inserted ids, like
+ * CRollingBloomFilter does, but without false positives.
+ *
+ * The ids are stored as salted 64-bit hashes in a single open addressing
+ * table. The insertions are split into generations, and each entry is tagged
+ * with the generation it was last inserted in. When the current generation is
+ * full, the oldest one is expired as a whole and its tag is reused.
+ *
+ * contains() returns true for the last nElements ids that were inserted, and
+ * false for any id that was not inserted within the last
+ * nElements * GENERATIONS / (GENERATIONS - 1) insertions. A false positive
+ * requires a 61-bit hash collision with one of the remembered ids.
+ *
+ * It uses about 12 bytes per element, less than a CRollingBloomFilter with a
+ * false positive rate of 0.00001%, and a single hash per operation.
+ */
+class RollingIdSet {
+public:
+    explicit RollingIdSet(uint32_t nElements);
+
+    void insert(const uint256 &id);
+    bool contains(const uint256 &id) const;
+
+    void reset();
+
+    size_t DynamicMemoryUsage() const;
+
+private:
+    static constexpr int TAG_BITS = 3;
+    static constexpr uint64_t TAG_MASK = (uint64_t(1) << TAG_BITS) - 1;
+    /** Tag 0 marks the empty slots, every other tag is a live generation. */
+    static constexpr uint8_t GENERATIONS = TAG_MASK;
+
+    uint32_t nEntriesPerGeneration;
+    uint32_t nEntriesThisGeneration;
+    uint8_t nGeneration;
+    uint64_t k0;
+    uint64_t k1;
+    std::vector<uint64_t> table;
+
+    uint64_t GetKey(const uint256 &id) const;
+    size_t GetPosition(uint64_t entry) const;
+    /** Return the slot holding key, or the empty slot where it belongs. */
+    size_t Find(uint64_t key) const;
+    void Erase(size_t pos);
+    void ExpireGeneration(uint8_t generation);
+};
+
+#endif // BITCOIN_COMMON_ROLLINGIDSET_H
@@ -4,6 +4,7 @@
 
 #include <crypto/muhash.h>
 
+#include <compat/cpuid.h>
 #include <crypto/chacha20.h>
 #include <crypto/common.h>
 #include <hash.h>
@@ -11,7 +12,13 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <limits>
+#include <utility>
+
+namespace muhash_avx512ifma {
+void Multiply(uint64_t *out, const uint64_t *a, const uint64_t *b);
+}
 
 namespace {
 
@@ -37,6 +44,12 @@ constexpr limb_t MAX_PRIME_DIFF = 1103717;
  */
 constexpr limb_t MODULUS_INVERSE = limb_t(0x70a1421da087d93);
 
+/**
+ * Hardware accelerated computation of the full product of two Num3072, into
+ * 2 * LIMBS limbs, or nullptr to use the portable implementation.
+ */
+void (*MultiplyFull)(limb_t *out, const limb_t *a, const limb_t *b) = nullptr;
+
 /**
  * Extract the lowest limb of [c0,c1,c2] into n, and left shift the number by 1
  * limb.
@@ -574,26 +587,38 @@ void Num3072::Multiply(const Num3072 &a) {
     limb_t c0 = 0, c1 = 0, c2 = 0;
     Num3072 tmp;
 
-    /* Compute limbs 0..N-2 of this*a into tmp, including one reduction. */
-    for (int j = 0; j < LIMBS - 1; ++j) {
-        limb_t d0 = 0, d1 = 0, d2 = 0;
-        mul(d0, d1, this->limbs[1 + j], a.limbs[LIMBS + j - (1 + j)]);
-        for (int i = 2 + j; i < LIMBS; ++i) {
-            muladd3(d0, d1, d2, this->limbs[i], a.limbs[LIMBS + j - i]);
+    if (MultiplyFull) {
+        /* Compute this*a, then reduce it once into tmp. */
+        limb_t product[2 * LIMBS];
+        MultiplyFull(product, this->limbs, a.limbs);
+        for (int j = 0; j < LIMBS; ++j) {
+            limb_t d0 = product[LIMBS + j], d1 = 0, d2 = 0;
+            mulnadd3(c0, c1, c2, d0, d1, d2, MAX_PRIME_DIFF);
+            muladd3(c0, c1, c2, product[j], 1);
+            extract3(c0, c1, c2, tmp.limbs[j]);
         }
-        mulnadd3(c0, c1, c2, d0, d1, d2, MAX_PRIME_DIFF);
-        for (int i = 0; i < j + 1; ++i) {
-            muladd3(c0, c1, c2, this->limbs[i], a.limbs[j - i]);
+    } else {
+        /* Compute limbs 0..N-2 of this*a into tmp, including one reduction. */
+        for (int j = 0; j < LIMBS - 1; ++j) {
+            limb_t d0 = 0, d1 = 0, d2 = 0;
+            mul(d0, d1, this->limbs[1 + j], a.limbs[LIMBS + j - (1 + j)]);
+            for (int i = 2 + j; i < LIMBS; ++i) {
+                muladd3(d0, d1, d2, this->limbs[i], a.limbs[LIMBS + j - i]);
+            }
+            mulnadd3(c0, c1, c2, d0, d1, d2, MAX_PRIME_DIFF);
+            for (int i = 0; i < j + 1; ++i) {
+                muladd3(c0, c1, c2, this->limbs[i], a.limbs[j - i]);
+            }
+            extract3(c0, c1, c2, tmp.limbs[j]);
         }
-        extract3(c0, c1, c2, tmp.limbs[j]);
-    }
 
-    /* Compute limb N-1 of a*b into tmp. */
-    assert(c2 == 0);
-    for (int i = 0; i < LIMBS; ++i) {
-        muladd3(c0, c1, c2, this->limbs[i], a.limbs[LIMBS - 1 - i]);
+        /* Compute limb N-1 of a*b into tmp. */
+        assert(c2 == 0);
+        for (int i = 0; i < LIMBS; ++i) {
+            muladd3(c0, c1, c2, this->limbs[i], a.limbs[LIMBS - 1 - i]);
+        }
+        extract3(c0, c1, c2, tmp.limbs[LIMBS - 1]);
     }
-    extract3(c0, c1, c2, tmp.limbs[LIMBS - 1]);
 
     /* Perform a second reduction. */
     muln2(c0, c1, MAX_PRIME_DIFF);
@@ -712,3 +737,72 @@ MuHash3072 &MuHash3072::Remove(Span<const uint8_t> in) noexcept {
     m_denominator.Multiply(ToNum3072(in));
     return *this;
 }
+
+namespace {
+#if defined(HAVE___INT128) && defined(ENABLE_AVX512IFMA) &&                    \
+    defined(USE_ASM) && defined(HAVE_GETCPUID)
+/** Check whether the CPU supports AVX-512 IFMA and the OS enabled it. */
+bool AVX512IFMAEnabled() {
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_osxsave = (ecx >> 27) & 1;
+    if (!have_osxsave) {
+        return false;
+    }
+
+    // The OS must save the AVX-512 opmask and upper ZMM registers.
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    if ((a & 0xe6) != 0xe6) {
+        return false;
+    }
+
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    const bool have_avx512f = (ebx >> 16) & 1;
+    const bool have_avx512ifma = (ebx >> 21) & 1;
+    return have_avx512f && have_avx512ifma;
+}
+#endif
+
+/** Check the selected implementation against the portable one. */
+bool SelfTest() {
+    if (!MultiplyFull) {
+        return true;
+    }
+
+    // Use numbers above the modulus, so all the reductions are exercised.
+    Num3072 a, b;
+    for (int i = 0; i < LIMBS; ++i) {
+        a.limbs[i] = limb_t(0x0123456789abcdefULL * (i + 1));
+        b.limbs[i] = MAX_LIMB;
+    }
+
+    Num3072 result = a;
+    result.Multiply(b);
+
+    const auto multiply_full = std::exchange(MultiplyFull, nullptr);
+    Num3072 expected = a;
+    expected.Multiply(b);
+    MultiplyFull = multiply_full;
+
+    return std::memcmp(result.limbs, expected.limbs, sizeof(result.limbs)) ==
+           0;
+}
+} // namespace
+
+std::string MuHash3072AutoDetect(bool use_hardware) {
+    std::string ret = "standard";
+    MultiplyFull = nullptr;
+
+#if defined(HAVE___INT128) && defined(ENABLE_AVX512IFMA) &&                    \
+    defined(USE_ASM) && defined(HAVE_GETCPUID) &&                              \
+    !defined(BUILD_BITCOIN_INTERNAL)
+    if (use_hardware && AVX512IFMAEnabled()) {
+        MultiplyFull = muhash_avx512ifma::Multiply;
+        ret = "avx512ifma";
+    }
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
@@ -14,6 +14,7 @@
 #include <uint256.h>
 
 #include <cstdint>
+#include <string>
 
 class Num3072 {
 private:
@@ -139,4 +140,12 @@ public:
     }
 };
 
+/**
+ * Autodetect the best available implementation of the Num3072 multiplication,
+ * which is most of the cost of the MuHash3072 operations. The portable one is
+ * used if use_hardware is false.
+ * Returns the name of the implementation.
+ */
+std::string MuHash3072AutoDetect(bool use_hardware = true);
+
 #endif // BITCOIN_CRYPTO_MUHASH_H
@@ -0,0 +1,112 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX512IFMA
+
+#include <algorithm>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace muhash_avx512ifma {
+namespace {
+
+    /** Number of 64 bits limbs of a Num3072. */
+    constexpr int LIMBS = 48;
+    /** Number of 52 bits limbs needed to hold a Num3072. */
+    constexpr int LIMBS52 = 60;
+    /** Number of 52 bits limbs of the product, in blocks of 8 lanes. */
+    constexpr int PRODUCT_BLOCKS = 15;
+    constexpr int PRODUCT_LIMBS52 = 8 * PRODUCT_BLOCKS;
+    constexpr uint64_t MASK52 = (uint64_t{1} << 52) - 1;
+
+    /** Zero padding around b, so the shifted windows never read out of it. */
+    constexpr int B_PADDING = 64;
+
+    /** Convert LIMBS limbs of 64 bits into LIMBS52 limbs of 52 bits. */
+    void To52(uint64_t *out, const uint64_t *in) {
+        for (int i = 0; i < LIMBS52; ++i) {
+            const int limb = 52 * i / 64;
+            const int shift = 52 * i % 64;
+            uint64_t v = in[limb] >> shift;
+            if (shift > 64 - 52 && limb + 1 < LIMBS) {
+                v |= in[limb + 1] << (64 - shift);
+            }
+            out[i] = v & MASK52;
+        }
+    }
+
+    /** Convert normalized limbs of 52 bits into 2 * LIMBS limbs of 64 bits. */
+    void To64(uint64_t *out, const uint64_t *in) {
+        for (int i = 0; i < 2 * LIMBS; ++i) {
+            int limb = 64 * i / 52;
+            const int shift = 64 * i % 52;
+            uint64_t v = in[limb] >> shift;
+            for (int bits = 52 - shift; bits < 64 && limb + 1 < PRODUCT_LIMBS52;
+                 bits += 52) {
+                v |= in[++limb] << bits;
+            }
+            out[i] = v;
+        }
+    }
+
+} // namespace
+
+/**
+ * Compute the 6144 bits product of a and b, into 2 * LIMBS limbs of 64 bits.
+ *
+ * The numbers are converted to 52 bits limbs, and each block of 8 columns of
+ * the product is accumulated with the 52 bits multiply-add instructions, over
+ * windows of b shifted by the index of the limb of a. The sums don't carry
+ * since there are at most LIMBS52 terms below 2^52 per column, so the product
+ * is normalized once at the end.
+ */
+void Multiply(uint64_t *out, const uint64_t *a, const uint64_t *b) {
+    alignas(64) uint64_t a52[LIMBS52];
+    alignas(64) uint64_t b52[B_PADDING + 8 * PRODUCT_BLOCKS + 8] = {0};
+    To52(a52, a);
+    To52(b52 + B_PADDING, b);
+
+    // The low and high halves of the partial products, by column.
+    alignas(64) uint64_t lo[PRODUCT_LIMBS52];
+    alignas(64) uint64_t hi[PRODUCT_LIMBS52];
+    for (int k = 0; k < PRODUCT_BLOCKS; ++k) {
+        // The limbs of a contributing to the columns 8k to 8k+7, with two
+        // accumulators each to hide the latency of the multiply-adds.
+        const int begin = std::max(0, 8 * k - (LIMBS52 - 1)) & ~1;
+        const int end = std::min(LIMBS52, 8 * k + 8);
+        __m512i lo0 = _mm512_setzero_si512();
+        __m512i lo1 = _mm512_setzero_si512();
+        __m512i hi0 = _mm512_setzero_si512();
+        __m512i hi1 = _mm512_setzero_si512();
+        for (int i = begin; i < end; i += 2) {
+            const __m512i a0 = _mm512_set1_epi64(a52[i]);
+            const __m512i a1 = _mm512_set1_epi64(a52[i + 1]);
+            const __m512i b0 =
+                _mm512_loadu_si512(b52 + B_PADDING + 8 * k - i);
+            const __m512i b1 =
+                _mm512_loadu_si512(b52 + B_PADDING + 8 * k - i - 1);
+            lo0 = _mm512_madd52lo_epu64(lo0, a0, b0);
+            hi0 = _mm512_madd52hi_epu64(hi0, a0, b0);
+            lo1 = _mm512_madd52lo_epu64(lo1, a1, b1);
+            hi1 = _mm512_madd52hi_epu64(hi1, a1, b1);
+        }
+        _mm512_store_si512(lo + 8 * k, _mm512_add_epi64(lo0, lo1));
+        _mm512_store_si512(hi + 8 * k, _mm512_add_epi64(hi0, hi1));
+    }
+
+    // The high half of a partial product belongs to the next column.
+    uint64_t product52[PRODUCT_LIMBS52];
+    uint64_t carry = 0;
+    for (int c = 0; c < PRODUCT_LIMBS52; ++c) {
+        const uint64_t v = lo[c] + (c > 0 ? hi[c - 1] : 0) + carry;
+        product52[c] = v & MASK52;
+        carry = v >> 52;
+    }
+
+    To64(out, product52);
+}
+
+} // namespace muhash_avx512ifma
+
+#endif
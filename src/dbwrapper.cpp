@@ -75,7 +75,8 @@ public:
     }
 };
 
-static void SetMaxOpenFiles(leveldb::Options *options) {
+static void SetMaxOpenFiles(leveldb::Options *options,
+                            std::optional<int> max_open_files) {
     // On most platforms the default setting of max_open_files (which is 1000)
     // is optimal. On Windows using a large file count is OK because the handles
     // do not interfere with select() loops. On 64-bit Unix hosts this value is
@@ -91,21 +92,31 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
     // See PR #12495 for further discussion.
 
     int default_open_files = options->max_open_files;
+    if (max_open_files) {
+        options->max_open_files = *max_open_files;
+    }
 #ifndef WIN32
     if (sizeof(void *) < 8) {
-        options->max_open_files = 64;
+        options->max_open_files = std::min(options->max_open_files, 64);
     }
 #endif
     LogPrint(BCLog::LEVELDB, "LevelDB using max_open_files=%d (default=%d)\n",
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize) {
+static leveldb::Options GetOptions(size_t nCacheSize, const DBTuning &tuning) {
     leveldb::Options options;
     options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
     // up to two write buffers may be held in memory simultaneously
-    options.write_buffer_size = nCacheSize / 4;
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    options.write_buffer_size =
+        tuning.write_buffer_size.value_or(nCacheSize / 4);
+    options.block_size = tuning.block_size;
+    // The bloom filters are compatible whatever the number of bits per key, so
+    // it can change between restarts.
+    options.filter_policy =
+        tuning.bloom_bits > 0
+            ? leveldb::NewBloomFilterPolicy(tuning.bloom_bits)
+            : nullptr;
     options.compression = leveldb::kNoCompression;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 ||
@@ -116,7 +127,7 @@ static leveldb::Options GetOptions(size_t nCacheSize) {
     }
     options.max_file_size =
         std::max(options.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
-    SetMaxOpenFiles(&options);
+    SetMaxOpenFiles(&options, tuning.max_open_files);
     return options;
 }
 
@@ -128,7 +139,7 @@ CDBWrapper::CDBWrapper(const DBParams &params)
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(params.cache_bytes);
+    options = GetOptions(params.cache_bytes, params.tuning);
     options.create_if_missing = true;
     if (params.memory_only) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -248,6 +259,21 @@ bool CDBWrapper::IsEmpty() {
     return !(it->Valid());
 }
 
+std::shared_ptr<const leveldb::Snapshot> CDBWrapper::GetSnapshot() const {
+    return std::shared_ptr<const leveldb::Snapshot>(
+        pdb->GetSnapshot(),
+        [db = pdb](const leveldb::Snapshot *snapshot) {
+            db->ReleaseSnapshot(snapshot);
+        });
+}
+
+CDBIterator *CDBWrapper::NewIterator(
+    const std::shared_ptr<const leveldb::Snapshot> &snapshot) {
+    leveldb::ReadOptions snapshot_options{iteroptions};
+    snapshot_options.snapshot = snapshot.get();
+    return new CDBIterator(*this, pdb->NewIterator(snapshot_options), snapshot);
+}
+
 CDBIterator::~CDBIterator() {
     delete piter;
 }
@@ -16,6 +16,7 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <memory>
 #include <optional>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
@@ -28,6 +29,31 @@ struct DBOptions {
     bool force_compact = false;
 };
 
+//! LevelDB settings matching the access pattern of a database.
+struct DBTuning {
+    //! Approximate amount of data packed per block. Larger blocks suit range
+    //! scans, smaller ones suit random point lookups.
+    size_t block_size = 4 << 10;
+    //! Amount of data to build up in memory before writing a sorted file to
+    //! disk. Defaults to a quarter of the cache size.
+    std::optional<size_t> write_buffer_size{};
+    //! Bits per key of the bloom filter, or 0 for no filter.
+    int bloom_bits = 10;
+    //! Maximum number of open files. Defaults to the LevelDB default.
+    std::optional<int> max_open_files{};
+
+    //! The chainstate gets random point lookups of small values.
+    static DBTuning ForChainstate() { return {}; }
+    //! The block index is read in full at startup and then barely read.
+    static DBTuning ForBlockIndex() { return {.block_size = 16 << 10}; }
+    //! The indexes keyed by block (filters, coin stats) are read in ranges of
+    //! heights.
+    static DBTuning ForBlockIndexes() { return {.block_size = 16 << 10}; }
+    //! The transaction index gets random point lookups, many of which are
+    //! for transactions that are not in the index.
+    static DBTuning ForTxIndex() { return {.bloom_bits = 14}; }
+};
+
 //! Application-specific storage settings.
 struct DBParams {
     //! Location in the filesystem where leveldb data will be stored.
@@ -43,6 +69,8 @@ struct DBParams {
     bool obfuscate = false;
     //! Passed-through options.
     DBOptions options{};
+    //! LevelDB settings for this database.
+    DBTuning tuning{};
 };
 
 class dbwrapper_error : public std::runtime_error {
@@ -144,14 +172,18 @@ class CDBIterator {
 private:
     const CDBWrapper &parent;
     leveldb::Iterator *piter;
+    //! Kept alive as long as the iterator reads from it.
+    std::shared_ptr<const leveldb::Snapshot> m_snapshot;
 
 public:
     /**
      * @param[in] _parent          Parent CDBWrapper instance.
      * @param[in] _piter           The original leveldb iterator.
+     * @param[in] snapshot         The snapshot _piter reads from, if any.
      */
-    CDBIterator(const CDBWrapper &_parent, leveldb::Iterator *_piter)
-        : parent(_parent), piter(_piter){};
+    CDBIterator(const CDBWrapper &_parent, leveldb::Iterator *_piter,
+                std::shared_ptr<const leveldb::Snapshot> snapshot = nullptr)
+        : parent(_parent), piter(_piter), m_snapshot(std::move(snapshot)){};
     ~CDBIterator();
 
     bool Valid() const;
@@ -317,6 +349,15 @@ public:
         return new CDBIterator(*this, pdb->NewIterator(iteroptions));
     }
 
+    /**
+     * Get a consistent view of the current state of the database, so several
+     * iterators see the same data regardless of the writes in the meantime.
+     */
+    std::shared_ptr<const leveldb::Snapshot> GetSnapshot() const;
+
+    CDBIterator *
+    NewIterator(const std::shared_ptr<const leveldb::Snapshot> &snapshot);
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
@@ -4,6 +4,7 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <checkqueue.h>
 #include <common/args.h>
 #include <config.h>
 #include <index/base.h>
@@ -22,6 +23,7 @@
 #include <warnings.h>
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -30,6 +32,15 @@ constexpr uint8_t DB_BEST_BLOCK{'B'};
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
 
+/**
+ * Maximum size of a window of blocks read ahead by the initial sync. There are
+ * at most 2 windows in memory at once.
+ */
+constexpr size_t MAX_SYNC_WINDOW_BLOCKS{64};
+constexpr size_t MAX_SYNC_WINDOW_SIZE{16 << 20};
+/** Size of the database batches written by the initial sync. */
+constexpr size_t SYNC_BATCH_SIZE{16 << 20};
+
 template <typename... Args>
 void BaseIndex::FatalErrorf(const char *fmt, const Args &...args) {
     auto message = tfm::format(fmt, args...);
@@ -47,7 +58,7 @@ CBlockLocator GetLocator(interfaces::Chain &chain,
 }
 
 BaseIndex::DB::DB(const fs::path &path, size_t n_cache_size, bool f_memory,
-                  bool f_wipe, bool f_obfuscate)
+                  bool f_wipe, bool f_obfuscate, DBTuning tuning)
     : CDBWrapper{DBParams{.path = path,
                           .cache_bytes = n_cache_size,
                           .memory_only = f_memory,
@@ -57,7 +68,8 @@ BaseIndex::DB::DB(const fs::path &path, size_t n_cache_size, bool f_memory,
                               DBOptions options;
                               node::ReadDatabaseArgs(gArgs, options);
                               return options;
-                          }()}} {}
+                          }(),
+                          .tuning = tuning}} {}
 
 bool BaseIndex::DB::ReadBestBlock(CBlockLocator &locator) const {
     bool success = Read(DB_BEST_BLOCK, locator);
@@ -152,71 +164,176 @@ static const CBlockIndex *NextSyncBlock(const CBlockIndex *pindex_prev,
     return chain.Next(chain.FindFork(pindex_prev));
 }
 
+class BaseIndex::SyncTask {
+    const BaseIndex *m_index;
+    SyncBlock *m_sync_block;
+    node::SharedBlockReader::Cursor *m_cursor;
+    int m_pos;
+
+public:
+    SyncTask(const BaseIndex &index, SyncBlock &sync_block,
+             node::SharedBlockReader::Cursor &cursor, int pos)
+        : m_index(&index), m_sync_block(&sync_block), m_cursor(&cursor),
+          m_pos(pos) {}
+
+    std::optional<int> operator()() {
+        if (m_index->ReadSyncBlock(*m_sync_block, *m_cursor)) {
+            return std::nullopt;
+        }
+        return m_pos;
+    }
+};
+
+std::vector<BaseIndex::SyncBlock>
+BaseIndex::GetNextSyncBlocks(const CBlockIndex *pindex_prev) const {
+    AssertLockHeld(cs_main);
+
+    CChain &chain = m_chainstate->m_chain;
+    std::vector<SyncBlock> blocks;
+    size_t window_size{0};
+    for (const CBlockIndex *pindex = NextSyncBlock(pindex_prev, chain);
+         pindex && blocks.size() < MAX_SYNC_WINDOW_BLOCKS &&
+         window_size < MAX_SYNC_WINDOW_SIZE;
+         pindex = chain.Next(pindex)) {
+        blocks.emplace_back().pindex = pindex;
+        window_size += pindex->nSize;
+    }
+    return blocks;
+}
+
+bool BaseIndex::ReadSyncBlock(SyncBlock &sync_block,
+                              node::SharedBlockReader::Cursor &cursor) const {
+    const CBlockIndex &index = *sync_block.pindex;
+    sync_block.block = cursor.ReadBlock(index);
+    if (!sync_block.block) {
+        return false;
+    }
+    if (NeedsUndoData()) {
+        sync_block.undo = cursor.ReadBlockUndo(index);
+        if (!sync_block.undo) {
+            return false;
+        }
+    }
+    return PrepareSyncBlock(sync_block);
+}
+
 void BaseIndex::ThreadSync() {
     const CBlockIndex *pindex = m_best_block_index.load();
     if (!m_synced) {
         auto last_log_time{NodeClock::now()};
         auto last_locator_write_time{last_log_time};
+
+        // The blocks are read through the shared reader, so the indexes that
+        // sync at the same time don't read them several times.
+        node::SharedBlockReader::Cursor cursor{
+            m_chainstate->m_blockman.m_shared_block_reader};
+
+        // The blocks being written, and the ones being read in the background
+        // in the meantime. They are declared before the queue so they outlive
+        // the worker threads.
+        std::vector<SyncBlock> blocks;
+        std::vector<SyncBlock> next_blocks{
+            WITH_LOCK(cs_main, return GetNextSyncBlocks(pindex))};
+        CCheckQueue<SyncTask> queue(
+            /*batch_size=*/1,
+            m_chainstate->m_chainman.m_options.worker_threads_num, "idxsync");
+
+        // The index entries are written ahead of the locator, so they don't
+        // need to be part of the Commit batch.
+        CDBBatch batch(GetDB());
+        auto flush_batch = [&] {
+            GetDB().WriteBatch(batch);
+            batch.Clear();
+        };
+
         while (true) {
-            if (m_interrupt) {
-                LogPrintf("%s: m_interrupt set; exiting ThreadSync\n",
-                          GetName());
-
-                SetBestBlockIndex(pindex);
-                // No need to handle errors in Commit. If it fails, the error
-                // will be already be logged. The best way to recover is to
-                // continue, as index cannot be corrupted by a missed commit to
-                // disk for an advanced index state.
-                Commit();
-                return;
+            if (!next_blocks.empty()) {
+                cursor.SetHeight(next_blocks.front().pindex->nHeight);
             }
+            std::vector<SyncTask> tasks;
+            tasks.reserve(next_blocks.size());
+            for (size_t i = 0; i < next_blocks.size(); i++) {
+                tasks.emplace_back(*this, next_blocks[i], cursor, i);
+            }
+            queue.Add(std::move(tasks));
 
-            {
-                LOCK(cs_main);
-                const CBlockIndex *pindex_next =
-                    NextSyncBlock(pindex, m_chainstate->m_chain);
-                if (!pindex_next) {
+            for (SyncBlock &sync_block : blocks) {
+                if (m_interrupt) {
+                    LogPrintf("%s: m_interrupt set; exiting ThreadSync\n",
+                              GetName());
+
+                    flush_batch();
                     SetBestBlockIndex(pindex);
-                    m_synced = true;
-                    // No need to handle errors in Commit. See rationale above.
+                    // No need to handle errors in Commit. If it fails, the
+                    // error will be already be logged. The best way to recover
+                    // is to continue, as index cannot be corrupted by a missed
+                    // commit to disk for an advanced index state.
                     Commit();
-                    break;
+                    return;
+                }
+
+                if (sync_block.pindex->pprev != pindex) {
+                    // The rewind may read back the entries that are still in
+                    // the batch.
+                    flush_batch();
+                    LOCK(cs_main);
+                    if (!Rewind(pindex, sync_block.pindex->pprev)) {
+                        FatalErrorf("%s: Failed to rewind index %s to a "
+                                    "previous chain tip",
+                                    __func__, GetName());
+                        return;
+                    }
                 }
-                if (pindex_next->pprev != pindex &&
-                    !Rewind(pindex, pindex_next->pprev)) {
+                pindex = sync_block.pindex;
+
+                if (!WriteSyncBlock(sync_block, batch)) {
                     FatalErrorf(
-                        "%s: Failed to rewind index %s to a previous chain tip",
-                        __func__, GetName());
+                        "%s: Failed to write block %s to index database",
+                        __func__, pindex->GetBlockHash().ToString());
                     return;
                 }
-                pindex = pindex_next;
-            }
+                if (batch.SizeEstimate() >= SYNC_BATCH_SIZE) {
+                    flush_batch();
+                }
 
-            CBlock block;
-            if (!m_chainstate->m_blockman.ReadBlock(block, *pindex)) {
-                FatalErrorf("%s: Failed to read block %s from disk", __func__,
-                            pindex->GetBlockHash().ToString());
-                return;
-            }
-            if (!WriteBlock(block, pindex)) {
-                FatalErrorf("%s: Failed to write block %s to index database",
-                            __func__, pindex->GetBlockHash().ToString());
-                return;
+                auto current_time{NodeClock::now()};
+                if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
+                    LogInfo("Syncing %s with block chain from height %d\n",
+                            GetName(), pindex->nHeight);
+                    last_log_time = current_time;
+                }
+
+                if (current_time - last_locator_write_time >=
+                    SYNC_LOCATOR_WRITE_INTERVAL) {
+                    flush_batch();
+                    SetBestBlockIndex(pindex);
+                    last_locator_write_time = current_time;
+                    // No need to handle errors in Commit. See rationale above.
+                    Commit();
+                }
             }
 
-            auto current_time{NodeClock::now()};
-            if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
-                LogInfo("Syncing %s with block chain from height %d\n",
-                        GetName(), pindex->nHeight);
-                last_log_time = current_time;
+            if (auto failed_pos = queue.Complete()) {
+                FatalErrorf(
+                    "%s: Failed to read block %s from disk or prepare it",
+                    __func__,
+                    next_blocks[*failed_pos].pindex->GetBlockHash().ToString());
+                return;
             }
 
-            if (current_time - last_locator_write_time >=
-                SYNC_LOCATOR_WRITE_INTERVAL) {
-                SetBestBlockIndex(pindex);
-                last_locator_write_time = current_time;
-                // No need to handle errors in Commit. See rationale above.
-                Commit();
+            blocks = std::move(next_blocks);
+            {
+                LOCK(cs_main);
+                next_blocks = GetNextSyncBlocks(blocks.empty() ? pindex
+                                                  : blocks.back().pindex);
+                if (blocks.empty() && next_blocks.empty()) {
+                    flush_batch();
+                    SetBestBlockIndex(pindex);
+                    m_synced = true;
+                    // No need to handle errors in Commit. See rationale above.
+                    Commit();
+                    break;
+                }
             }
         }
     }
@@ -7,12 +7,16 @@
 
 #include <dbwrapper.h>
 #include <interfaces/chain.h>
+#include <node/sharedblockreader.h>
+#include <primitives/block.h>
+#include <undo.h>
 #include <util/threadinterrupt.h>
 #include <validationinterface.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
-class CBlock;
 class CBlockIndex;
 class Chainstate;
 class ChainstateManager;
@@ -46,7 +50,8 @@ protected:
     class DB : public CDBWrapper {
     public:
         DB(const fs::path &path, size_t n_cache_size, bool f_memory = false,
-           bool f_wipe = false, bool f_obfuscate = false);
+           bool f_wipe = false, bool f_obfuscate = false,
+           DBTuning tuning = DBTuning::ForBlockIndexes());
 
         /// Read block locator of the chain that the index is in sync with.
         bool ReadBestBlock(CBlockLocator &locator) const;
@@ -55,6 +60,22 @@ protected:
         void WriteBestBlock(CDBBatch &batch, const CBlockLocator &locator);
     };
 
+    /// Index specific data computed by PrepareSyncBlock.
+    struct SyncBlockData {
+        virtual ~SyncBlockData() = default;
+    };
+
+    /// A block read from disk ahead of time by the initial sync. The data is
+    /// shared with the other indexes syncing at the same time.
+    struct SyncBlock {
+        const CBlockIndex *pindex{nullptr};
+        std::shared_ptr<const CBlock> block;
+        /// Only read if NeedsUndoData() returns true. It is empty for the
+        /// genesis block.
+        std::shared_ptr<const CBlockUndo> undo;
+        std::unique_ptr<SyncBlockData> data;
+    };
+
 private:
     /// Whether the index has been initialized or not.
     std::atomic<bool> m_init{false};
@@ -78,8 +99,23 @@ private:
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
     /// flag is set and the BlockConnected ValidationInterface callback takes
     /// over and the sync thread exits.
+    ///
+    /// The blocks are processed in windows. While a window is written in
+    /// order, the next one is read and prepared by worker threads.
     void ThreadSync();
 
+    class SyncTask;
+
+    /// Get the next window of blocks to sync after pindex_prev.
+    std::vector<SyncBlock>
+    GetNextSyncBlocks(const CBlockIndex *pindex_prev) const
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /// Read a block to sync through the cursor, and prepare it. This runs on
+    /// the sync worker threads.
+    bool ReadSyncBlock(SyncBlock &sync_block,
+                       node::SharedBlockReader::Cursor &cursor) const;
+
     /// Write the current index state (eg. chain block locator and
     /// subclass-specific items) to disk.
     ///
@@ -120,6 +156,26 @@ protected:
         return true;
     }
 
+    /// Whether the initial sync should read the undo data along with the
+    /// blocks.
+    virtual bool NeedsUndoData() const { return false; }
+
+    /// Do the part of the indexing work that doesn't depend on the previous
+    /// blocks. During the initial sync, this runs for several blocks in
+    /// parallel, ahead of WriteSyncBlock.
+    [[nodiscard]] virtual bool PrepareSyncBlock(SyncBlock &sync_block) const {
+        return true;
+    }
+
+    /// Write the index entries for a block during the initial sync. The blocks
+    /// are written in chain order. The database writes can be added to the
+    /// batch, which is written out in large chunks and always before the best
+    /// block locator.
+    [[nodiscard]] virtual bool WriteSyncBlock(SyncBlock &sync_block,
+                                              CDBBatch &batch) {
+        return WriteBlock(*sync_block.block, sync_block.pindex);
+    }
+
     /// Virtual method called internally by Commit that can be overridden to
     /// atomically commit more index state.
     virtual bool CustomCommit(CDBBatch &batch) { return true; }
@@ -235,52 +235,113 @@ size_t BlockFilterIndex::WriteFilterToDisk(FlatFilePos &pos,
     return data_size;
 }
 
-bool BlockFilterIndex::WriteBlock(const CBlock &block,
-                                  const CBlockIndex *pindex) {
-    CBlockUndo block_undo;
-    uint256 prev_header;
-
-    if (pindex->nHeight > 0) {
-        if (!m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
-            return false;
-        }
-
-        std::pair<BlockHash, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
-            return false;
-        }
+bool BlockFilterIndex::ReadPrevFilterHeader(const CBlockIndex *pindex,
+                                            uint256 &prev_header) const {
+    if (pindex->nHeight == 0) {
+        prev_header.SetNull();
+        return true;
+    }
 
-        BlockHash expected_block_hash = pindex->pprev->GetBlockHash();
-        if (read_out.first != expected_block_hash) {
-            LogError("%s: previous block header belongs to unexpected "
-                     "block %s; expected %s\n",
-                     __func__, read_out.first.ToString(),
-                     expected_block_hash.ToString());
-            return false;
-        }
+    std::pair<BlockHash, DBVal> read_out;
+    if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
+        return false;
+    }
 
-        prev_header = read_out.second.header;
+    BlockHash expected_block_hash = pindex->pprev->GetBlockHash();
+    if (read_out.first != expected_block_hash) {
+        LogError("%s: previous block header belongs to unexpected "
+                 "block %s; expected %s\n",
+                 __func__, read_out.first.ToString(),
+                 expected_block_hash.ToString());
+        return false;
     }
 
-    BlockFilter filter(m_filter_type, block, block_undo);
+    prev_header = read_out.second.header;
+    return true;
+}
 
+bool BlockFilterIndex::AppendFilter(const BlockFilter &filter,
+                                    const CBlockIndex *pindex,
+                                    const uint256 &prev_header,
+                                    CDBBatch &batch, uint256 &header) {
     size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter);
     if (bytes_written == 0) {
         return false;
     }
 
+    header = filter.ComputeHeader(prev_header);
+
     std::pair<BlockHash, DBVal> value;
     value.first = pindex->GetBlockHash();
     value.second.hash = filter.GetHash();
-    value.second.header = filter.ComputeHeader(prev_header);
+    value.second.header = header;
     value.second.pos = m_next_filter_pos;
 
-    m_db->Write(DBHeightKey(pindex->nHeight), value);
+    batch.Write(DBHeightKey(pindex->nHeight), value);
 
     m_next_filter_pos.nPos += bytes_written;
     return true;
 }
 
+bool BlockFilterIndex::WriteBlock(const CBlock &block,
+                                  const CBlockIndex *pindex) {
+    CBlockUndo block_undo;
+    uint256 prev_header;
+
+    if (pindex->nHeight > 0 &&
+        !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
+        return false;
+    }
+    if (!ReadPrevFilterHeader(pindex, prev_header)) {
+        return false;
+    }
+
+    CDBBatch batch(*m_db);
+    uint256 header;
+    if (!AppendFilter(BlockFilter(m_filter_type, block, block_undo), pindex,
+                      prev_header, batch, header)) {
+        return false;
+    }
+    m_db->WriteBatch(batch);
+    return true;
+}
+
+struct BlockFilterIndex::SyncData : public BaseIndex::SyncBlockData {
+    BlockFilter filter;
+};
+
+bool BlockFilterIndex::PrepareSyncBlock(SyncBlock &sync_block) const {
+    // Building the filter is the expensive part, and only depends on the block
+    // and its undo data.
+    auto data = std::make_unique<SyncData>();
+    data->filter =
+        BlockFilter(m_filter_type, *sync_block.block, *sync_block.undo);
+    sync_block.data = std::move(data);
+    return true;
+}
+
+bool BlockFilterIndex::WriteSyncBlock(SyncBlock &sync_block,
+                                      CDBBatch &batch) {
+    const CBlockIndex *pindex = sync_block.pindex;
+
+    uint256 prev_header;
+    if (pindex->pprev &&
+        m_last_sync_header.first == pindex->pprev->GetBlockHash()) {
+        prev_header = m_last_sync_header.second;
+    } else if (!ReadPrevFilterHeader(pindex, prev_header)) {
+        return false;
+    }
+
+    uint256 header;
+    if (!AppendFilter(static_cast<const SyncData &>(*sync_block.data).filter,
+                      pindex, prev_header, batch, header)) {
+        return false;
+    }
+
+    m_last_sync_header = {pindex->GetBlockHash(), header};
+    return true;
+}
+
 static bool CopyHeightIndexToHashIndex(CDBIterator &db_it, CDBBatch &batch,
                                        const std::string &index_name,
                                        int start_height, int stop_height) {
@@ -35,6 +35,22 @@ private:
     bool ReadFilterFromDisk(const FlatFilePos &pos, BlockFilter &filter) const;
     size_t WriteFilterToDisk(FlatFilePos &pos, const BlockFilter &filter);
 
+    /// Filters built ahead of time by the initial sync.
+    struct SyncData;
+
+    /**
+     * Block hash and filter header of the last block written by the initial
+     * sync. The next block uses it instead of reading it back from the
+     * database, where it might not have been written yet.
+     */
+    std::pair<BlockHash, uint256> m_last_sync_header;
+
+    bool ReadPrevFilterHeader(const CBlockIndex *pindex,
+                              uint256 &prev_header) const;
+    bool AppendFilter(const BlockFilter &filter, const CBlockIndex *pindex,
+                      const uint256 &prev_header, CDBBatch &batch,
+                      uint256 &header);
+
     Mutex m_cs_headers_cache;
     /**
      * Cache of block hash to filter header, to avoid disk access when
@@ -52,6 +68,12 @@ protected:
 
     bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
 
+    bool NeedsUndoData() const override { return true; }
+
+    bool PrepareSyncBlock(SyncBlock &sync_block) const override;
+
+    bool WriteSyncBlock(SyncBlock &sync_block, CDBBatch &batch) override;
+
     bool Rewind(const CBlockIndex *current_tip,
                 const CBlockIndex *new_tip) override;
 
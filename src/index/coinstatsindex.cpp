@@ -114,16 +114,29 @@ CoinStatsIndex::CoinStatsIndex(std::unique_ptr<interfaces::Chain> chain,
 bool CoinStatsIndex::WriteBlock(const CBlock &block,
                                 const CBlockIndex *pindex) {
     CBlockUndo block_undo;
+    if (pindex->nHeight > 0 &&
+        !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
+        return false;
+    }
+    return AppendBlock(block, block_undo, pindex);
+}
+
+bool CoinStatsIndex::WriteSyncBlock(SyncBlock &sync_block, CDBBatch &batch) {
+    // The MuHash accumulation depends on all the previous blocks, so only the
+    // block and undo data reads happen ahead of time. The entries are not
+    // batched either, as the next block reads them back.
+    return AppendBlock(*sync_block.block, *sync_block.undo, sync_block.pindex);
+}
+
+bool CoinStatsIndex::AppendBlock(const CBlock &block,
+                                 const CBlockUndo &block_undo,
+                                 const CBlockIndex *pindex) {
     const Amount block_subsidy{
         GetBlockSubsidy(pindex->nHeight, Params().GetConsensus())};
     m_total_subsidy += block_subsidy;
 
     // Ignore genesis block
     if (pindex->nHeight > 0) {
-        if (!m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
-            return false;
-        }
-
         std::pair<BlockHash, DBVal> read_out;
         if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
             return false;
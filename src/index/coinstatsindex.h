@@ -38,6 +38,9 @@ private:
 
     bool ReverseBlock(const CBlock &block, const CBlockIndex *pindex);
 
+    bool AppendBlock(const CBlock &block, const CBlockUndo &block_undo,
+                     const CBlockIndex *pindex);
+
     bool AllowPrune() const override { return true; }
 
 protected:
@@ -47,6 +50,10 @@ protected:
 
     bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
 
+    bool NeedsUndoData() const override { return true; }
+
+    bool WriteSyncBlock(SyncBlock &sync_block, CDBBatch &batch) override;
+
     bool Rewind(const CBlockIndex *current_tip,
                 const CBlockIndex *new_tip) override;
 
@@ -28,11 +28,16 @@ public:
 
     /// Write a batch of transaction positions to the DB.
     void WriteTxs(const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos);
+
+    /// Add transaction positions to a batch.
+    void WriteTxs(CDBBatch &batch,
+                  const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos);
 };
 
 TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe)
     : BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size,
-                    f_memory, f_wipe) {}
+                    f_memory, f_wipe, /*f_obfuscate=*/false,
+                    DBTuning::ForTxIndex()) {}
 
 bool TxIndex::DB::ReadTxPos(const TxId &txid, CDiskTxPos &pos) const {
     return Read(std::make_pair(DB_TXINDEX, txid), pos);
@@ -41,10 +46,32 @@ bool TxIndex::DB::ReadTxPos(const TxId &txid, CDiskTxPos &pos) const {
 void TxIndex::DB::WriteTxs(
     const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos) {
     CDBBatch batch(*this);
+    WriteTxs(batch, v_pos);
+    WriteBatch(batch);
+}
+
+void TxIndex::DB::WriteTxs(
+    CDBBatch &batch, const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos) {
     for (const auto &tuple : v_pos) {
         batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
     }
-    WriteBatch(batch);
+}
+
+struct TxIndex::SyncData : public BaseIndex::SyncBlockData {
+    std::vector<std::pair<TxId, CDiskTxPos>> vPos;
+};
+
+static std::vector<std::pair<TxId, CDiskTxPos>>
+GetTxPositions(const CBlock &block, const CBlockIndex *pindex) {
+    CDiskTxPos pos(WITH_LOCK(::cs_main, return pindex->GetBlockPos()),
+                   GetSizeOfCompactSize(block.vtx.size()));
+    std::vector<std::pair<TxId, CDiskTxPos>> vPos;
+    vPos.reserve(block.vtx.size());
+    for (const auto &tx : block.vtx) {
+        vPos.emplace_back(tx->GetId(), pos);
+        pos.nTxOffset += ::GetSerializeSize(*tx);
+    }
+    return vPos;
 }
 
 TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size,
@@ -60,15 +87,27 @@ bool TxIndex::WriteBlock(const CBlock &block, const CBlockIndex *pindex) {
         return true;
     }
 
-    CDiskTxPos pos(WITH_LOCK(::cs_main, return pindex->GetBlockPos()),
-                   GetSizeOfCompactSize(block.vtx.size()));
-    std::vector<std::pair<TxId, CDiskTxPos>> vPos;
-    vPos.reserve(block.vtx.size());
-    for (const auto &tx : block.vtx) {
-        vPos.emplace_back(tx->GetId(), pos);
-        pos.nTxOffset += ::GetSerializeSize(*tx);
+    m_db->WriteTxs(GetTxPositions(block, pindex));
+    return true;
+}
+
+bool TxIndex::PrepareSyncBlock(SyncBlock &sync_block) const {
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (sync_block.pindex->nHeight == 0) {
+        return true;
+    }
+
+    auto data = std::make_unique<SyncData>();
+    data->vPos = GetTxPositions(*sync_block.block, sync_block.pindex);
+    sync_block.data = std::move(data);
+    return true;
+}
+
+bool TxIndex::WriteSyncBlock(SyncBlock &sync_block, CDBBatch &batch) {
+    if (sync_block.data) {
+        m_db->WriteTxs(batch,
+                       static_cast<const SyncData &>(*sync_block.data).vPos);
     }
-    m_db->WriteTxs(vPos);
     return true;
 }
 
@@ -26,11 +26,18 @@ protected:
 private:
     const std::unique_ptr<DB> m_db;
 
+    /// Transaction positions computed ahead of time by the initial sync.
+    struct SyncData;
+
     bool AllowPrune() const override { return false; }
 
 protected:
     bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
 
+    bool PrepareSyncBlock(SyncBlock &sync_block) const override;
+
+    bool WriteSyncBlock(SyncBlock &sync_block, CDBBatch &batch) override;
+
     BaseIndex::DB &GetDB() const override;
 
 public:
@@ -351,6 +351,7 @@ void Shutdown(NodeContext &node) {
                 chainstate->ResetCoinsViews();
             }
         }
+        node.chainman->m_blockman.WriteFlatBlockIndex();
 
         node.chainman->DumpRecentHeadersTime(node.chainman->m_options.datadir /
                                              HEADERS_TIME_FILE_NAME);
@@ -505,6 +506,18 @@ void SetupServerArgs(NodeContext &node) {
                    "Specify directory to hold blocks subdirectory for *.dat "
                    "files (default: <datadir>)",
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-asyncblockwrites",
+                   "Write the block and undo files from a dedicated thread "
+                   "(default: 1)",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blockfilemmap",
+                   "Read the block and undo files through memory mappings, "
+                   "if supported by the system (default: 1)",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-flatblockindex",
+                   "Write a flat copy of the block index at shutdown to load "
+                   "it faster at the next startup (default: 1)",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-fastprune",
                    "Use smaller block files and lower minimum prune height for "
                    "testing purposes",
@@ -1529,6 +1542,12 @@ void SetupServerArgs(NodeContext &node) {
         strprintf("Avalanche query timeout in milliseconds (default: %u)",
                   AVALANCHE_DEFAULT_QUERY_TIMEOUT.count()),
         ArgsManager::ALLOW_ANY, OptionsCategory::AVALANCHE);
+    argsman.AddArg(
+        "-avapollfanout",
+        strprintf("Maximum number of nodes to poll at each avalanche event "
+                  "loop iteration (default: %u)",
+                  AVALANCHE_DEFAULT_POLL_FANOUT),
+        ArgsManager::ALLOW_ANY, OptionsCategory::AVALANCHE);
     argsman.AddArg(
         "-avamaxelementpoll",
         strprintf("Maximum number of elements to include and accept in an "
@@ -1586,6 +1605,14 @@ void SetupServerArgs(NodeContext &node) {
                   "them upon startup (default: %u).",
                   DEFAULT_PERSIST_AVAPEERS),
         ArgsManager::ALLOW_ANY, OptionsCategory::AVALANCHE);
+    argsman.AddArg(
+        "-avapeersdumpmaxage=<seconds>",
+        strprintf("Maximum age of the saved avalanche peers for them to be "
+                  "trusted in place of the avaproofs messages when "
+                  "establishing the quorum after a restart, 0 to disable "
+                  "(default: %d).",
+                  AVALANCHE_DEFAULT_PEERS_DUMP_MAX_AGE.count()),
+        ArgsManager::ALLOW_ANY, OptionsCategory::AVALANCHE);
 
     // Add the hidden options
     argsman.AddHiddenArgs(hidden_args);
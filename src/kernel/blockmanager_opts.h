@@ -24,6 +24,12 @@ struct BlockManagerOpts {
     bool fast_prune{false};
     const fs::path blocks_dir;
     Notifications &notifications;
+    /** Read the block and undo files through memory mappings if supported. */
+    bool use_mmap{true};
+    /** Keep a flat copy of the block index to speed up the startup. */
+    bool flat_block_index{true};
+    /** Write the block and undo files from a dedicated thread. */
+    bool async_block_writes{true};
 };
 
 } // namespace kernel
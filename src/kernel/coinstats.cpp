@@ -4,16 +4,21 @@
 
 #include <kernel/coinstats.h>
 
+#include <checkqueue.h>
 #include <coins.h>
 #include <crypto/muhash.h>
 #include <hash.h>
 #include <logging.h>
 #include <primitives/txid.h>
 #include <serialize.h>
+#include <txdb.h>
 #include <util/check.h>
 #include <validation.h>
 
+#include <exception>
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace kernel {
 CCoinsStats::CCoinsStats(int block_height, const BlockHash &block_hash)
@@ -90,22 +95,24 @@ static void ApplyStats(CCoinsStats &stats, const TxId &txid,
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
-template <typename T>
-static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
-                             const std::function<void()> &interruption_point) {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
-    PrepareHash(hash_obj, stats);
+//! Number of ranges of the UTXO set per thread computing the statistics, so
+//! the threads done early can help the others.
+static constexpr size_t UTXO_STATS_RANGES_PER_THREAD{4};
 
+//! Apply the coins from a cursor to the statistics and hash
+template <typename T>
+static bool ApplyCoins(CCoinsViewCursor &cursor, CCoinsStats &stats,
+                       T &hash_obj,
+                       const std::function<void()> &interruption_point) {
     TxId prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
-        interruption_point();
+    while (cursor.Valid()) {
+        if (interruption_point) {
+            interruption_point();
+        }
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
             if (!outputs.empty() && key.GetTxId() != prevkey) {
                 ApplyStats(stats, prevkey, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -118,41 +125,163 @@ static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
             LogError("%s: unable to read value\n", __func__);
             return false;
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+//! Add the statistics of a range of the UTXO set to the total
+static void MergeStats(CCoinsStats &stats, const CCoinsStats &range_stats) {
+    stats.nTransactions += range_stats.nTransactions;
+    stats.nTransactionOutputs += range_stats.nTransactionOutputs;
+    stats.nBogoSize += range_stats.nBogoSize;
+    stats.coins_count += range_stats.coins_count;
+    if (stats.total_amount.has_value() &&
+        range_stats.total_amount.has_value()) {
+        stats.total_amount =
+            (*stats.total_amount).CheckedAdd(*range_stats.total_amount);
+    } else {
+        stats.total_amount.reset();
+    }
+}
+
+// Only the hashes that don't depend on the order of the coins can be computed
+// by range and merged.
+static void MergeHash(MuHash3072 &muhash, const MuHash3072 &range_muhash) {
+    muhash *= range_muhash;
+}
+static void MergeHash(std::nullptr_t, std::nullptr_t) {}
 
+/** Compute the statistics of a range of the UTXO set on a worker thread. */
+class UTXOStatsRangeTask {
+    std::function<bool()> m_task;
+
+public:
+    explicit UTXOStatsRangeTask(std::function<bool()> task)
+        : m_task(std::move(task)) {}
+
+    /**
+     * Return the exception thrown by the task, such as an interruption, or a
+     * null exception_ptr if the range could not be read.
+     */
+    std::optional<std::exception_ptr> operator()() {
+        try {
+            if (!m_task()) {
+                return std::exception_ptr{};
+            }
+        } catch (...) {
+            return std::current_exception();
+        }
+        return std::nullopt;
+    }
+};
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsViewCursor &cursor, CCoinsStats &stats,
+                             T &hash_obj,
+                             const std::function<void()> &interruption_point) {
+    PrepareHash(hash_obj, stats);
+    if (!ApplyCoins(cursor, stats, hash_obj, interruption_point)) {
+        return false;
+    }
     FinalizeHash(hash_obj, stats);
+    return true;
+}
 
-    stats.nDiskSize = view->EstimateSize();
+//! Calculate statistics about the unspent transaction output set, one range
+//! per cursor, in parallel
+template <typename T>
+static bool
+ComputeUTXOStats(const std::vector<std::unique_ptr<CCoinsViewCursor>> &cursors,
+                 CCoinsStats &stats, T &hash_obj,
+                 const std::function<void()> &interruption_point,
+                 int worker_threads_num) {
+    PrepareHash(hash_obj, stats);
+
+    std::vector<CCoinsStats> ranges_stats(cursors.size());
+    std::vector<T> ranges_hash_obj(cursors.size());
+    {
+        CCheckQueue<UTXOStatsRangeTask> queue(/*batch_size=*/1,
+                                              worker_threads_num, "coinstats");
+        std::vector<UTXOStatsRangeTask> tasks;
+        tasks.reserve(cursors.size());
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            tasks.emplace_back([&, i] {
+                return ApplyCoins(*cursors[i], ranges_stats[i],
+                                  ranges_hash_obj[i], interruption_point);
+            });
+        }
+        queue.Add(std::move(tasks));
+        if (const auto error = queue.Complete()) {
+            if (*error) {
+                std::rethrow_exception(*error);
+            }
+            return false;
+        }
+    }
 
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        MergeStats(stats, ranges_stats[i]);
+        MergeHash(hash_obj, ranges_hash_obj[i]);
+    }
+
+    FinalizeHash(hash_obj, stats);
     return true;
 }
 
 std::optional<CCoinsStats>
 ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
                  node::BlockManager &blockman,
-                 const std::function<void()> &interruption_point) {
+                 const std::function<void()> &interruption_point,
+                 int worker_threads_num) {
+    // The UTXO set is split in ranges that are processed in parallel, unless
+    // the hash depends on the order of the coins.
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    auto *coins_db = dynamic_cast<CCoinsViewDB *>(view);
+    if (worker_threads_num > 0 && coins_db &&
+        hash_type != CoinStatsHashType::HASH_SERIALIZED) {
+        cursors = coins_db->RangeCursors(UTXO_STATS_RANGES_PER_THREAD *
+                                         (worker_threads_num + 1));
+    } else {
+        cursors.emplace_back(view->Cursor());
+    }
+    assert(cursors.front());
+
     CBlockIndex *pindex = WITH_LOCK(
-        ::cs_main, return blockman.LookupBlockIndex(view->GetBestBlock()));
+        ::cs_main,
+        return blockman.LookupBlockIndex(cursors.front()->GetBestBlock()));
     CCoinsStats stats{Assert(pindex)->nHeight, pindex->GetBlockHash()};
 
     bool success = [&]() -> bool {
         switch (hash_type) {
             case (CoinStatsHashType::HASH_SERIALIZED): {
                 HashWriter ss{};
-                return ComputeUTXOStats(view, stats, ss, interruption_point);
+                return ComputeUTXOStats(*cursors.front(), stats, ss,
+                                        interruption_point);
             }
             case (CoinStatsHashType::MUHASH): {
                 MuHash3072 muhash;
-                return ComputeUTXOStats(view, stats, muhash,
+                if (cursors.size() > 1) {
+                    return ComputeUTXOStats(cursors, stats, muhash,
+                                            interruption_point,
+                                            worker_threads_num);
+                }
+                return ComputeUTXOStats(*cursors.front(), stats, muhash,
                                         interruption_point);
             }
             case (CoinStatsHashType::NONE): {
-                return ComputeUTXOStats(view, stats, nullptr,
+                std::nullptr_t none{nullptr};
+                if (cursors.size() > 1) {
+                    return ComputeUTXOStats(cursors, stats, none,
+                                            interruption_point,
+                                            worker_threads_num);
+                }
+                return ComputeUTXOStats(*cursors.front(), stats, none,
                                         interruption_point);
             }
         } // no default case, so the compiler can warn about missing cases
@@ -162,6 +291,9 @@ ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
     if (!success) {
         return std::nullopt;
     }
+
+    stats.nDiskSize = view->EstimateSize();
+
     return stats;
 }
 
@@ -183,4 +315,26 @@ static void FinalizeHash(MuHash3072 &muhash, CCoinsStats &stats) {
 }
 static void FinalizeHash(std::nullptr_t, CCoinsStats &stats) {}
 
+SerializedUTXOHasher::SerializedUTXOHasher(const BlockHash &block_hash) {
+    // Same as PrepareHash
+    m_writer << block_hash;
+}
+
+void SerializedUTXOHasher::Add(const COutPoint &outpoint, const Coin &coin) {
+    if (!m_outputs.empty() && outpoint.GetTxId() != m_txid) {
+        ApplyHash(m_writer, m_txid, m_outputs);
+        m_outputs.clear();
+    }
+    m_txid = outpoint.GetTxId();
+    m_outputs[outpoint.GetN()] = coin;
+}
+
+uint256 SerializedUTXOHasher::Finalize() {
+    if (!m_outputs.empty()) {
+        ApplyHash(m_writer, m_txid, m_outputs);
+        m_outputs.clear();
+    }
+    return m_writer.GetHash();
+}
+
 } // namespace kernel
@@ -8,11 +8,14 @@
 #include <chain.h>
 #include <coins.h>
 #include <consensus/amount.h>
+#include <hash.h>
+#include <primitives/txid.h>
 #include <streams.h>
 #include <uint256.h>
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <optional>
 
 class CCoinsView;
@@ -79,10 +82,36 @@ uint64_t GetBogoSize(const CScript &script_pub_key);
 
 DataStream TxOutSer(const COutPoint &outpoint, const Coin &coin);
 
+/**
+ * Calculate statistics about the unspent transaction output set.
+ *
+ * @param[in] worker_threads_num  Number of threads, besides the calling one,
+ *     computing the statistics of a coins database in parallel. This is only
+ *     supported by the hashes that don't depend on the order of the coins.
+ */
 std::optional<CCoinsStats>
 ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
                  node::BlockManager &blockman,
-                 const std::function<void()> &interruption_point = {});
+                 const std::function<void()> &interruption_point = {},
+                 int worker_threads_num = 0);
+
+/**
+ * Compute the HASH_SERIALIZED hash of a UTXO set as ComputeUTXOStats does, from
+ * the coins streamed in the coins database order. This is how the UTXO
+ * snapshots are written, so their hash can be checked as they are read.
+ */
+class SerializedUTXOHasher {
+    HashWriter m_writer{};
+    TxId m_txid{};
+    //! The outputs of m_txid seen so far.
+    std::map<uint32_t, Coin> m_outputs;
+
+public:
+    explicit SerializedUTXOHasher(const BlockHash &block_hash);
+
+    void Add(const COutPoint &outpoint, const Coin &coin);
+    uint256 Finalize();
+};
 } // namespace kernel
 
 #endif // BITCOIN_KERNEL_COINSTATS_H
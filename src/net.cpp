@@ -887,9 +887,38 @@ V1TransportDeserializer::GetMessage(const std::chrono::microseconds time,
 
     // Always reset the network deserializer (prepare for the next message)
     Reset();
+    if (m_buffer_pool) {
+        // The payload buffer was moved into the message, pick a recycled one
+        // for the next message.
+        vRecv = m_buffer_pool->Get();
+    }
     return msg;
 }
 
+DataStream RecvBufferPool::Get() {
+    LOCK(m_mutex);
+    if (m_buffers.empty()) {
+        return DataStream{};
+    }
+
+    DataStream buffer{std::move(m_buffers.back())};
+    m_buffers.pop_back();
+    return buffer;
+}
+
+void RecvBufferPool::Put(DataStream &&buffer) {
+    if (buffer.capacity() == 0 || buffer.capacity() > MAX_BUFFER_CAPACITY) {
+        return;
+    }
+
+    buffer.clear();
+
+    LOCK(m_mutex);
+    if (m_buffers.size() < MAX_BUFFERS) {
+        m_buffers.push_back(std::move(buffer));
+    }
+}
+
 void V1TransportSerializer::prepareForTransport(
     const Config &config, CSerializedNetMsg &msg,
     std::vector<uint8_t> &header) const {
@@ -3088,7 +3117,7 @@ CNode::CNode(NodeId idIn, std::shared_ptr<Sock> sock, const CAddress &addrIn,
              const std::string &addrNameIn, ConnectionType conn_type_in,
              bool inbound_onion, CNodeOptions &&node_opts)
     : m_deserializer{std::make_unique<V1TransportDeserializer>(
-          V1TransportDeserializer(GetConfig(), idIn))},
+          V1TransportDeserializer(GetConfig(), idIn, &m_recv_buffer_pool))},
       m_serializer{
           std::make_unique<V1TransportSerializer>(V1TransportSerializer())},
       m_permission_flags{node_opts.permission_flags}, m_sock{sock},
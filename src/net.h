@@ -7,6 +7,7 @@
 #ifndef BITCOIN_NET_H
 #define BITCOIN_NET_H
 
+#include <avalanche/compactpoll.h>
 #include <avalanche/proofid.h>
 #include <avalanche/proofradixtreeadapter.h>
 #include <chainparams.h>
@@ -301,11 +302,46 @@ public:
     virtual ~TransportDeserializer() {}
 };
 
+/**
+ * Bounded free list of message payload buffers.
+ *
+ * Every received message is handed over to the processing queue along with
+ * its payload buffer. Once the message is processed, its buffer can be given
+ * back to the pool so the next message received from the same peer reuses
+ * the allocation instead of going through the allocator again. This matters
+ * for storms of small messages (inv, avalanche polls and responses) where the
+ * per-message allocation dominates the deserialization cost.
+ *
+ * Only small buffers are retained, so the memory held by the pool is bounded
+ * to MAX_BUFFERS * MAX_BUFFER_CAPACITY per peer.
+ */
+class RecvBufferPool {
+public:
+    static constexpr size_t MAX_BUFFERS{4};
+    static constexpr size_t MAX_BUFFER_CAPACITY{32 * 1024};
+
+    /** Get an empty buffer, recycled if one is available. */
+    DataStream Get() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Give a buffer back to the pool. Large buffers are simply released. */
+    void Put(DataStream &&buffer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
+        LOCK(m_mutex);
+        return m_buffers.size();
+    }
+
+private:
+    mutable Mutex m_mutex;
+    std::vector<DataStream> m_buffers GUARDED_BY(m_mutex);
+};
+
 class V1TransportDeserializer final : public TransportDeserializer {
 private:
     const Config &m_config;
     // Only for logging
     const NodeId m_node_id;
+    // Where the payload buffers are taken from, if any. Not owned.
+    RecvBufferPool *const m_buffer_pool;
     mutable CHash256 hasher;
     mutable uint256 data_hash;
 
@@ -336,8 +372,9 @@ private:
     }
 
 public:
-    explicit V1TransportDeserializer(const Config &config, const NodeId node_id)
-        : m_config(config), m_node_id(node_id) {
+    explicit V1TransportDeserializer(const Config &config, const NodeId node_id,
+                                     RecvBufferPool *buffer_pool = nullptr)
+        : m_config(config), m_node_id(node_id), m_buffer_pool(buffer_pool) {
         Reset();
     }
 
@@ -394,6 +431,11 @@ struct CNodeOptions {
 /** Information about a peer */
 class CNode {
 public:
+    /**
+     * Payload buffers of processed messages, reused by the deserializer.
+     * Declared before m_deserializer which keeps a pointer to it.
+     */
+    RecvBufferPool m_recv_buffer_pool;
     // Used only by SocketHandler thread
     const std::unique_ptr<TransportDeserializer> m_deserializer;
     const std::unique_ptr<const TransportSerializer> m_serializer;
@@ -635,6 +677,16 @@ public:
 
     SteadyMilliseconds m_last_poll{};
 
+    /**
+     * Session ids for the compact avalanche polls, see avalanche/compactpoll.h.
+     * The encoder is used when polling this peer, the decoder when this peer
+     * polls us. The decoder is only accessed from the message handler thread.
+     */
+    Mutex m_avalanche_poll_encoder_mutex;
+    avalanche::PollSessionEncoder
+        m_avalanche_poll_encoder GUARDED_BY(m_avalanche_poll_encoder_mutex);
+    avalanche::PollSessionDecoder m_avalanche_poll_decoder;
+
     /**
      * UNIX epoch time of the last block received from this peer that we had
      * not yet seen (e.g. not already received from another peer), that passed
@@ -6,6 +6,7 @@
 #include <net_processing.h>
 
 #include <addrman.h>
+#include <avalanche/compactpoll.h>
 #include <avalanche/compactproofs.h>
 #include <avalanche/peermanager.h>
 #include <avalanche/processor.h>
@@ -59,6 +60,7 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <future>
 #include <memory>
@@ -203,6 +205,14 @@ static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 static constexpr auto BLOCK_STALLING_TIMEOUT_DEFAULT{2s};
 /** Maximum timeout for stalling block download. */
 static constexpr auto BLOCK_STALLING_TIMEOUT_MAX{64s};
+/**
+ * A block that stalls the download window is also requested from another peer
+ * if that peer delivers blocks at least this many times faster than the
+ * staller, so a single slow peer can't hold the window until it times out.
+ */
+static constexpr int BLOCK_RACE_SPEED_RATIO{4};
+/** Maximum number of peers a stalling block is requested from at once. */
+static constexpr size_t MAX_BLOCK_RACE_DOWNLOADS{2};
 /**
  * Maximum depth of blocks we're willing to serve as compact blocks to peers
  *  when requested. For older blocks, a regular BLOCK response will be sent.
@@ -326,6 +336,8 @@ struct QueuedBlock {
     const CBlockIndex *pindex;
     /** Optional, used for CMPCTBLOCK downloads */
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;
+    /** When the block was requested */
+    std::chrono::microseconds m_time_requested{0us};
 };
 
 struct StalledTxId {
@@ -703,6 +715,9 @@ struct CNodeState {
     //! When the first entry in vBlocksInFlight started downloading. Don't care
     //! when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! Moving average of the time it takes this peer to deliver a requested
+    //! block, or 0 if it didn't deliver any yet.
+    std::chrono::microseconds m_block_delivery_time{0us};
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /**
@@ -1440,6 +1455,23 @@ private:
                         std::list<QueuedBlock>::iterator **pit = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Account for a block delivered by a peer we requested it from, to keep
+     * track of how fast this peer is at serving blocks.
+     */
+    void RecordBlockDelivery(const BlockHash &hash, NodeId nodeid)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * If the block download window is stalled by a peer that is much slower
+     * than the one described by state, return the block that should also be
+     * requested from the latter to unblock the window. Return nullptr
+     * otherwise.
+     */
+    const CBlockIndex *GetStallingBlockToRace(const CNodeState &state,
+                                              NodeId staller)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     bool TipMayBeStale() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /**
@@ -1502,6 +1534,25 @@ private:
     /** When our tip was last updated. */
     std::atomic<std::chrono::seconds> m_last_tip_update{0s};
 
+    /**
+     * Serialized responses to recent getheaders requests. Near the tip, many
+     * peers ask for the same headers, so the response is built once and the
+     * payload reused. The entries are only valid for the tip they were built
+     * against: the cache is flushed whenever the tip changes, including on
+     * reorg.
+     */
+    struct CachedHeadersResponse {
+        //! First header of the response, nullptr for an empty response
+        const CBlockIndex *start;
+        BlockHash hash_stop;
+        //! What to set the peer's pindexBestHeaderSent to
+        const CBlockIndex *best_header_sent;
+        std::vector<uint8_t> payload;
+    };
+    static constexpr size_t MAX_CACHED_HEADERS_RESPONSES{8};
+    const CBlockIndex *m_headers_cache_tip GUARDED_BY(cs_main){nullptr};
+    std::deque<CachedHeadersResponse> m_headers_cache GUARDED_BY(cs_main);
+
     /**
      * Determine whether or not a peer can request a transaction, and return it
      * (or nullptr if not found or not allowed).
@@ -1870,14 +1921,16 @@ bool PeerManagerImpl::BlockRequested(const Config &config, NodeId nodeid,
     // Make sure it's not being fetched already from same peer.
     RemoveBlockRequest(hash, nodeid);
 
+    const auto now{GetTime<std::chrono::microseconds>()};
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(
         state->vBlocksInFlight.end(),
-        {&block, std::unique_ptr<PartiallyDownloadedBlock>(
-                     pit ? new PartiallyDownloadedBlock(config, &m_mempool)
-                         : nullptr)});
+        {&block,
+         std::unique_ptr<PartiallyDownloadedBlock>(
+             pit ? new PartiallyDownloadedBlock(config, &m_mempool) : nullptr),
+         now});
     if (state->vBlocksInFlight.size() == 1) {
         // We're starting a block download (batch) from this peer.
-        state->m_downloading_since = GetTime<std::chrono::microseconds>();
+        state->m_downloading_since = now;
         m_peers_downloading_from++;
     }
 
@@ -1891,6 +1944,62 @@ bool PeerManagerImpl::BlockRequested(const Config &config, NodeId nodeid,
     return true;
 }
 
+void PeerManagerImpl::RecordBlockDelivery(const BlockHash &hash,
+                                          NodeId nodeid) {
+    for (auto range = mapBlocksInFlight.equal_range(hash);
+         range.first != range.second; range.first++) {
+        const auto &[node_id, list_it] = range.first->second;
+        if (node_id != nodeid) {
+            continue;
+        }
+
+        CNodeState &state = *Assert(State(nodeid));
+        const auto delivery_time{
+            std::max(0us, GetTime<std::chrono::microseconds>() -
+                              list_it->m_time_requested)};
+        // Exponential moving average with a 1/8 weight for the new sample
+        state.m_block_delivery_time =
+            state.m_block_delivery_time == 0us
+                ? delivery_time
+                : (7 * state.m_block_delivery_time + delivery_time) / 8;
+        return;
+    }
+}
+
+const CBlockIndex *
+PeerManagerImpl::GetStallingBlockToRace(const CNodeState &state,
+                                        NodeId staller) {
+    const CNodeState *staller_state = State(staller);
+    if (!staller_state || staller_state->vBlocksInFlight.empty()) {
+        return nullptr;
+    }
+
+    // Only race a peer that is measurably slower than this one. If we don't
+    // know yet, let the stalling logic handle it.
+    if (state.m_block_delivery_time == 0us ||
+        staller_state->m_block_delivery_time == 0us ||
+        state.m_block_delivery_time * BLOCK_RACE_SPEED_RATIO >=
+            staller_state->m_block_delivery_time) {
+        return nullptr;
+    }
+
+    // The blocks are requested in ascending height order, so the oldest
+    // request of the staller is the one holding the window.
+    const CBlockIndex *pindex = staller_state->vBlocksInFlight.front().pindex;
+    if (mapBlocksInFlight.count(pindex->GetBlockHash()) >=
+        MAX_BLOCK_RACE_DOWNLOADS) {
+        return nullptr;
+    }
+
+    if (!state.pindexBestKnownBlock ||
+        state.pindexBestKnownBlock->GetAncestor(pindex->nHeight) != pindex) {
+        // This peer doesn't have the block
+        return nullptr;
+    }
+
+    return pindex;
+}
+
 void PeerManagerImpl::MaybeSetPeerAsAnnouncingHeaderAndIDs(NodeId nodeid) {
     AssertLockHeld(cs_main);
 
@@ -5755,26 +5864,50 @@ void PeerManagerImpl::ProcessMessage(
             }
         }
 
-        // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx
-        // count at the end
-        std::vector<CBlock> vHeaders;
-        int nLimit = MAX_HEADERS_RESULTS;
         LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n",
                  (pindex ? pindex->nHeight : -1),
                  hashStop.IsNull() ? "end" : hashStop.ToString(),
                  pfrom.GetId());
-        for (; pindex; pindex = m_chainman.ActiveChain().Next(pindex)) {
-            vHeaders.push_back(pindex->GetBlockHeader());
-            if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop) {
-                break;
+
+        if (m_headers_cache_tip != m_chainman.ActiveChain().Tip()) {
+            m_headers_cache.clear();
+            m_headers_cache_tip = m_chainman.ActiveChain().Tip();
+        }
+
+        auto cached = std::find_if(
+            m_headers_cache.begin(), m_headers_cache.end(),
+            [&](const CachedHeadersResponse &entry) {
+                return entry.start == pindex && entry.hash_stop == hashStop;
+            });
+        if (cached == m_headers_cache.end()) {
+            const CBlockIndex *start = pindex;
+
+            // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx
+            // count at the end
+            std::vector<CBlock> vHeaders;
+            int nLimit = MAX_HEADERS_RESULTS;
+            for (; pindex; pindex = m_chainman.ActiveChain().Next(pindex)) {
+                vHeaders.push_back(pindex->GetBlockHeader());
+                if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop) {
+                    break;
+                }
+            }
+
+            if (m_headers_cache.size() >= MAX_CACHED_HEADERS_RESPONSES) {
+                m_headers_cache.pop_front();
             }
+            // pindex can be nullptr either if we sent
+            // m_chainman.ActiveChain().Tip() OR if our peer has
+            // m_chainman.ActiveChain().Tip() (and thus we are sending an empty
+            // headers message). In both cases it's safe to update
+            // pindexBestHeaderSent to be our tip.
+            m_headers_cache.push_back(
+                {start, hashStop,
+                 pindex ? pindex : m_chainman.ActiveChain().Tip(),
+                 NetMsg::Make(NetMsgType::HEADERS, vHeaders).data});
+            cached = std::prev(m_headers_cache.end());
         }
-        // pindex can be nullptr either if we sent
-        // m_chainman.ActiveChain().Tip() OR if our peer has
-        // m_chainman.ActiveChain().Tip() (and thus we are sending an empty
-        // headers message). In both cases it's safe to update
-        // pindexBestHeaderSent to be our tip.
-        //
+
         // It is important that we simply reset the BestHeaderSent value here,
         // and not max(BestHeaderSent, newHeaderSent). We might have announced
         // the currently-being-connected tip using a compact block, which
@@ -5782,9 +5915,12 @@ void PeerManagerImpl::ProcessMessage(
         // without the new block. By resetting the BestHeaderSent, we ensure we
         // will re-announce the new block via headers (or compact blocks again)
         // in the SendMessages logic.
-        nodestate->pindexBestHeaderSent =
-            pindex ? pindex : m_chainman.ActiveChain().Tip();
-        MakeAndPushMessage(pfrom, NetMsgType::HEADERS, vHeaders);
+        nodestate->pindexBestHeaderSent = cached->best_header_sent;
+
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::HEADERS;
+        msg.data = cached->payload;
+        PushMessage(pfrom, std::move(msg));
         return;
     }
 
@@ -6582,6 +6718,7 @@ void PeerManagerImpl::ProcessMessage(
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            RecordBlockDelivery(hash, pfrom.GetId());
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -6702,6 +6839,39 @@ void PeerManagerImpl::ProcessMessage(
         const auto last_poll = pfrom.m_last_poll;
         pfrom.m_last_poll = now;
 
+        // The compact polls need to be decoded even when they are ignored, so
+        // the session ids stay in sync with the poller.
+        uint64_t round;
+        std::vector<CInv> invs;
+        if (pfrom.GetCommonVersion() >= AVALANCHE_COMPACT_POLL_VERSION) {
+            // The items are only read if there are no more of them than can
+            // be polled at once, like the legacy polls below.
+            avalanche::CompactPoll compactPoll{
+                m_avalanche->getMaxElementPoll()};
+            vRecv >> compactPoll;
+            round = compactPoll.getRound();
+
+            if (!pfrom.m_avalanche_poll_decoder.decode(compactPoll, invs)) {
+                Misbehaving(*peer, "invalid-ava-poll-session-id");
+                return;
+            }
+        } else {
+            Unserialize(vRecv, round);
+
+            unsigned int nCount = ReadCompactSize(vRecv);
+            if (nCount > m_avalanche->getMaxElementPoll()) {
+                Misbehaving(*peer, strprintf("too-many-ava-poll: poll message "
+                                             "size = %u",
+                                             nCount));
+                return;
+            }
+
+            invs.resize(nCount);
+            for (CInv &inv : invs) {
+                vRecv >> inv;
+            }
+        }
+
         if (now <
             last_poll + std::chrono::milliseconds(m_opts.avalanche_cooldown)) {
             LogPrint(BCLog::AVALANCHE,
@@ -6713,19 +6883,8 @@ void PeerManagerImpl::ProcessMessage(
 
         const bool quorum_established = m_avalanche->isQuorumEstablished();
 
-        uint64_t round;
-        Unserialize(vRecv, round);
-
-        unsigned int nCount = ReadCompactSize(vRecv);
-        if (nCount > m_avalanche->getMaxElementPoll()) {
-            Misbehaving(
-                *peer,
-                strprintf("too-many-ava-poll: poll message size = %u", nCount));
-            return;
-        }
-
         std::vector<avalanche::Vote> votes;
-        votes.reserve(nCount);
+        votes.reserve(invs.size());
 
         bool fPreconsensus{false};
         bool fStakingPreconsensus{false};
@@ -6737,10 +6896,7 @@ void PeerManagerImpl::ProcessMessage(
                 m_avalanche->isStakingPreconsensusActivated(tip);
         }
 
-        for (unsigned int n = 0; n < nCount; n++) {
-            CInv inv;
-            vRecv >> inv;
-
+        for (const CInv &inv : invs) {
             // Default vote for unknown inv type
             uint32_t vote = -1;
 
@@ -6793,21 +6949,43 @@ void PeerManagerImpl::ProcessMessage(
         if (!m_avalanche) {
             return;
         }
+        bool disconnect{false};
+        std::string error;
+
         // As long as QUIC is not implemented, we need to sign response and
         // verify response's signatures in order to avoid any manipulation of
-        // messages at the transport level.
-        HashVerifier verifier(vRecv);
+        // messages at the transport level. The signature always covers the
+        // full response, so the compact one is expanded first.
         avalanche::Response response;
-        verifier >> response;
+        uint256 responseHash;
+        bool expanded{true};
+        if (pfrom.GetCommonVersion() >= AVALANCHE_COMPACT_POLL_VERSION) {
+            // The votes are only read if there are no more of them than
+            // items polled, which bounds the memory they use once expanded.
+            avalanche::CompactResponse compactResponse{
+                m_avalanche->getMaxPendingPollSize(pfrom.GetId())};
+            vRecv >> compactResponse;
+            expanded = m_avalanche->expandCompactResponse(
+                pfrom.GetId(), compactResponse, response, disconnect, error);
+            responseHash = (HashWriter{} << response).GetHash();
+        } else {
+            HashVerifier verifier(vRecv);
+            verifier >> response;
+            responseHash = verifier.GetHash();
+        }
 
         SchnorrSig sig;
         vRecv >> sig;
 
-        {
-            LOCK(pfrom.cs_avalanche_pubkey);
-            if (!pfrom.m_avalanche_pubkey.has_value() ||
-                !(*pfrom.m_avalanche_pubkey)
-                     .VerifySchnorr(verifier.GetHash(), sig)) {
+        // The signature can't be checked if the response could not be
+        // expanded, this is handled like a failure to register the votes.
+        if (expanded) {
+            // Don't hold cs_avalanche_pubkey while checking the signature
+            const std::optional<CPubKey> pubkey{
+                WITH_LOCK(pfrom.cs_avalanche_pubkey,
+                          return pfrom.m_avalanche_pubkey)};
+            if (!pubkey.has_value() ||
+                !pubkey->VerifySchnorr(responseHash, sig)) {
                 Misbehaving(*peer, "invalid-ava-response-signature");
                 return;
             }
@@ -6816,9 +6994,8 @@ void PeerManagerImpl::ProcessMessage(
         auto now = GetTime<std::chrono::seconds>();
 
         std::vector<avalanche::VoteItemUpdate> updates;
-        bool disconnect{false};
-        std::string error;
-        if (!m_avalanche->registerVotes(pfrom.GetId(), response, updates,
+        if (!expanded ||
+            !m_avalanche->registerVotes(pfrom.GetId(), response, updates,
                                         disconnect, error)) {
             if (disconnect) {
                 Misbehaving(*peer, error);
@@ -8131,6 +8308,9 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
                  __func__, SanitizeString(msg.m_type), msg.m_message_size);
     }
 
+    // The payload has been consumed, let the next message reuse its buffer.
+    pfrom->m_recv_buffer_pool.Put(std::move(msg.m_recv));
+
     return fMoreWork;
 }
 
@@ -9276,6 +9456,21 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
                     *peer, get_inflight_budget(), vToDownload, from_tip,
                     Assert(m_chainman.GetSnapshotBaseBlock()));
             }
+            if (vToDownload.empty() && staller != -1 &&
+                staller != pto->GetId()) {
+                // The download window is held by a block in flight from
+                // another peer. If this peer is much faster, race the staller
+                // for that block instead of waiting for the stalling timeout.
+                if (const CBlockIndex *pindex =
+                        GetStallingBlockToRace(state, staller)) {
+                    LogPrint(BCLog::NET,
+                             "Racing stalling block %s (%d) from peer=%d to "
+                             "peer=%d\n",
+                             pindex->GetBlockHash().ToString(), pindex->nHeight,
+                             staller, pto->GetId());
+                    vToDownload.push_back(pindex);
+                }
+            }
             for (const CBlockIndex *pindex : vToDownload) {
                 vGetData.push_back(CInv(MSG_BLOCK, pindex->GetBlockHash()));
                 BlockRequested(config, pto->GetId(), *pindex);
@@ -9419,9 +9614,18 @@ bool PeerManagerImpl::ReceivedAvalancheProof(CNode &node, Peer &peer,
     // registerProof should not be called while cs_proofrequest because it
     // holds cs_main and that creates a potential deadlock during shutdown
 
+    // Run the stateless checks, which verify all the signatures, before
+    // grabbing the peer manager lock so they don't stall the other users.
+    const Amount stakeUtxoDustThreshold =
+        m_avalanche->withPeerManager([](const avalanche::PeerManager &pm) {
+            return pm.getStakeUtxoDustThreshold();
+        });
+    avalanche::ProofValidationState statelessState;
+    proof->verify(stakeUtxoDustThreshold, statelessState);
+
     avalanche::ProofRegistrationState state;
     if (m_avalanche->withPeerManager([&](avalanche::PeerManager &pm) {
-            return pm.registerProof(proof, state);
+            return pm.registerVerifiedProof(proof, statelessState, state);
         })) {
         WITH_LOCK(cs_proofrequest, m_proofrequest.ForgetInvId(proofid));
         RelayProof(proofid);
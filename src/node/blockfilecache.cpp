@@ -0,0 +1,117 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockfilecache.h>
+
+#include <logging.h>
+#include <util/fs.h>
+#include <util/syserror.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace node {
+
+BlockFileCache::MappedFile::~MappedFile() {
+#ifndef WIN32
+    munmap(const_cast<uint8_t *>(m_data), m_size);
+#endif
+}
+
+bool BlockFileCache::IsSupported() {
+#ifndef WIN32
+    // The files are mapped whole, which is too much for a 32 bits address
+    // space.
+    return sizeof(void *) >= 8;
+#else
+    return false;
+#endif
+}
+
+/** Map the whole file, or return nullptr. */
+static std::shared_ptr<const BlockFileCache::MappedFile>
+MapFile(const fs::path &path) {
+#ifndef WIN32
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    struct stat st;
+    void *data{MAP_FAILED};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            LogPrint(BCLog::BLOCKSTORE, "Failed to map %s: %s\n",
+                     fs::PathToString(path), SysErrorString(errno));
+        }
+    }
+    // The mapping doesn't need the file descriptor to remain open.
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::make_shared<const BlockFileCache::MappedFile>(
+        static_cast<const uint8_t *>(data), st.st_size);
+#else
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<const BlockFileCache::MappedFile>
+BlockFileCache::Get(FileType type, int file_num, const fs::path &path,
+                    size_t min_size) {
+    if (!IsSupported() || m_max_files == 0) {
+        return nullptr;
+    }
+
+    LOCK(m_mutex);
+
+    const auto key = std::make_pair(type, file_num);
+    auto it = m_files.find(key);
+    if (it == m_files.end() || it->second.file->GetData().size() < min_size) {
+        // Not mapped yet, or the file grew since it was mapped.
+        auto file = MapFile(path);
+        if (!file) {
+            return nullptr;
+        }
+
+        if (it == m_files.end()) {
+            if (m_files.size() >= m_max_files) {
+                m_files.erase(std::min_element(
+                    m_files.begin(), m_files.end(),
+                    [](const auto &a, const auto &b) {
+                        return a.second.last_used < b.second.last_used;
+                    }));
+            }
+            it = m_files.emplace(key, Entry{}).first;
+        }
+        it->second.file = std::move(file);
+    }
+
+    it->second.last_used = ++m_use_count;
+    if (it->second.file->GetData().size() < min_size) {
+        return nullptr;
+    }
+    return it->second.file;
+}
+
+void BlockFileCache::Invalidate(FileType type, int file_num) {
+    LOCK(m_mutex);
+    m_files.erase(std::make_pair(type, file_num));
+}
+
+void BlockFileCache::Clear() {
+    LOCK(m_mutex);
+    m_files.clear();
+}
+
+} // namespace node
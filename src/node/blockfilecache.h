@@ -0,0 +1,96 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKFILECACHE_H
+#define BITCOIN_NODE_BLOCKFILECACHE_H
+
+#include <span.h>
+#include <sync.h>
+#include <util/fs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace node {
+
+/** Default number of block and undo files kept mapped for reading. */
+static constexpr size_t DEFAULT_BLOCK_FILE_CACHE_FILES{64};
+
+/**
+ * Read-only memory mappings of the block and undo files, so the random reads
+ * of blocks and transactions don't need to open the file and go through stdio
+ * every time.
+ *
+ * The most recently used files are kept mapped. A mapping covers the file as
+ * it was when it got mapped. The data written afterwards in that range is
+ * visible through it, and the file is mapped again when a read needs more.
+ *
+ * The mappings must be invalidated when the files are truncated or removed.
+ * They remain valid for the readers still holding them, but reading past the
+ * end of a truncated file is an error that can't be recovered from, so they
+ * must only be used to read data that is known to be there.
+ *
+ * Mapping is only supported on 64 bits POSIX systems. Otherwise Get() always
+ * returns nullptr and the caller is expected to fall back to reading the file.
+ */
+class BlockFileCache {
+public:
+    enum class FileType {
+        BLOCK,
+        UNDO,
+    };
+
+    class MappedFile {
+        const uint8_t *m_data;
+        size_t m_size;
+
+    public:
+        MappedFile(const uint8_t *data, size_t size)
+            : m_data(data), m_size(size) {}
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        Span<const uint8_t> GetData() const { return {m_data, m_size}; }
+    };
+
+    explicit BlockFileCache(size_t max_files = DEFAULT_BLOCK_FILE_CACHE_FILES)
+        : m_max_files(max_files) {}
+
+    static bool IsSupported();
+
+    /**
+     * Get a mapping of the file that is at least min_size bytes long, or
+     * nullptr if the file can't be mapped or is not long enough.
+     */
+    std::shared_ptr<const MappedFile> Get(FileType type, int file_num,
+                                          const fs::path &path,
+                                          size_t min_size)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Drop the mapping of a file that is being truncated or removed. */
+    void Invalidate(FileType type, int file_num)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    const size_t m_max_files;
+
+    struct Entry {
+        std::shared_ptr<const MappedFile> file;
+        uint64_t last_used{0};
+    };
+
+    Mutex m_mutex;
+    std::map<std::pair<FileType, int>, Entry> m_files GUARDED_BY(m_mutex);
+    uint64_t m_use_count GUARDED_BY(m_mutex){0};
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKFILECACHE_H
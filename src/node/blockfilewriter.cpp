@@ -0,0 +1,172 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockfilewriter.h>
+
+#include <logging.h>
+#include <streams.h>
+#include <util/thread.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <tuple>
+
+namespace node {
+
+BlockFileWriter::BlockFileWriter(
+    FlatFileSeq block_file_seq, FlatFileSeq undo_file_seq,
+    size_t max_queue_size, std::function<void(const std::string &)> on_error)
+    : m_block_file_seq(std::move(block_file_seq)),
+      m_undo_file_seq(std::move(undo_file_seq)),
+      m_max_queue_size(max_queue_size), m_on_error(std::move(on_error)) {
+    if (m_max_queue_size > 0) {
+        m_thread = std::thread(&util::TraceThread, "blockwrite",
+                               [this] { ThreadWrite(); });
+    }
+}
+
+BlockFileWriter::~BlockFileWriter() {
+    if (m_thread.joinable()) {
+        // The queued writes are done before the thread exits.
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        m_thread.join();
+    }
+}
+
+bool BlockFileWriter::Write(FileType type, const FlatFilePos &pos,
+                            std::vector<uint8_t> data) {
+    if (m_max_queue_size == 0) {
+        std::vector<PendingWrite> batch;
+        batch.push_back({type, pos, std::move(data)});
+        return WriteBatch(batch);
+    }
+
+    {
+        WAIT_LOCK(m_mutex, lock);
+        // A write larger than the queue is accepted once it is empty.
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_queue_size == 0 ||
+                   m_queue_size + data.size() <= m_max_queue_size;
+        });
+        // Don't let the caller record the position of more data that can't be
+        // read back.
+        if (m_failed) {
+            return false;
+        }
+        m_queue_size += data.size();
+        ++m_pending[{type, pos.nFile}];
+        m_queue.push_back({type, pos, std::move(data)});
+    }
+    m_cv.notify_all();
+    return true;
+}
+
+void BlockFileWriter::WaitForFile(FileType type, int file_num) const {
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+        return !m_pending.contains({type, file_num});
+    });
+}
+
+bool BlockFileWriter::Flush() {
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+        return m_pending.empty();
+    });
+    return !m_failed;
+}
+
+bool BlockFileWriter::HasFailed() const {
+    return WITH_LOCK(m_mutex, return m_failed);
+}
+
+void BlockFileWriter::ThreadWrite() {
+    while (true) {
+        std::vector<PendingWrite> batch;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return m_stop || !m_queue.empty();
+            });
+            if (m_queue.empty()) {
+                return;
+            }
+            std::swap(batch, m_queue);
+        }
+
+        const bool success{WriteBatch(batch)};
+
+        {
+            LOCK(m_mutex);
+            for (const PendingWrite &write : batch) {
+                m_queue_size -= write.data.size();
+                const auto it = m_pending.find({write.type, write.pos.nFile});
+                if (--it->second == 0) {
+                    m_pending.erase(it);
+                }
+            }
+            m_failed |= !success;
+        }
+        m_cv.notify_all();
+    }
+}
+
+bool BlockFileWriter::WriteBatch(const std::vector<PendingWrite> &batch) {
+    // Write each file in order of position.
+    std::vector<const PendingWrite *> sorted;
+    sorted.reserve(batch.size());
+    for (const PendingWrite &write : batch) {
+        sorted.push_back(&write);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) {
+        return std::tie(a->type, a->pos.nFile, a->pos.nPos) <
+               std::tie(b->type, b->pos.nFile, b->pos.nPos);
+    });
+
+    bool success{true};
+    auto it = sorted.begin();
+    while (it != sorted.end()) {
+        const FileType type{(*it)->type};
+        const int file_num{(*it)->pos.nFile};
+        const auto file_end = std::find_if(it, sorted.end(), [&](auto *write) {
+            return write->type != type || write->pos.nFile != file_num;
+        });
+        const bool is_undo{type == FileType::UNDO};
+
+        FlatFileSeq &seq{is_undo ? m_undo_file_seq : m_block_file_seq};
+        try {
+            AutoFile file{seq.Open((*it)->pos)};
+            if (file.IsNull()) {
+                throw std::ios_base::failure("failed to open the file");
+            }
+            // Seek only when the writes are not contiguous.
+            uint64_t file_pos{(*it)->pos.nPos};
+            for (; it != file_end; ++it) {
+                if ((*it)->pos.nPos != file_pos &&
+                    std::fseek(file.Get(), (*it)->pos.nPos, SEEK_SET) != 0) {
+                    throw std::ios_base::failure("failed to seek");
+                }
+                file.write(MakeByteSpan((*it)->data));
+                file_pos = uint64_t{(*it)->pos.nPos} + (*it)->data.size();
+            }
+            if (file.fclose() != 0) {
+                throw std::ios_base::failure("failed to close the file");
+            }
+        } catch (const std::exception &e) {
+            LogError("%s: Failed to write to %s: %s\n", __func__,
+                     fs::PathToString(seq.FileName({file_num, 0})), e.what());
+            if (m_max_queue_size > 0) {
+                m_on_error(is_undo ? "Failed to write undo data"
+                                   : "Failed to write block");
+            }
+            success = false;
+            it = file_end;
+        }
+    }
+    return success;
+}
+
+} // namespace node
@@ -0,0 +1,107 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKFILEWRITER_H
+#define BITCOIN_NODE_BLOCKFILEWRITER_H
+
+#include <flatfile.h>
+#include <node/blockfilecache.h>
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace node {
+
+/** Default maximum size of the data queued for writing to the block files. */
+static constexpr size_t DEFAULT_BLOCK_WRITE_QUEUE_SIZE{64 << 20};
+
+/**
+ * Writes the serialized blocks and undo data to their files from a dedicated
+ * thread, so the validation thread doesn't wait for the disk.
+ *
+ * The positions are allocated by the caller beforehand, so the writes can be
+ * queued and performed in any order. The writes queued while the previous
+ * ones are performed are done in one pass, opening each file once.
+ *
+ * The reads of a file must wait for the pending writes to it with
+ * WaitForFile(), and Flush() must be called before the files are synced,
+ * truncated or removed.
+ *
+ * With a zero queue size, the data is written synchronously by Write().
+ */
+class BlockFileWriter {
+public:
+    using FileType = BlockFileCache::FileType;
+
+    BlockFileWriter(FlatFileSeq block_file_seq, FlatFileSeq undo_file_seq,
+                    size_t max_queue_size,
+                    std::function<void(const std::string &)> on_error);
+    ~BlockFileWriter();
+
+    BlockFileWriter(const BlockFileWriter &) = delete;
+    BlockFileWriter &operator=(const BlockFileWriter &) = delete;
+
+    /**
+     * Write data at pos. This waits for room in the queue if it is full.
+     * Return false if the data is written synchronously and that failed, or
+     * if an earlier asynchronous write failed, in which case nothing more is
+     * written. The failures of the asynchronous writes are reported to
+     * on_error.
+     */
+    bool Write(FileType type, const FlatFilePos &pos, std::vector<uint8_t> data)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait until the queued writes to a file are done. */
+    void WaitForFile(FileType type, int file_num) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Wait until all the queued writes are done. Return false if any of the
+     * asynchronous writes failed.
+     */
+    bool Flush() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Return true if any of the asynchronous writes failed. */
+    bool HasFailed() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct PendingWrite {
+        FileType type;
+        FlatFilePos pos;
+        std::vector<uint8_t> data;
+    };
+
+    FlatFileSeq m_block_file_seq;
+    FlatFileSeq m_undo_file_seq;
+    const size_t m_max_queue_size;
+    const std::function<void(const std::string &)> m_on_error;
+
+    mutable Mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    std::vector<PendingWrite> m_queue GUARDED_BY(m_mutex);
+    /** Size of the data queued or being written. */
+    size_t m_queue_size GUARDED_BY(m_mutex){0};
+    /** Number of writes queued or being written, by file. */
+    std::map<std::pair<FileType, int>, size_t> m_pending GUARDED_BY(m_mutex);
+    bool m_failed GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::thread m_thread;
+
+    void ThreadWrite() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Write a batch, opening each file once. Return false on failure. */
+    bool WriteBatch(const std::vector<PendingWrite> &batch);
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKFILEWRITER_H
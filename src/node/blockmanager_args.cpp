@@ -39,6 +39,18 @@ std::optional<bilingual_str> ApplyArgsManOptions(const ArgsManager &args,
         opts.fast_prune = *value;
     }
 
+    if (auto value{args.GetBoolArg("-blockfilemmap")}) {
+        opts.use_mmap = *value;
+    }
+
+    if (auto value{args.GetBoolArg("-flatblockindex")}) {
+        opts.flat_block_index = *value;
+    }
+
+    if (auto value{args.GetBoolArg("-asyncblockwrites")}) {
+        opts.async_block_writes = *value;
+    }
+
     return std::nullopt;
 }
 } // namespace node
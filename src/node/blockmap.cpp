@@ -0,0 +1,45 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockmap.h>
+
+#include <util/hasher.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace node {
+
+size_t BlockMap::FindBucket(const BlockHash &hash) const {
+    // Fibonacci hashing, so all the bits of the hash are used to pick the
+    // bucket and not only the low ones.
+    const size_t mask{m_table.size() - 1};
+    const uint64_t hash64{BlockHasher{}(hash)};
+    size_t bucket(hash64 * 0x9e3779b97f4a7c15ULL >>
+                  (64 - std::countr_zero(m_table.size())));
+    while (true) {
+        const uint32_t pos{m_table[bucket]};
+        if (pos == EMPTY || At(pos).first == hash) {
+            return bucket;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+}
+
+void BlockMap::Reserve(size_t count) {
+    if (count >= EMPTY) {
+        throw std::length_error("BlockMap::Reserve(): too many entries");
+    }
+    if (2 * count <= m_table.size()) {
+        return;
+    }
+
+    m_table.assign(std::bit_ceil(std::max<size_t>(2 * count, 64)), EMPTY);
+    for (uint32_t pos = 0; pos < m_size; ++pos) {
+        m_table[FindBucket(At(pos).first)] = pos;
+    }
+}
+
+} // namespace node
@@ -0,0 +1,187 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKMAP_H
+#define BITCOIN_NODE_BLOCKMAP_H
+
+#include <blockindex.h>
+#include <primitives/blockhash.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace node {
+
+/**
+ * The block index entries, by block hash.
+ *
+ * The entries are stored in insertion order in an arena of fixed size chunks,
+ * so their addresses are stable as required by the pointers to them. The
+ * entries inserted together, like the ancestors of a block when the block
+ * index is loaded by height, are next to each other in memory, which makes
+ * the chain walks cache friendly. The lookups by hash go through an open
+ * addressing table of 32 bits positions in the arena, which is much more
+ * compact than the nodes of a std::unordered_map.
+ *
+ * This supports the subset of the std::unordered_map interface that is used
+ * with the block index. The entries can't be erased individually.
+ */
+class BlockMap {
+public:
+    using key_type = BlockHash;
+    using mapped_type = CBlockIndex;
+    using value_type = std::pair<const BlockHash, CBlockIndex>;
+    using size_type = size_t;
+
+    /** Number of entries per chunk of the arena. */
+    static constexpr size_t CHUNK_SIZE{1 << 12};
+
+    template <bool Const> class Iterator {
+        using Map = std::conditional_t<Const, const BlockMap, BlockMap>;
+
+        Map *m_map{nullptr};
+        uint32_t m_pos{0};
+
+        Iterator(Map *map, uint32_t pos) : m_map(map), m_pos(pos) {}
+
+        friend class BlockMap;
+        friend class Iterator<!Const>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = BlockMap::value_type;
+        using pointer =
+            std::conditional_t<Const, const value_type *, value_type *>;
+        using reference =
+            std::conditional_t<Const, const value_type &, value_type &>;
+
+        Iterator() = default;
+        template <bool C = Const, std::enable_if_t<C, int> = 0>
+        Iterator(const Iterator<false> &other)
+            : m_map(other.m_map), m_pos(other.m_pos) {}
+
+        reference operator*() const { return m_map->At(m_pos); }
+        pointer operator->() const { return &m_map->At(m_pos); }
+
+        Iterator &operator++() {
+            ++m_pos;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator it{*this};
+            ++m_pos;
+            return it;
+        }
+
+        friend bool operator==(const Iterator &a, const Iterator &b) {
+            return a.m_pos == b.m_pos;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    BlockMap() = default;
+    BlockMap(const BlockMap &) = delete;
+    BlockMap &operator=(const BlockMap &) = delete;
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, m_size}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, m_size}; }
+
+    iterator find(const BlockHash &hash) { return {this, FindPos(hash)}; }
+    const_iterator find(const BlockHash &hash) const {
+        return {this, FindPos(hash)};
+    }
+    size_t count(const BlockHash &hash) const {
+        return find(hash) == end() ? 0 : 1;
+    }
+
+    /**
+     * Insert an entry constructed from args if there is none for the hash.
+     * The references to the existing entries remain valid.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const BlockHash &hash,
+                                          Args &&...args) {
+        if (auto it = find(hash); it != end()) {
+            return {it, false};
+        }
+
+        Reserve(m_size + 1);
+        if (m_size % CHUNK_SIZE == 0) {
+            m_chunks.emplace_back().reserve(CHUNK_SIZE);
+        }
+        m_chunks.back().emplace_back(
+            std::piecewise_construct, std::forward_as_tuple(hash),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        m_table[FindBucket(hash)] = m_size;
+        return {{this, m_size++}, true};
+    }
+
+    CBlockIndex &operator[](const BlockHash &hash) {
+        return try_emplace(hash).first->second;
+    }
+
+    /** Make room for count entries without rehashing. */
+    void reserve(size_t count) {
+        Reserve(count);
+        m_chunks.reserve((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    }
+
+    void clear() {
+        m_chunks.clear();
+        m_table.clear();
+        m_size = 0;
+    }
+
+private:
+    static constexpr uint32_t EMPTY{std::numeric_limits<uint32_t>::max()};
+
+    std::vector<std::vector<value_type>> m_chunks;
+    /**
+     * The positions of the entries in the arena, by hash, or EMPTY. The size
+     * is a power of 2 and at least twice the number of entries.
+     */
+    std::vector<uint32_t> m_table;
+    uint32_t m_size{0};
+
+    value_type &At(uint32_t pos) {
+        return m_chunks[pos / CHUNK_SIZE][pos % CHUNK_SIZE];
+    }
+    const value_type &At(uint32_t pos) const {
+        return m_chunks[pos / CHUNK_SIZE][pos % CHUNK_SIZE];
+    }
+
+    /**
+     * Return the bucket of the table holding the hash, or the empty bucket
+     * where it would be inserted. The table must not be empty.
+     */
+    size_t FindBucket(const BlockHash &hash) const;
+    /** Return the position of the entry for the hash, or m_size. */
+    uint32_t FindPos(const BlockHash &hash) const {
+        if (m_table.empty()) {
+            return m_size;
+        }
+        const uint32_t pos{m_table[FindBucket(hash)]};
+        return pos == EMPTY ? m_size : pos;
+    }
+    /** Grow the table if needed to hold count entries. */
+    void Reserve(size_t count);
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKMAP_H
@@ -16,11 +16,13 @@
 #include <kernel/chainparams.h>
 #include <logging.h>
 #include <pow/pow.h>
+#include <random.h>
 #include <reverse_iterator.h>
 #include <streams.h>
 #include <undo.h>
 #include <util/batchpriority.h>
 #include <util/fs.h>
+#include <util/fs_helpers.h>
 #include <util/signalinterrupt.h>
 #include <validation.h>
 
@@ -53,11 +55,11 @@ const CBlockIndex *BlockManager::LookupBlockIndex(const BlockHash &hash) const {
 }
 
 CBlockIndex *BlockManager::AddToBlockIndex(const CBlockHeader &block,
+                                           const BlockHash &hash,
                                            CBlockIndex *&best_header) {
     AssertLockHeld(cs_main);
 
-    const auto [mi, inserted] =
-        m_block_index.try_emplace(block.GetHash(), block);
+    const auto [mi, inserted] = m_block_index.try_emplace(hash, block);
     if (!inserted) {
         return &mi->second;
     }
@@ -254,10 +256,184 @@ CBlockIndex *BlockManager::InsertBlockIndex(const BlockHash &hash) {
     return pindex;
 }
 
+namespace {
+/**
+ * The flat block index file starts with a header identifying the copy of the
+ * block tree database it was written from, followed by a fixed size record
+ * per block index entry sorted by height, and ends with the SHA256 of the
+ * content.
+ */
+constexpr std::array<uint8_t, 4> FLAT_BLOCK_INDEX_MAGIC{
+    {'f', 'b', 'i', 'x'}};
+constexpr uint32_t FLAT_BLOCK_INDEX_VERSION{1};
+/** Size of the chunks the file is written in. */
+constexpr size_t FLAT_BLOCK_INDEX_BUFFER_SIZE{1 << 20};
+
+struct FlatBlockIndexRecord {
+    static constexpr uint32_t NO_PREV{std::numeric_limits<uint32_t>::max()};
+
+    BlockHash hash;
+    //! Position of the record of the previous block, or NO_PREV.
+    uint32_t prev{NO_PREV};
+    int32_t height{0};
+    BlockStatus status;
+    int32_t file{0};
+    uint32_t data_pos{0};
+    uint32_t undo_pos{0};
+    uint32_t tx_count{0};
+    uint32_t size{0};
+    int32_t version{0};
+    uint256 merkle_root;
+    uint32_t time{0};
+    uint32_t bits{0};
+    uint32_t nonce{0};
+    uint256 chain_work;
+
+    SERIALIZE_METHODS(FlatBlockIndexRecord, obj) {
+        READWRITE(obj.hash, obj.prev, obj.height,
+                  Using<BlockStatus::FixedSizeFormatter>(obj.status),
+                  obj.file, obj.data_pos, obj.undo_pos, obj.tx_count, obj.size,
+                  obj.version, obj.merkle_root, obj.time, obj.bits, obj.nonce,
+                  obj.chain_work);
+    }
+};
+} // namespace
+
+bool BlockManager::LoadFlatBlockIndex(std::vector<CBlockIndex *> &sorted) {
+    AssertLockHeld(cs_main);
+
+    uint256 id;
+    if (!m_opts.flat_block_index || !m_block_index.empty() ||
+        !m_block_tree_db->ReadFlatBlockIndexId(id)) {
+        return false;
+    }
+    // The file is only used once, since the database can be modified by
+    // versions that don't know about it before the next startup.
+    m_block_tree_db->EraseFlatBlockIndexId();
+    // Like the database, the file is only loaded by the version that wrote
+    // it. The database then reports the version mismatch.
+    if (!m_block_tree_db->HasCurrentVersion()) {
+        LogPrintf("Not loading the block index from %s: the block index "
+                  "database is not of the current version\n",
+                  fs::PathToString(GetFlatBlockIndexPath()));
+        return false;
+    }
+
+    const fs::path path{GetFlatBlockIndexPath()};
+    try {
+        std::error_code ec;
+        const uintmax_t file_size{fs::file_size(path, ec)};
+        if (ec) {
+            throw std::runtime_error(ec.message());
+        }
+        std::vector<uint8_t> data(file_size);
+        {
+            AutoFile file{fsbridge::fopen(path, "rb")};
+            if (file.IsNull()) {
+                throw std::runtime_error("failed to open the file");
+            }
+            file.read(MakeWritableByteSpan(data));
+        }
+
+        if (data.size() < uint256::size()) {
+            throw std::runtime_error("the file is truncated");
+        }
+        const auto content{Span{data}.first(data.size() - uint256::size())};
+        uint256 checksum;
+        SpanReader{Span{data}.last(uint256::size())} >> checksum;
+        HashWriter hasher{};
+        hasher.write(MakeByteSpan(content));
+        if (hasher.GetSHA256() != checksum) {
+            throw std::runtime_error("checksum mismatch");
+        }
+
+        SpanReader reader{content};
+        std::array<uint8_t, 4> magic;
+        uint32_t version;
+        uint256 file_id;
+        uint64_t count;
+        reader >> magic >> version >> file_id >> count;
+        if (magic != FLAT_BLOCK_INDEX_MAGIC ||
+            version != FLAT_BLOCK_INDEX_VERSION || file_id != id) {
+            throw std::runtime_error("not a copy of the database");
+        }
+        FlatBlockIndexRecord record;
+        if (reader.size() != count * GetSerializeSize(record)) {
+            throw std::runtime_error("unexpected size");
+        }
+        // The block index of a loaded node has at least the genesis block.
+        if (count == 0) {
+            throw std::runtime_error("the file has no entry");
+        }
+
+        m_block_index.reserve(count);
+        sorted.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            reader >> record;
+
+            CBlockIndex *pindex = InsertBlockIndex(record.hash);
+            if (!pindex || m_block_index.size() != sorted.size() + 1) {
+                throw std::runtime_error("invalid or duplicated entry");
+            }
+            if (record.prev != FlatBlockIndexRecord::NO_PREV) {
+                if (record.prev >= sorted.size()) {
+                    throw std::runtime_error("invalid previous entry");
+                }
+                pindex->pprev = sorted[record.prev];
+            }
+            const int expected_height{
+                pindex->pprev ? pindex->pprev->nHeight + 1 : 0};
+            if (record.height != expected_height ||
+                (!sorted.empty() && record.height < sorted.back()->nHeight)) {
+                throw std::runtime_error("inconsistent height");
+            }
+
+            pindex->nHeight = record.height;
+            pindex->nStatus = record.status;
+            pindex->nFile = record.file;
+            pindex->nDataPos = record.data_pos;
+            pindex->nUndoPos = record.undo_pos;
+            pindex->nTx = record.tx_count;
+            pindex->nSize = record.size;
+            pindex->nVersion = record.version;
+            pindex->hashMerkleRoot = record.merkle_root;
+            pindex->nTime = record.time;
+            pindex->nBits = record.bits;
+            pindex->nNonce = record.nonce;
+            pindex->nChainWork = UintToArith256(record.chain_work);
+
+            if (!CheckProofOfWork(pindex->GetBlockHash(), pindex->nBits,
+                                  GetConsensus())) {
+                throw std::runtime_error(
+                    strprintf("CheckProofOfWork failed: %s",
+                              pindex->ToString()));
+            }
+            sorted.push_back(pindex);
+        }
+        if (!LookupBlockIndex(GetParams().GenesisBlock().GetHash())) {
+            throw std::runtime_error("the genesis block is missing");
+        }
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to load the block index from %s, loading it from "
+                  "the database instead: %s\n",
+                  fs::PathToString(path), e.what());
+        sorted.clear();
+        m_block_index.clear();
+        return false;
+    }
+
+    LogPrintf("Loaded %d block index entries from %s\n", sorted.size(),
+              fs::PathToString(path));
+    return true;
+}
+
 bool BlockManager::LoadBlockIndex(
     const std::optional<BlockHash> &snapshot_blockhash) {
     AssertLockHeld(cs_main);
-    if (!m_block_tree_db->LoadBlockIndexGuts(
+    std::vector<CBlockIndex *> vSortedByHeight;
+    const bool loaded_flat{LoadFlatBlockIndex(vSortedByHeight)};
+    if (!loaded_flat &&
+        !m_block_tree_db->LoadBlockIndexGuts(
             GetConsensus(),
             [this](const BlockHash &hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
                 return this->InsertBlockIndex(hash);
@@ -288,10 +464,12 @@ bool BlockManager::LoadBlockIndex(
 
     Assert(m_snapshot_height.has_value() == snapshot_blockhash.has_value());
 
-    // Calculate nChainWork
-    std::vector<CBlockIndex *> vSortedByHeight{GetAllBlockIndices()};
-    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-              CBlockIndexHeightOnlyComparator());
+    // The flat block index is already sorted and has the chain work.
+    if (!loaded_flat) {
+        vSortedByHeight = GetAllBlockIndices();
+        std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+                  CBlockIndexHeightOnlyComparator());
+    }
 
     CBlockIndex *previous_index{nullptr};
     for (CBlockIndex *pindex : vSortedByHeight) {
@@ -306,8 +484,11 @@ bool BlockManager::LoadBlockIndex(
         }
         previous_index = pindex;
 
-        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) +
-                             GetBlockProof(*pindex);
+        if (!loaded_flat) {
+            pindex->nChainWork =
+                (pindex->pprev ? pindex->pprev->nChainWork : 0) +
+                GetBlockProof(*pindex);
+        }
         pindex->nTimeMax =
             (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime)
                            : pindex->nTime);
@@ -345,7 +526,15 @@ bool BlockManager::LoadBlockIndex(
     return true;
 }
 
-void BlockManager::WriteBlockIndexDB() {
+bool BlockManager::WriteBlockIndexDB() {
+    // The data the entries refer to must have been written.
+    if (!m_block_file_writer.Flush()) {
+        LogError("%s: Not writing the block index after a failure to write "
+                 "the block files\n",
+                 __func__);
+        return false;
+    }
+
     std::vector<std::pair<int, const CBlockFileInfo *>> vFiles;
     vFiles.reserve(m_dirty_fileinfo.size());
     for (int i : m_dirty_fileinfo) {
@@ -365,6 +554,94 @@ void BlockManager::WriteBlockIndexDB() {
     int max_blockfile =
         WITH_LOCK(cs_LastBlockFile, return this->MaxBlockfileNum());
     m_block_tree_db->WriteBatchSync(vFiles, max_blockfile, vBlocks);
+    return true;
+}
+
+bool BlockManager::WriteFlatBlockIndex() {
+    AssertLockHeld(cs_main);
+
+    // The file must be a copy of the database.
+    if (!m_opts.flat_block_index || !m_block_tree_db ||
+        !m_block_index_loaded || !m_dirty_blockindex.empty() ||
+        m_block_file_writer.HasFailed()) {
+        return false;
+    }
+
+    std::vector<CBlockIndex *> sorted{GetAllBlockIndices()};
+    std::sort(sorted.begin(), sorted.end(), CBlockIndexHeightOnlyComparator());
+    std::unordered_map<const CBlockIndex *, uint32_t> positions;
+    positions.reserve(sorted.size());
+
+    const uint256 id{GetRandHash()};
+    const fs::path path{GetFlatBlockIndexPath()};
+    const fs::path tmp_path{path + ".new"};
+    AutoFile file{fsbridge::fopen(tmp_path, "wb")};
+    if (file.IsNull()) {
+        LogError("%s: Failed to open %s\n", __func__,
+                 fs::PathToString(tmp_path));
+        return false;
+    }
+
+    try {
+        HashWriter hasher{};
+        DataStream buffer;
+        buffer.reserve(FLAT_BLOCK_INDEX_BUFFER_SIZE);
+        const auto write_buffer = [&]() {
+            hasher.write(buffer);
+            file.write(buffer);
+            buffer.clear();
+        };
+
+        buffer << FLAT_BLOCK_INDEX_MAGIC << FLAT_BLOCK_INDEX_VERSION << id
+               << uint64_t(sorted.size());
+        FlatBlockIndexRecord record;
+        for (const CBlockIndex *pindex : sorted) {
+            record.hash = pindex->GetBlockHash();
+            record.prev = pindex->pprev ? positions.at(pindex->pprev)
+                                        : FlatBlockIndexRecord::NO_PREV;
+            record.height = pindex->nHeight;
+            record.status = pindex->nStatus;
+            record.file = pindex->nFile;
+            record.data_pos = pindex->nDataPos;
+            record.undo_pos = pindex->nUndoPos;
+            record.tx_count = pindex->nTx;
+            record.size = pindex->nSize;
+            record.version = pindex->nVersion;
+            record.merkle_root = pindex->hashMerkleRoot;
+            record.time = pindex->nTime;
+            record.bits = pindex->nBits;
+            record.nonce = pindex->nNonce;
+            record.chain_work = ArithToUint256(pindex->nChainWork);
+            buffer << record;
+            positions.emplace(pindex, positions.size());
+
+            if (buffer.size() >= FLAT_BLOCK_INDEX_BUFFER_SIZE) {
+                write_buffer();
+            }
+        }
+        write_buffer();
+        file << hasher.GetSHA256();
+    } catch (const std::exception &e) {
+        LogError("%s: Failed to write %s: %s\n", __func__,
+                 fs::PathToString(tmp_path), e.what());
+        return false;
+    }
+
+    if (!FileCommit(file.Get()) || file.fclose() != 0) {
+        LogError("%s: Failed to commit %s\n", __func__,
+                 fs::PathToString(tmp_path));
+        return false;
+    }
+    if (!RenameOver(tmp_path, path)) {
+        LogError("%s: Failed to rename %s\n", __func__,
+                 fs::PathToString(tmp_path));
+        return false;
+    }
+
+    m_block_tree_db->WriteFlatBlockIndexId(id);
+    LogPrintf("Wrote %d block index entries to %s\n", sorted.size(),
+              fs::PathToString(path));
+    return true;
 }
 
 bool BlockManager::LoadBlockIndexDB(
@@ -430,6 +707,7 @@ bool BlockManager::LoadBlockIndexDB(
         fReindex = true;
     }
 
+    m_block_index_loaded = true;
     return true;
 }
 
@@ -545,6 +823,8 @@ void BlockManager::CleanupBlockRevFiles() const {
         }
         remove(item.second);
     }
+
+    m_block_file_cache.Clear();
 }
 
 CBlockFileInfo *BlockManager::GetBlockFileInfo(size_t n) {
@@ -553,6 +833,58 @@ CBlockFileInfo *BlockManager::GetBlockFileInfo(size_t n) {
     return &m_blockfile_info.at(n);
 }
 
+template <typename Read>
+bool BlockManager::ReadFromMappedFile(BlockFileCache::FileType type,
+                                      const FlatFilePos &pos,
+                                      Read &&read) const {
+    if (!m_opts.use_mmap) {
+        return false;
+    }
+    m_block_file_writer.WaitForFile(type, pos.nFile);
+
+    // The mapping can cover the preallocated space past the data, which is
+    // truncated when the file is finalized while the mapping is still in use.
+    // Accessing it then raises SIGBUS rather than an exception, so a corrupt
+    // length must not make the reads go past the data.
+    size_t data_size{0};
+    {
+        LOCK(cs_LastBlockFile);
+        if (pos.nFile >= 0 && size_t(pos.nFile) < m_blockfile_info.size()) {
+            const CBlockFileInfo &info{m_blockfile_info[pos.nFile]};
+            data_size = type == BlockFileCache::FileType::BLOCK
+                            ? info.nSize
+                            : info.nUndoSize;
+        }
+    }
+    if (pos.nPos >= data_size) {
+        return false;
+    }
+
+    const fs::path path{type == BlockFileCache::FileType::BLOCK
+                            ? BlockFileSeq().FileName(pos)
+                            : UndoFileSeq().FileName(pos)};
+    size_t min_size = size_t(pos.nPos) + 1;
+    while (auto file = m_block_file_cache.Get(type, pos.nFile, path,
+                                              min_size)) {
+        const Span<const uint8_t> data{file->GetData()};
+        try {
+            SpanReader reader{
+                data.first(std::min(data.size(), data_size)).subspan(pos.nPos)};
+            read(reader);
+            return true;
+        } catch (const std::exception &) {
+            // The data might go past the end of the mapping if the file grew
+            // since it was mapped. Try again with a larger mapping, if any.
+            if (data.size() >= data_size) {
+                return false;
+            }
+            min_size = data.size() + 1;
+        }
+    }
+
+    return false;
+}
+
 bool BlockManager::ReadBlockUndo(CBlockUndo &blockundo,
                                  const CBlockIndex &index) const {
     const FlatFilePos pos{WITH_LOCK(::cs_main, return index.GetUndoPos())};
@@ -562,29 +894,38 @@ bool BlockManager::ReadBlockUndo(CBlockUndo &blockundo,
         return false;
     }
 
-    // Open history file to read
-    AutoFile filein{OpenUndoFile(pos, true)};
-    if (filein.IsNull()) {
-        LogError("OpenUndoFile failed for %s\n", pos.ToString());
-        return false;
-    }
-
-    // Read block
     uint256 hashChecksum;
-    // Use HashVerifier as reserializing may lose data
-    // c.f. commit 80df982ab2f63e60edc1033d1ef8929c837d00c5
-    HashVerifier verifier{filein};
-    try {
+    uint256 hashComputed;
+    const auto read_undo = [&](auto &filein) {
+        // Use HashVerifier as reserializing may lose data
+        // c.f. commit 80df982ab2f63e60edc1033d1ef8929c837d00c5
+        HashVerifier verifier{filein};
         verifier << index.pprev->GetBlockHash();
         verifier >> blockundo;
         filein >> hashChecksum;
-    } catch (const std::exception &e) {
-        LogError("%s: Deserialize or I/O error - %s\n", __func__, e.what());
-        return false;
+        hashComputed = verifier.GetHash();
+    };
+
+    if (!ReadFromMappedFile(BlockFileCache::FileType::UNDO, pos, read_undo)) {
+        // Open history file to read
+        AutoFile filein{OpenUndoFile(pos, true)};
+        if (filein.IsNull()) {
+            LogError("OpenUndoFile failed for %s\n", pos.ToString());
+            return false;
+        }
+
+        // Read block
+        try {
+            read_undo(filein);
+        } catch (const std::exception &e) {
+            LogError("%s: Deserialize or I/O error - %s\n", __func__,
+                     e.what());
+            return false;
+        }
     }
 
     // Verify checksum
-    if (hashChecksum != verifier.GetHash()) {
+    if (hashChecksum != hashComputed) {
         LogError("%s: Checksum mismatch\n", __func__);
         return false;
     }
@@ -595,7 +936,15 @@ bool BlockManager::ReadBlockUndo(CBlockUndo &blockundo,
 bool BlockManager::FlushUndoFile(int block_file, bool finalize) {
     FlatFilePos undo_pos_old(block_file,
                              m_blockfile_info[block_file].nUndoSize);
-    if (!UndoFileSeq().Flush(undo_pos_old, finalize)) {
+    // The queued writes must be done before the file is synced or truncated.
+    const bool success{m_block_file_writer.Flush() &&
+                       UndoFileSeq().Flush(undo_pos_old, finalize)};
+    if (finalize) {
+        // The file got truncated to its actual size.
+        m_block_file_cache.Invalidate(BlockFileCache::FileType::UNDO,
+                                      block_file);
+    }
+    if (!success) {
         m_opts.notifications.flushError(
             "Flushing undo file to disk failed. This is likely the "
             "result of an I/O error.");
@@ -621,12 +970,19 @@ bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize,
 
     FlatFilePos block_pos_old(blockfile_num,
                               m_blockfile_info[blockfile_num].nSize);
-    if (!BlockFileSeq().Flush(block_pos_old, fFinalize)) {
+    // The queued writes must be done before the file is synced or truncated.
+    if (!m_block_file_writer.Flush() ||
+        !BlockFileSeq().Flush(block_pos_old, fFinalize)) {
         m_opts.notifications.flushError(
             "Flushing block file to disk failed. This is likely the "
             "result of an I/O error.");
         success = false;
     }
+    if (fFinalize) {
+        // The file got truncated to its actual size.
+        m_block_file_cache.Invalidate(BlockFileCache::FileType::BLOCK,
+                                      blockfile_num);
+    }
     // we do not always flush the undo file, as the chain tip may be lagging
     // behind the incoming blocks,
     // e.g. during IBD or a sync after a node going offline
@@ -676,10 +1032,15 @@ void BlockManager::UnlinkPrunedFiles(
     std::error_code error_code;
     for (const int i : setFilesToPrune) {
         FlatFilePos pos(i, 0);
+        m_block_file_writer.WaitForFile(BlockFileCache::FileType::BLOCK, i);
+        m_block_file_writer.WaitForFile(BlockFileCache::FileType::UNDO, i);
         const bool removed_blockfile{
             fs::remove(BlockFileSeq().FileName(pos), error_code)};
         const bool removed_undofile{
             fs::remove(UndoFileSeq().FileName(pos), error_code)};
+        // Don't keep the space of the removed files in use.
+        m_block_file_cache.Invalidate(BlockFileCache::FileType::BLOCK, i);
+        m_block_file_cache.Invalidate(BlockFileCache::FileType::UNDO, i);
         if (removed_blockfile || removed_undofile) {
             LogPrint(BCLog::BLOCKSTORE, "Prune: %s deleted blk/rev (%05u)\n",
                      __func__, i);
@@ -699,12 +1060,14 @@ FlatFileSeq BlockManager::UndoFileSeq() const {
 
 AutoFile BlockManager::OpenBlockFile(const FlatFilePos &pos,
                                      bool fReadOnly) const {
+    m_block_file_writer.WaitForFile(BlockFileCache::FileType::BLOCK, pos.nFile);
     return AutoFile{BlockFileSeq().Open(pos, fReadOnly)};
 }
 
 /** Open an undo file (rev?????.dat) */
 AutoFile BlockManager::OpenUndoFile(const FlatFilePos &pos,
                                     bool fReadOnly) const {
+    m_block_file_writer.WaitForFile(BlockFileCache::FileType::UNDO, pos.nFile);
     return AutoFile{UndoFileSeq().Open(pos, fReadOnly)};
 }
 
@@ -884,25 +1247,23 @@ bool BlockManager::WriteBlockUndo(const CBlockUndo &blockundo,
             LogError("FindUndoPos failed\n");
             return false;
         }
-        // Open history file to append
-        AutoFile fileout{OpenUndoFile(pos)};
-        if (fileout.IsNull()) {
-            LogError("OpenUndoFile failed\n");
+        // calculate checksum
+        HashWriter hasher{};
+        hasher << block.pprev->GetBlockHash();
+        hasher << blockundo;
+
+        // Queue the index header, the undo data and the checksum
+        std::vector<uint8_t> data;
+        data.reserve(blockundo_size + UNDO_DATA_DISK_OVERHEAD);
+        VectorWriter{data, 0, GetParams().DiskMagic(), blockundo_size,
+                     blockundo, hasher.GetHash()};
+        if (!m_block_file_writer.Write(BlockFileCache::FileType::UNDO, pos,
+                                       std::move(data))) {
+            LogError("Failed to write undo data\n");
             return FatalError(m_opts.notifications, state,
                               "Failed to write undo data");
         }
-        // Write index header
-        fileout << GetParams().DiskMagic() << blockundo_size;
-
-        // Write undo data
         pos.nPos += BLOCK_SERIALIZATION_HEADER_SIZE;
-        fileout << blockundo;
-
-        // calculate & write checksum
-        HashWriter hasher{};
-        hasher << block.pprev->GetBlockHash();
-        hasher << blockundo;
-        fileout << hasher.GetHash();
 
         // rev files are written in block height order, whereas blk files are
         // written as blocks come in (often out of order) we want to flush the
@@ -939,20 +1300,25 @@ bool BlockManager::WriteBlockUndo(const CBlockUndo &blockundo,
 bool BlockManager::ReadBlock(CBlock &block, const FlatFilePos &pos) const {
     block.SetNull();
 
-    // Open history file to read
-    AutoFile filein{OpenBlockFile(pos, true)};
-    if (filein.IsNull()) {
-        LogError("ReadBlock: OpenBlockFile failed for %s\n", pos.ToString());
-        return false;
-    }
+    const auto read_block = [&](auto &filein) { filein >> block; };
+    if (!ReadFromMappedFile(BlockFileCache::FileType::BLOCK, pos,
+                            read_block)) {
+        // Open history file to read
+        AutoFile filein{OpenBlockFile(pos, true)};
+        if (filein.IsNull()) {
+            LogError("ReadBlock: OpenBlockFile failed for %s\n",
+                     pos.ToString());
+            return false;
+        }
 
-    // Read block
-    try {
-        filein >> block;
-    } catch (const std::exception &e) {
-        LogError("%s: Deserialize or I/O error - %s at %s\n", __func__,
-                 e.what(), pos.ToString());
-        return false;
+        // Read block
+        try {
+            read_block(filein);
+        } catch (const std::exception &e) {
+            LogError("%s: Deserialize or I/O error - %s at %s\n", __func__,
+                     e.what(), pos.ToString());
+            return false;
+        }
     }
 
     // Check the header
@@ -1031,6 +1397,11 @@ bool BlockManager::ReadRawBlock(std::vector<uint8_t> &block,
 
 bool BlockManager::ReadTxFromDisk(CMutableTransaction &tx,
                                   const FlatFilePos &pos) const {
+    if (ReadFromMappedFile(BlockFileCache::FileType::BLOCK, pos,
+                           [&](auto &filein) { filein >> tx; })) {
+        return true;
+    }
+
     // Open history file to read
     AutoFile filein{OpenBlockFile(pos, true)};
     if (filein.IsNull()) {
@@ -1053,6 +1424,11 @@ bool BlockManager::ReadTxFromDisk(CMutableTransaction &tx,
 
 bool BlockManager::ReadTxUndoFromDisk(CTxUndo &tx_undo,
                                       const FlatFilePos &pos) const {
+    if (ReadFromMappedFile(BlockFileCache::FileType::UNDO, pos,
+                           [&](auto &filein) { filein >> tx_undo; })) {
+        return true;
+    }
+
     // Open undo file to read
     AutoFile filein{
         OpenUndoFile(pos, true),
@@ -1085,18 +1461,18 @@ FlatFilePos BlockManager::WriteBlock(const CBlock &block, int nHeight) {
         LogError("FindNextBlockPos failed\n");
         return FlatFilePos();
     }
-    AutoFile fileout{OpenBlockFile(pos)};
-    if (fileout.IsNull()) {
-        LogError("OpenBlockFile failed\n");
+
+    // Queue the index header and the block
+    std::vector<uint8_t> data;
+    data.reserve(block_size + BLOCK_SERIALIZATION_HEADER_SIZE);
+    VectorWriter{data, 0, GetParams().DiskMagic(), block_size, block};
+    if (!m_block_file_writer.Write(BlockFileCache::FileType::BLOCK, pos,
+                                   std::move(data))) {
+        LogError("Failed to write block\n");
         m_opts.notifications.fatalError("Failed to write block");
         return FlatFilePos();
     }
-
-    // Write index header
-    fileout << GetParams().DiskMagic() << block_size;
-    // Write block
     pos.nPos += BLOCK_SERIALIZATION_HEADER_SIZE;
-    fileout << block;
     return pos;
 }
 
@@ -18,6 +18,10 @@
 #include <kernel/blockmanager_opts.h>
 #include <kernel/chain.h>
 #include <kernel/cs_main.h>
+#include <node/blockfilecache.h>
+#include <node/blockfilewriter.h>
+#include <node/blockmap.h>
+#include <node/sharedblockreader.h>
 #include <protocol.h>
 #include <sync.h>
 #include <txdb.h>
@@ -67,12 +71,6 @@ static constexpr size_t UNDO_DATA_DISK_OVERHEAD{
 
 extern std::atomic_bool fReindex;
 
-// Because validation code takes pointers to the map's CBlockIndex objects, if
-// we ever switch to another associative container, we need to either use a
-// container that has stable addressing (true of all std associative
-// containers), or make the key a `std::unique_ptr<CBlockIndex>`
-using BlockMap = std::unordered_map<BlockHash, CBlockIndex, BlockHasher>;
-
 struct PruneLockInfo {
     //! Height of earliest block that should be kept and not pruned
     int height_first{std::numeric_limits<int>::max()};
@@ -130,6 +128,16 @@ private:
     bool LoadBlockIndex(const std::optional<BlockHash> &snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Load the block index from the flat file written by
+     * WriteFlatBlockIndex(), if it is a copy of the block tree database.
+     * On success the entries are sorted by height into sorted, and their
+     * nChainWork is set. Return false and leave the block index empty
+     * otherwise, so it can be loaded from the database.
+     */
+    bool LoadFlatBlockIndex(std::vector<CBlockIndex *> &sorted)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     /** Return false if block file or undo file flushing fails. */
     [[nodiscard]] bool FlushBlockFile(int blockfile_num, bool fFinalize,
                                       bool finalize_undo);
@@ -160,6 +168,20 @@ private:
 
     AutoFile OpenUndoFile(const FlatFilePos &pos, bool fReadOnly = false) const;
 
+    /** Memory mappings of the block and undo files, for the reads. */
+    mutable BlockFileCache m_block_file_cache;
+
+    /**
+     * Deserialize from a block or undo file through its memory mapping.
+     * Only the data written to the file is read, never the preallocated space
+     * past it. Return false if the file can't be mapped or the data can't be
+     * read from it, in which case the caller reads the file the regular way,
+     * which reports the errors.
+     */
+    template <typename Read>
+    bool ReadFromMappedFile(BlockFileCache::FileType type,
+                            const FlatFilePos &pos, Read &&read) const;
+
     /**
      * Calculate the block/rev files to delete based on height specified
      * by user with RPC command pruneblockchain
@@ -194,7 +216,7 @@ private:
     void FindFilesToPrune(std::set<int> &setFilesToPrune, int last_prune,
                           const Chainstate &chain, ChainstateManager &chainman);
 
-    RecursiveMutex cs_LastBlockFile;
+    mutable RecursiveMutex cs_LastBlockFile;
     std::vector<CBlockFileInfo> m_blockfile_info;
 
     //! Since assumedvalid chainstates may be syncing a range of the chain that
@@ -222,6 +244,12 @@ private:
         return std::max(normal.file_num, assumed.file_num);
     }
 
+    /**
+     * Whether the block index was loaded from the database, so the flat block
+     * index written from it is a copy of the database.
+     */
+    bool m_block_index_loaded GUARDED_BY(::cs_main){false};
+
     /**
      * Global flag to indicate we should check to see if there are
      * block/undo files that should be deleted.  Set on startup
@@ -251,11 +279,23 @@ private:
 
     const kernel::BlockManagerOpts m_opts;
 
+    /**
+     * Writes the block and undo data. The positions are allocated before the
+     * data is queued, and the reads wait for the pending writes to the file.
+     */
+    BlockFileWriter m_block_file_writer;
+
 public:
     using Options = kernel::BlockManagerOpts;
 
     explicit BlockManager(const util::SignalInterrupt &interrupt, Options opts)
         : m_prune_mode{opts.prune_target > 0}, m_opts{std::move(opts)},
+          m_block_file_writer{
+              BlockFileSeq(), UndoFileSeq(),
+              m_opts.async_block_writes ? DEFAULT_BLOCK_WRITE_QUEUE_SIZE : 0,
+              [this](const std::string &message) {
+                  m_opts.notifications.fatalError(message);
+              }},
           m_interrupt{interrupt} {};
 
     const util::SignalInterrupt &m_interrupt;
@@ -289,7 +329,23 @@ public:
 
     std::unique_ptr<CBlockTreeDB> m_block_tree_db GUARDED_BY(::cs_main);
 
-    void WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    /**
+     * Write the dirty block index entries and block file info to the
+     * database. This is refused once a block or undo write failed, since the
+     * entries may refer to data that is not on disk.
+     */
+    bool WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    /**
+     * Write a copy of the block index as fixed size records, which is much
+     * faster to load than the database at the next startup. This must be
+     * called after the block index is flushed, since the file is only used
+     * if nothing was written to the database after it, and only once the block
+     * index was loaded from the database.
+     */
+    bool WriteFlatBlockIndex() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    fs::path GetFlatBlockIndexPath() const {
+        return m_opts.blocks_dir / "index.flat";
+    }
     bool LoadBlockIndexDB(const std::optional<BlockHash> &snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
@@ -300,7 +356,9 @@ public:
      */
     void ScanAndUnlinkAlreadyPrunedFiles() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    /** Add a header to the block index. hash must be block.GetHash(). */
     CBlockIndex *AddToBlockIndex(const CBlockHeader &block,
+                                 const BlockHash &hash,
                                  CBlockIndex *&best_header)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     /** Create a new block index entry for a given block hash */
@@ -436,6 +494,12 @@ public:
                       const FlatFilePos &pos) const;
     bool ReadBlockUndo(CBlockUndo &blockundo, const CBlockIndex &index) const;
 
+    /**
+     * Used by the consumers that go through the chain in order, so the blocks
+     * are read only once when several of them are catching up together.
+     */
+    mutable SharedBlockReader m_shared_block_reader{*this};
+
     /** Functions for disk access for txs */
     bool ReadTxFromDisk(CMutableTransaction &tx, const FlatFilePos &pos) const;
     bool ReadTxUndoFromDisk(CTxUndo &tx, const FlatFilePos &pos) const;
@@ -29,7 +29,8 @@ static ChainstateLoadResult CompleteChainstateInitialization(
                  .cache_bytes = cache_sizes.block_tree_db,
                  .memory_only = options.block_tree_db_in_memory,
                  .wipe_data = options.reindex,
-                 .options = chainman.m_options.block_tree_db});
+                 .options = chainman.m_options.block_tree_db,
+                 .tuning = DBTuning::ForBlockIndex()});
 
     if (options.reindex) {
         pblocktree->WriteReindexing(true);
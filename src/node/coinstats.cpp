@@ -17,7 +17,8 @@ std::optional<kernel::CCoinsStats>
 GetUTXOStats(CCoinsView *view, BlockManager &blockman,
              kernel::CoinStatsHashType hash_type,
              const std::function<void()> &interruption_point,
-             const CBlockIndex *pindex, bool index_requested) {
+             const CBlockIndex *pindex, bool index_requested,
+             int worker_threads_num) {
     // Use CoinStatsIndex if it is requested and available and a hash_type of
     // Muhash or None was requested
     if ((hash_type == kernel::CoinStatsHashType::MUHASH ||
@@ -40,6 +41,6 @@ GetUTXOStats(CCoinsView *view, BlockManager &blockman,
     assert(!pindex || pindex->GetBlockHash() == view->GetBestBlock());
 
     return kernel::ComputeUTXOStats(hash_type, view, blockman,
-                                    interruption_point);
+                                    interruption_point, worker_threads_num);
 }
 } // namespace node
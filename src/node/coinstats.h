@@ -30,12 +30,15 @@ namespace node {
  *
  * @param[in] index_requested Signals if the coinstatsindex should be used (when
  * available).
+ * @param[in] worker_threads_num Number of additional threads computing the
+ * statistics when the index is not used, see kernel::ComputeUTXOStats.
  */
 std::optional<kernel::CCoinsStats>
 GetUTXOStats(CCoinsView *view, node::BlockManager &blockman,
              kernel::CoinStatsHashType hash_type,
              const std::function<void()> &interruption_point = {},
-             const CBlockIndex *pindex = nullptr, bool index_requested = true);
+             const CBlockIndex *pindex = nullptr, bool index_requested = true,
+             int worker_threads_num = 0);
 } // namespace node
 
 #endif // BITCOIN_NODE_COINSTATS_H
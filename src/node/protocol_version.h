@@ -8,7 +8,7 @@
 /**
  * network protocol versioning
  */
-static const int PROTOCOL_VERSION = 70017;
+static const int PROTOCOL_VERSION = 70018;
 
 //! initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 209;
@@ -43,4 +43,8 @@ static const int PEER_ENTROPY_VERSION = 70016;
 //! Avalanche can poll up to 1024 items per message starting with this version
 static const int AVALANCHE_MAX_ELEMENT_BUMP_VERSION = 70017;
 
+//! Avalanche polls and responses use the compact encoding starting with this
+//! version
+static const int AVALANCHE_COMPACT_POLL_VERSION = 70018;
+
 #endif // BITCOIN_NODE_PROTOCOL_VERSION_H
@@ -0,0 +1,215 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/sharedblockreader.h>
+
+#include <blockindex.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <serialize.h>
+#include <undo.h>
+
+#include <algorithm>
+#include <optional>
+
+namespace node {
+
+using Clock = std::chrono::steady_clock;
+
+SharedBlockReader::Cursor::Cursor(SharedBlockReader &reader)
+    : m_reader(reader) {
+    LOCK(m_reader.m_mutex);
+    m_reader.m_cursors[this].last_active = Clock::now();
+}
+
+SharedBlockReader::Cursor::~Cursor() {
+    {
+        LOCK(m_reader.m_mutex);
+        m_reader.m_cursors.erase(this);
+        m_reader.Evict(Clock::now());
+    }
+    m_reader.m_cv.notify_all();
+}
+
+void SharedBlockReader::Cursor::SetHeight(int height) {
+    {
+        LOCK(m_reader.m_mutex);
+        const auto now = Clock::now();
+        CursorState &state = m_reader.m_cursors.at(this);
+        state.height = height;
+        state.last_active = now;
+        m_reader.Evict(now);
+    }
+    m_reader.m_cv.notify_all();
+}
+
+std::shared_ptr<const CBlock>
+SharedBlockReader::Cursor::ReadBlock(const CBlockIndex &index) {
+    return m_reader.Read<CBlock>(
+        *this, index, &Entry::block, &Entry::reading_block,
+        [&](CBlock &block) -> std::optional<size_t> {
+            if (!m_reader.m_blockman.ReadBlock(block, index)) {
+                return std::nullopt;
+            }
+            return index.nSize;
+        });
+}
+
+std::shared_ptr<const CBlockUndo>
+SharedBlockReader::Cursor::ReadBlockUndo(const CBlockIndex &index) {
+    return m_reader.Read<CBlockUndo>(
+        *this, index, &Entry::undo, &Entry::reading_undo,
+        [&](CBlockUndo &undo) -> std::optional<size_t> {
+            // There is no undo data for the genesis block.
+            if (index.nHeight > 0 &&
+                !m_reader.m_blockman.ReadBlockUndo(undo, index)) {
+                return std::nullopt;
+            }
+            return GetSerializeSize(undo);
+        });
+}
+
+size_t SharedBlockReader::GetCacheSize() const {
+    LOCK(m_mutex);
+    return m_cache_size;
+}
+
+size_t SharedBlockReader::GetCacheCount() const {
+    LOCK(m_mutex);
+    return m_entries.size();
+}
+
+static bool IsActive(const Clock::time_point &last_active,
+                     const Clock::time_point &now) {
+    return now - last_active < SharedBlockReader::CURSOR_IDLE_TIMEOUT;
+}
+
+bool SharedBlockReader::IsNeededByOthers(const Cursor &cursor, int height,
+                                         Clock::time_point now) const {
+    AssertLockHeld(m_mutex);
+
+    for (const auto &[other, state] : m_cursors) {
+        if (other != &cursor && state.height <= height &&
+            IsActive(state.last_active, now)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int SharedBlockReader::GetMinActiveHeight(Clock::time_point now) const {
+    AssertLockHeld(m_mutex);
+
+    int min_height = std::numeric_limits<int>::max();
+    for (const auto &[cursor, state] : m_cursors) {
+        if (IsActive(state.last_active, now)) {
+            min_height = std::min(min_height, state.height);
+        }
+    }
+    return min_height;
+}
+
+void SharedBlockReader::Evict(Clock::time_point now) {
+    AssertLockHeld(m_mutex);
+
+    const int min_height = GetMinActiveHeight(now);
+    auto it = m_entries.begin();
+    while (it != m_entries.end() && it->first.first < min_height) {
+        m_cache_size -= it->second->size;
+        it = m_entries.erase(it);
+    }
+}
+
+bool SharedBlockReader::HasRoom(const Cursor &cursor,
+                                Clock::time_point now) const {
+    AssertLockHeld(m_mutex);
+
+    if (m_cache_size < m_max_cache_size) {
+        return true;
+    }
+
+    const auto it = m_cursors.find(&cursor);
+    return it == m_cursors.end() ||
+           it->second.height <= GetMinActiveHeight(now);
+}
+
+template <typename T, typename ReadFn>
+std::shared_ptr<const T>
+SharedBlockReader::Read(const Cursor &cursor, const CBlockIndex &index,
+                        std::shared_ptr<const T> Entry::*member,
+                        bool Entry::*reading, ReadFn read_fn) {
+    const EntryKey key{index.nHeight, &index};
+
+    // The entry this cursor is in charge of reading, if the data is worth
+    // keeping for the other cursors.
+    std::shared_ptr<Entry> entry;
+    {
+        WAIT_LOCK(m_mutex, lock);
+        while (true) {
+            const auto now = Clock::now();
+            m_cursors.at(&cursor).last_active = now;
+
+            if (auto it = m_entries.find(key); it != m_entries.end()) {
+                Entry &existing = *it->second;
+                if (existing.*member) {
+                    return existing.*member;
+                }
+                if (existing.*reading) {
+                    // Another cursor is reading it already.
+                    m_cv.wait_for(lock, std::chrono::seconds{1});
+                    continue;
+                }
+                entry = it->second;
+                break;
+            }
+
+            if (!IsNeededByOthers(cursor, index.nHeight, now)) {
+                break;
+            }
+
+            if (!HasRoom(cursor, now)) {
+                // Let the other cursors catch up. This is bounded since they
+                // either move forward or become idle.
+                m_cv.wait_for(lock, std::chrono::seconds{1});
+                continue;
+            }
+
+            entry = std::make_shared<Entry>();
+            m_entries.emplace(key, entry);
+            break;
+        }
+
+        if (entry) {
+            (*entry).*reading = true;
+        }
+    }
+
+    auto data = std::make_shared<T>();
+    const std::optional<size_t> size = read_fn(*data);
+
+    if (entry) {
+        {
+            LOCK(m_mutex);
+            (*entry).*reading = false;
+            // The entry might have been evicted while reading, in which case
+            // there is nothing to account for.
+            if (size) {
+                auto it = m_entries.find(key);
+                if (it != m_entries.end() && it->second == entry) {
+                    (*entry).*member = data;
+                    entry->size += *size;
+                    m_cache_size += *size;
+                }
+            }
+        }
+        m_cv.notify_all();
+    }
+
+    if (!size) {
+        return nullptr;
+    }
+    return data;
+}
+
+} // namespace node
@@ -0,0 +1,143 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_SHAREDBLOCKREADER_H
+#define BITCOIN_NODE_SHAREDBLOCKREADER_H
+
+#include <sync.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <utility>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+
+namespace node {
+
+class BlockManager;
+
+/** Default memory budget for the blocks shared between the cursors. */
+static constexpr size_t DEFAULT_SHARED_BLOCK_CACHE_SIZE{256 << 20};
+
+/**
+ * Read the blocks and their undo data once for all the consumers that go
+ * through the chain at the same time, such as the indexes and Chronik catching
+ * up with the chain.
+ *
+ * Each consumer gets its own Cursor, and tells it the lowest height it may
+ * still read. A block read through a cursor is kept in memory as long as
+ * another active cursor is behind it, and is handed out to that cursor instead
+ * of being read again.
+ *
+ * The memory is bounded: a cursor that is ahead of the others waits for them
+ * to catch up before reading more blocks. Cursors that didn't read anything
+ * for CURSOR_IDLE_TIMEOUT are not waited for, so a stalled consumer doesn't
+ * hold back the others. They get their blocks from disk if they have been
+ * evicted in the meantime.
+ */
+class SharedBlockReader {
+public:
+    static constexpr std::chrono::seconds CURSOR_IDLE_TIMEOUT{5};
+
+    class Cursor {
+        SharedBlockReader &m_reader;
+
+        friend class SharedBlockReader;
+
+    public:
+        explicit Cursor(SharedBlockReader &reader);
+        ~Cursor();
+
+        Cursor(const Cursor &) = delete;
+        Cursor &operator=(const Cursor &) = delete;
+
+        /**
+         * The consumer won't read any block below this height anymore, so
+         * they can be dropped unless some other cursor needs them.
+         */
+        void SetHeight(int height);
+
+        /**
+         * Return the block, or nullptr if it can't be read. The genesis block
+         * has empty undo data.
+         */
+        std::shared_ptr<const CBlock> ReadBlock(const CBlockIndex &index);
+        std::shared_ptr<const CBlockUndo>
+        ReadBlockUndo(const CBlockIndex &index);
+    };
+
+    explicit SharedBlockReader(
+        const BlockManager &blockman,
+        size_t max_cache_size = DEFAULT_SHARED_BLOCK_CACHE_SIZE)
+        : m_blockman(blockman), m_max_cache_size(max_cache_size) {}
+
+    SharedBlockReader(const SharedBlockReader &) = delete;
+    SharedBlockReader &operator=(const SharedBlockReader &) = delete;
+
+    /** For testing. */
+    size_t GetCacheSize() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    size_t GetCacheCount() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    const BlockManager &m_blockman;
+    const size_t m_max_cache_size;
+
+    struct CursorState {
+        /** No block is kept for the cursor until it sets its height. */
+        int height{std::numeric_limits<int>::max()};
+        std::chrono::steady_clock::time_point last_active;
+    };
+
+    struct Entry {
+        std::shared_ptr<const CBlock> block;
+        std::shared_ptr<const CBlockUndo> undo;
+        bool reading_block{false};
+        bool reading_undo{false};
+        size_t size{0};
+    };
+
+    using EntryKey = std::pair<int, const CBlockIndex *>;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<const Cursor *, CursorState> m_cursors GUARDED_BY(m_mutex);
+    /** Ordered by height so the entries can be dropped from the bottom. */
+    std::map<EntryKey, std::shared_ptr<Entry>> m_entries GUARDED_BY(m_mutex);
+    size_t m_cache_size GUARDED_BY(m_mutex){0};
+
+    /** Whether an active cursor other than this one still needs height. */
+    bool IsNeededByOthers(const Cursor &cursor, int height,
+                          std::chrono::steady_clock::time_point now) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /** Lowest height among the active cursors. */
+    int GetMinActiveHeight(std::chrono::steady_clock::time_point now) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /** Drop the entries that no active cursor needs anymore. */
+    void Evict(std::chrono::steady_clock::time_point now)
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /**
+     * Whether the cursor can add one more entry. The cursor that holds back
+     * the others always can, so they are never stuck waiting for each other.
+     */
+    bool HasRoom(const Cursor &cursor,
+                 std::chrono::steady_clock::time_point now) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    template <typename T, typename ReadFn>
+    std::shared_ptr<const T> Read(const Cursor &cursor,
+                                  const CBlockIndex &index,
+                                  std::shared_ptr<const T> Entry::*member,
+                                  bool Entry::*reading, ReadFn read_fn);
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_SHAREDBLOCKREADER_H
@@ -1133,7 +1133,7 @@ static RPCHelpMan gettxoutsetinfo() {
 
             const std::optional<CCoinsStats> maybe_stats = GetUTXOStats(
                 coins_view, *blockman, hash_type, node.rpc_interruption_point,
-                pindex, index_requested);
+                pindex, index_requested, chainman.m_options.worker_threads_num);
             if (maybe_stats.has_value()) {
                 const CCoinsStats &stats = maybe_stats.value();
                 ret.pushKV("height", int64_t(stats.nHeight));
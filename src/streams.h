@@ -86,7 +86,7 @@ public:
      */
     SpanReader(Span<const uint8_t> data) : m_data(data) {}
 
-    template <typename T> SpanReader &operator>>(T &obj) {
+    template <typename T> SpanReader &operator>>(T &&obj) {
         ::Unserialize(*this, obj);
         return (*this);
     }
@@ -106,6 +106,13 @@ public:
         memcpy(dst.data(), m_data.data(), dst.size());
         m_data = m_data.subspan(dst.size());
     }
+
+    void ignore(size_t num_ignore) {
+        if (num_ignore > m_data.size()) {
+            throw std::ios_base::failure("SpanReader::ignore(): end of data");
+        }
+        m_data = m_data.subspan(num_ignore);
+    }
 };
 
 /**
@@ -154,6 +161,7 @@ public:
         vch.resize(n + m_read_pos, c);
     }
     void reserve(size_type n) { vch.reserve(n + m_read_pos); }
+    size_type capacity() const { return vch.capacity(); }
     const_reference operator[](size_type pos) const {
         return vch[pos + m_read_pos];
     }
@@ -4,10 +4,17 @@
 
 #include <chainparams.h>
 #include <clientversion.h>
+#include <flatfile.h>
+#include <node/blockfilecache.h>
+#include <node/blockfilewriter.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
+#include <node/sharedblockreader.h>
 #include <primitives/block.h>
+#include <shutdown.h>
+#include <streams.h>
+#include <undo.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
@@ -15,10 +22,17 @@
 #include <test/util/logging.h>
 #include <test/util/setup_common.h>
 
+#include <cstdio>
+#include <limits>
+#include <vector>
+
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
+using node::BlockFileCache;
+using node::BlockFileWriter;
 using node::BlockManager;
 using node::KernelNotifications;
 using node::MAX_BLOCKFILE_SIZE;
+using node::SharedBlockReader;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and
 // cleanup
@@ -154,6 +168,381 @@ BOOST_FIXTURE_TEST_CASE(blockmanager_block_data_availability,
     BOOST_CHECK(!blockman.CheckBlockDataAvailability(tip, *last_pruned_block));
 }
 
+BOOST_FIXTURE_TEST_CASE(shared_block_reader, TestChain100Setup) {
+    const CChain &chain = m_node.chainman->ActiveChain();
+    SharedBlockReader reader(m_node.chainman->m_blockman);
+
+    SharedBlockReader::Cursor leader(reader);
+    {
+        // A single cursor doesn't keep anything around.
+        leader.SetHeight(0);
+        const auto block = leader.ReadBlock(*chain.Genesis());
+        BOOST_REQUIRE(block);
+        BOOST_CHECK_EQUAL(block->GetHash(), chain.Genesis()->GetBlockHash());
+        const auto undo = leader.ReadBlockUndo(*chain.Genesis());
+        BOOST_REQUIRE(undo);
+        BOOST_CHECK(undo->vtxundo.empty());
+        BOOST_CHECK_EQUAL(reader.GetCacheCount(), 0);
+    }
+
+    SharedBlockReader::Cursor follower(reader);
+    follower.SetHeight(10);
+
+    // The blocks the follower still needs are kept for it, and only them.
+    std::vector<std::shared_ptr<const CBlock>> blocks;
+    std::vector<std::shared_ptr<const CBlockUndo>> undos;
+    for (int height = 1; height <= 20; height++) {
+        leader.SetHeight(height);
+        blocks.push_back(leader.ReadBlock(*chain[height]));
+        undos.push_back(leader.ReadBlockUndo(*chain[height]));
+        BOOST_REQUIRE(blocks.back() && undos.back());
+        BOOST_CHECK_EQUAL(blocks.back()->GetHash(),
+                          chain[height]->GetBlockHash());
+    }
+    BOOST_CHECK_EQUAL(reader.GetCacheCount(), 11);
+    BOOST_CHECK_GT(reader.GetCacheSize(), 0);
+
+    // The follower gets the very same data without reading it again.
+    for (int height = 10; height <= 15; height++) {
+        follower.SetHeight(height);
+        BOOST_CHECK(follower.ReadBlock(*chain[height]) == blocks[height - 1]);
+        BOOST_CHECK(follower.ReadBlockUndo(*chain[height]) ==
+                    undos[height - 1]);
+    }
+    // The blocks below the lowest cursor are dropped.
+    BOOST_CHECK_EQUAL(reader.GetCacheCount(), 6);
+
+    // Once all the cursors moved past them, nothing is kept anymore.
+    follower.SetHeight(21);
+    leader.SetHeight(21);
+    BOOST_CHECK_EQUAL(reader.GetCacheCount(), 0);
+    BOOST_CHECK_EQUAL(reader.GetCacheSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(block_file_cache) {
+    if (!BlockFileCache::IsSupported()) {
+        return;
+    }
+
+    const fs::path path{m_path_root / "blk00000.dat"};
+    const auto append = [&](const std::vector<uint8_t> &data) {
+        AutoFile file{fsbridge::fopen(path, "ab")};
+        file << Span{data};
+    };
+
+    BlockFileCache cache(/*max_files=*/2);
+    using FileType = BlockFileCache::FileType;
+
+    // Missing files can't be mapped.
+    BOOST_CHECK(!cache.Get(FileType::BLOCK, 0, path, 1));
+
+    append({1, 2, 3});
+    const auto file = cache.Get(FileType::BLOCK, 0, path, 1);
+    BOOST_REQUIRE(file);
+    BOOST_CHECK_EQUAL(file->GetData().size(), 3);
+    BOOST_CHECK_EQUAL(file->GetData()[2], 3);
+    BOOST_CHECK(cache.Get(FileType::BLOCK, 0, path, 3) == file);
+    BOOST_CHECK(!cache.Get(FileType::BLOCK, 0, path, 4));
+
+    // The file is mapped again once it grew.
+    append({4, 5});
+    const auto grown = cache.Get(FileType::BLOCK, 0, path, 4);
+    BOOST_REQUIRE(grown);
+    BOOST_CHECK(grown != file);
+    BOOST_CHECK_EQUAL(grown->GetData().size(), 5);
+    BOOST_CHECK_EQUAL(grown->GetData()[4], 5);
+    // The old mapping remains usable.
+    BOOST_CHECK_EQUAL(file->GetData()[0], 1);
+
+    // The least recently used file is unmapped first.
+    BOOST_CHECK(cache.Get(FileType::UNDO, 0, path, 1));
+    BOOST_CHECK(cache.Get(FileType::BLOCK, 0, path, 1) == grown);
+    BOOST_CHECK(cache.Get(FileType::BLOCK, 1, path, 1));
+    BOOST_CHECK(cache.Get(FileType::BLOCK, 0, path, 1) == grown);
+
+    cache.Invalidate(FileType::BLOCK, 0);
+    BOOST_CHECK(cache.Get(FileType::BLOCK, 0, path, 1) != grown);
+}
+
+BOOST_AUTO_TEST_CASE(block_file_writer) {
+    using FileType = BlockFileWriter::FileType;
+    const auto read_file = [&](const fs::path &path) {
+        std::vector<uint8_t> data(fs::file_size(path));
+        AutoFile file{fsbridge::fopen(path, "rb")};
+        file >> Span{data};
+        return data;
+    };
+
+    // Both the asynchronous and synchronous writes, with a queue smaller than
+    // some of the writes.
+    for (const size_t queue_size : {size_t{4}, size_t{0}}) {
+        const fs::path dir{m_path_root / strprintf("writer%d", queue_size)};
+        std::vector<std::string> errors;
+        BlockFileWriter writer{FlatFileSeq{dir, "blk", 1 << 10},
+                               FlatFileSeq{dir, "rev", 1 << 10}, queue_size,
+                               [&](const std::string &error) {
+                                   errors.push_back(error);
+                               }};
+
+        // The writes can be queued out of order, and with gaps.
+        BOOST_CHECK(writer.Write(FileType::BLOCK, {0, 3}, {4, 5}));
+        BOOST_CHECK(writer.Write(FileType::BLOCK, {0, 0}, {1, 2, 3}));
+        BOOST_CHECK(writer.Write(FileType::UNDO, {0, 2}, {7, 8, 9, 10, 11}));
+        BOOST_CHECK(writer.Write(FileType::BLOCK, {1, 0}, {6}));
+        writer.WaitForFile(FileType::BLOCK, 0);
+        BOOST_CHECK(read_file(dir / "blk00000.dat") ==
+                    std::vector<uint8_t>({1, 2, 3, 4, 5}));
+
+        BOOST_CHECK(writer.Flush());
+        BOOST_CHECK(read_file(dir / "blk00001.dat") ==
+                    std::vector<uint8_t>({6}));
+        BOOST_CHECK(read_file(dir / "rev00000.dat") ==
+                    std::vector<uint8_t>({0, 0, 7, 8, 9, 10, 11}));
+
+        // The asynchronous failures are reported by Flush() and the callback.
+        fs::create_directories(dir / "blk00002.dat");
+        const bool written{
+            writer.Write(FileType::BLOCK, {2, 0}, {1, 2, 3})};
+        BOOST_CHECK_EQUAL(written, queue_size > 0);
+        BOOST_CHECK_EQUAL(writer.Flush(), queue_size == 0);
+        BOOST_CHECK_EQUAL(errors.size(), queue_size > 0 ? 1 : 0);
+
+        // Nothing more is written after an asynchronous failure.
+        BOOST_CHECK_EQUAL(writer.HasFailed(), queue_size > 0);
+        BOOST_CHECK_EQUAL(writer.Write(FileType::BLOCK, {1, 1}, {7}),
+                          queue_size == 0);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_mapped_reads, TestChain100Setup) {
+    const CChain &chain = m_node.chainman->ActiveChain();
+    const BlockManager &blockman = m_node.chainman->m_blockman;
+
+    // The mapped reads return the same data as the regular file reads.
+    const BlockManager::Options opts{
+        .chainparams = Params(),
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = *m_node.notifications,
+        .use_mmap = false,
+    };
+    BlockManager unmapped{m_node.kernel->interrupt, opts};
+
+    for (int height = 1; height <= chain.Height(); height++) {
+        const CBlockIndex &index = *chain[height];
+        CBlock block;
+        CBlock unmapped_block;
+        BOOST_CHECK(blockman.ReadBlock(block, index));
+        BOOST_CHECK(unmapped.ReadBlock(unmapped_block, index));
+        BOOST_CHECK_EQUAL(block.GetHash(), index.GetBlockHash());
+        BOOST_CHECK_EQUAL(block.vtx.size(), unmapped_block.vtx.size());
+
+        CBlockUndo undo;
+        CBlockUndo unmapped_undo;
+        BOOST_CHECK(blockman.ReadBlockUndo(undo, index));
+        BOOST_CHECK(unmapped.ReadBlockUndo(unmapped_undo, index));
+        BOOST_CHECK_EQUAL(GetSerializeSize(undo),
+                          GetSerializeSize(unmapped_undo));
+    }
+
+    // Positions past the end of the data fail the same way.
+    CBlock block;
+    const FlatFilePos pos{0, std::numeric_limits<uint32_t>::max() / 2};
+    BOOST_CHECK(!blockman.ReadBlock(block, pos));
+
+    // The preallocated space past the data is not read, even if it is mapped.
+    const unsigned int data_size{
+        m_node.chainman->m_blockman.GetBlockFileInfo(0)->nSize};
+    BOOST_CHECK_LT(data_size, fs::file_size(blockman.GetBlockPosFilename(
+                                  {0, 0})));
+    BOOST_CHECK(!blockman.ReadBlock(block, FlatFilePos{0, data_size}));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_flat_block_index, TestChain100Setup) {
+    LOCK(cs_main);
+    BlockManager &blockman = m_node.chainman->m_blockman;
+    m_node.chainman->ActiveChainstate().ForceFlushStateToDisk();
+
+    const BlockManager::Options opts{
+        .chainparams = Params(),
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = *m_node.notifications,
+    };
+    // Load the block index of blockman into another block manager, and check
+    // it matches.
+    const auto check_load = [&](const std::string &expected_log) {
+        BlockManager loaded{m_node.kernel->interrupt, opts};
+        loaded.m_block_tree_db = std::move(blockman.m_block_tree_db);
+        {
+            ASSERT_DEBUG_LOG(expected_log);
+            BOOST_CHECK(loaded.LoadBlockIndexDB({}));
+        }
+        blockman.m_block_tree_db = std::move(loaded.m_block_tree_db);
+
+        BOOST_CHECK_EQUAL(loaded.m_block_index.size(),
+                          blockman.m_block_index.size());
+        for (const auto &[hash, index] : blockman.m_block_index) {
+            const CBlockIndex *pindex = loaded.LookupBlockIndex(hash);
+            BOOST_REQUIRE(pindex);
+            BOOST_CHECK_EQUAL(pindex->nHeight, index.nHeight);
+            BOOST_CHECK_EQUAL(pindex->pprev ? pindex->pprev->GetBlockHash()
+                                            : BlockHash{},
+                              index.pprev ? index.pprev->GetBlockHash()
+                                          : BlockHash{});
+            BOOST_CHECK(pindex->nStatus == index.nStatus);
+            BOOST_CHECK_EQUAL(pindex->nFile, index.nFile);
+            BOOST_CHECK_EQUAL(pindex->nDataPos, index.nDataPos);
+            BOOST_CHECK_EQUAL(pindex->nUndoPos, index.nUndoPos);
+            BOOST_CHECK_EQUAL(pindex->nTx, index.nTx);
+            BOOST_CHECK_EQUAL(pindex->nSize, index.nSize);
+            BOOST_CHECK(pindex->GetBlockHeader().GetHash() == hash);
+            BOOST_CHECK(pindex->nChainWork == index.nChainWork);
+            BOOST_CHECK_EQUAL(pindex->nChainTx, index.nChainTx);
+            BOOST_CHECK_EQUAL(pindex->nTimeMax, index.nTimeMax);
+        }
+    };
+
+    BOOST_CHECK(blockman.WriteFlatBlockIndex());
+    check_load("Loaded 101 block index entries from");
+
+    // The file is only used once.
+    uint256 id;
+    BOOST_CHECK(!blockman.m_block_tree_db->ReadFlatBlockIndexId(id));
+    check_load("LoadBlockIndexDB: last block file");
+
+    // A corrupted file is detected, and the database is used instead. The
+    // byte at offset 44 belongs to the entry count.
+    BOOST_CHECK(blockman.WriteFlatBlockIndex());
+    {
+        AutoFile file{
+            fsbridge::fopen(blockman.GetFlatBlockIndexPath(), "r+b")};
+        BOOST_REQUIRE(!file.IsNull());
+        BOOST_CHECK_EQUAL(std::fseek(file.Get(), 44, SEEK_SET), 0);
+        file << uint8_t{0x42};
+    }
+    check_load("loading it from the database instead: checksum mismatch");
+
+    // The file is not loaded with a database of another version.
+    BOOST_CHECK(blockman.WriteFlatBlockIndex());
+    blockman.m_block_tree_db->Write("version", uint64_t{CLIENT_VERSION + 1});
+    {
+        BlockManager loaded{m_node.kernel->interrupt, opts};
+        loaded.m_block_tree_db = std::move(blockman.m_block_tree_db);
+        {
+            ASSERT_DEBUG_LOG("database is not of the current version");
+            BOOST_CHECK(!loaded.LoadBlockIndexDB({}));
+        }
+        BOOST_CHECK(loaded.m_block_index.empty());
+        blockman.m_block_tree_db = std::move(loaded.m_block_tree_db);
+    }
+    blockman.m_block_tree_db->Write("version", uint64_t{CLIENT_VERSION});
+
+    // Writing to the database invalidates the file.
+    BOOST_CHECK(blockman.WriteFlatBlockIndex());
+    BOOST_CHECK(blockman.m_block_tree_db->ReadFlatBlockIndexId(id));
+    blockman.m_block_tree_db->WriteBatchSync({}, 0, {});
+    BOOST_CHECK(!blockman.m_block_tree_db->ReadFlatBlockIndexId(id));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_flat_block_index_interrupted_init,
+                        TestChain100Setup) {
+    LOCK(cs_main);
+    BlockManager &blockman = m_node.chainman->m_blockman;
+    m_node.chainman->ActiveChainstate().ForceFlushStateToDisk();
+
+    const BlockManager::Options opts{
+        .chainparams = Params(),
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = *m_node.notifications,
+    };
+
+    // The init is interrupted after the database is opened but before the
+    // block index is loaded, and the node shuts down. The empty block index
+    // is not written.
+    uint256 id;
+    {
+        BlockManager interrupted{m_node.kernel->interrupt, opts};
+        interrupted.m_block_tree_db = std::move(blockman.m_block_tree_db);
+        BOOST_CHECK(!interrupted.WriteFlatBlockIndex());
+        blockman.m_block_tree_db = std::move(interrupted.m_block_tree_db);
+    }
+    BOOST_CHECK(!blockman.m_block_tree_db->ReadFlatBlockIndexId(id));
+
+    // A file without any entry, like the one written by such a shutdown, is
+    // not loaded either.
+    {
+        BlockManager empty{m_node.kernel->interrupt, opts};
+        empty.m_block_tree_db = std::make_unique<CBlockTreeDB>(
+            DBParams{.path = m_args.GetDataDirNet() / "empty_index",
+                     .cache_bytes = 1 << 20,
+                     .memory_only = true});
+        empty.m_block_tree_db->Upgrade();
+        BOOST_CHECK(empty.LoadBlockIndexDB({}));
+        BOOST_CHECK(empty.m_block_index.empty());
+        BOOST_CHECK(empty.WriteFlatBlockIndex());
+        BOOST_CHECK(empty.m_block_tree_db->ReadFlatBlockIndexId(id));
+    }
+    blockman.m_block_tree_db->WriteFlatBlockIndexId(id);
+
+    // The restarted node loads the block index from the database.
+    BlockManager restarted{m_node.kernel->interrupt, opts};
+    restarted.m_block_tree_db = std::move(blockman.m_block_tree_db);
+    {
+        ASSERT_DEBUG_LOG(
+            "loading it from the database instead: the file has no entry");
+        BOOST_CHECK(restarted.LoadBlockIndexDB({}));
+    }
+    blockman.m_block_tree_db = std::move(restarted.m_block_tree_db);
+    BOOST_CHECK_EQUAL(restarted.m_block_index.size(), 101);
+    BOOST_CHECK(restarted.LookupBlockIndex(Params().GenesisBlock().GetHash()));
+    BOOST_CHECK(!blockman.m_block_tree_db->ReadFlatBlockIndexId(id));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_failed_block_write, TestChain100Setup) {
+    BlockManager &blockman = m_node.chainman->m_blockman;
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+    WITH_LOCK(cs_main, chainstate.ForceFlushStateToDisk());
+
+    // Make the asynchronous writes to the current block file fail.
+    const fs::path blk_path{blockman.GetBlockPosFilename({0, 0})};
+    const fs::path saved_path{blk_path + ".saved"};
+    fs::rename(blk_path, saved_path);
+    fs::create_directories(blk_path);
+
+    const CScript script{CScript() << ToByteVector(coinbaseKey.GetPubKey())
+                                   << OP_CHECKSIG};
+    const CBlock block{CreateAndProcessBlock({}, script)};
+
+    // The block index refers to data that is not on disk, so it is not
+    // written to the database.
+    LOCK(cs_main);
+    BlockValidationState state;
+    BOOST_CHECK(!chainstate.FlushStateToDisk(state, FlushStateMode::ALWAYS));
+    BOOST_CHECK(!blockman.WriteBlockIndexDB());
+    BOOST_CHECK(!blockman.WriteFlatBlockIndex());
+
+    fs::remove(blk_path);
+    fs::rename(saved_path, blk_path);
+
+    // The write failure is fatal. Clear the shutdown request as a restarted
+    // node would before loading the block index back.
+    BOOST_CHECK(ShutdownRequested());
+    AbortShutdown();
+
+    const BlockManager::Options opts{
+        .chainparams = Params(),
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = *m_node.notifications,
+    };
+    BlockManager loaded{m_node.kernel->interrupt, opts};
+    loaded.m_block_tree_db = std::move(blockman.m_block_tree_db);
+    BOOST_CHECK(loaded.LoadBlockIndexDB({}));
+    blockman.m_block_tree_db = std::move(loaded.m_block_tree_db);
+
+    BOOST_CHECK_EQUAL(loaded.m_block_index.size(), 101);
+    const CBlockIndex *pindex{loaded.LookupBlockIndex(block.GetHash())};
+    BOOST_CHECK(!pindex || !pindex->nStatus.hasData());
+}
+
 BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file) {
     KernelNotifications notifications{m_node.exit_status};
     node::BlockManager::Options blockman_opts{
@@ -0,0 +1,88 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockmap.h>
+
+#include <arith_uint256.h>
+#include <primitives/block.h>
+#include <uint256.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using node::BlockMap;
+
+BOOST_FIXTURE_TEST_SUITE(blockmap_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(block_map) {
+    BlockMap map;
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.find(BlockHash{m_rng.rand256()}) == map.end());
+
+    // Fill past a few chunks, so the table is grown several times.
+    const size_t count{3 * BlockMap::CHUNK_SIZE + 17};
+    std::vector<BlockHash> hashes;
+    std::vector<const CBlockIndex *> entries;
+    for (size_t i = 0; i < count; ++i) {
+        hashes.emplace_back(m_rng.rand256());
+        CBlockHeader header;
+        header.nTime = i;
+        const auto [it, inserted] = map.try_emplace(hashes.back(), header);
+        BOOST_CHECK(inserted);
+        BOOST_CHECK(it->first == hashes.back());
+        entries.push_back(&it->second);
+    }
+    BOOST_CHECK_EQUAL(map.size(), count);
+
+    // The entries don't move, and are iterated in insertion order.
+    size_t i{0};
+    for (const auto &[hash, index] : map) {
+        BOOST_CHECK(hash == hashes[i]);
+        BOOST_CHECK_EQUAL(&index, entries[i]);
+        BOOST_CHECK_EQUAL(index.nTime, i);
+        ++i;
+    }
+    BOOST_CHECK_EQUAL(i, count);
+
+    for (i = 0; i < count; ++i) {
+        const BlockMap &const_map{map};
+        BlockMap::const_iterator it{const_map.find(hashes[i])};
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(&it->second, entries[i]);
+        BOOST_CHECK_EQUAL(map.count(hashes[i]), 1);
+    }
+
+    // The hashes that don't differ in the bits used as a bucket index by a
+    // plain modulo are found too.
+    BlockMap high_bits;
+    for (i = 0; i < 1000; ++i) {
+        high_bits[BlockHash{ArithToUint256(arith_uint256{i} << 40)}].nTime =
+            i;
+    }
+    for (i = 0; i < 1000; ++i) {
+        const arith_uint256 hash{arith_uint256{i} << 40};
+        auto it{high_bits.find(BlockHash{ArithToUint256(hash + 1)})};
+        BOOST_CHECK(it == high_bits.end());
+        it = high_bits.find(BlockHash{ArithToUint256(hash)});
+        BOOST_REQUIRE(it != high_bits.end());
+        BOOST_CHECK_EQUAL(it->second.nTime, i);
+    }
+
+    // Existing entries are not replaced.
+    const auto [it, inserted] = map.try_emplace(hashes[0]);
+    BOOST_CHECK(!inserted);
+    BOOST_CHECK_EQUAL(&it->second, entries[0]);
+    BOOST_CHECK_EQUAL(&map[hashes[1]], entries[1]);
+    BOOST_CHECK_EQUAL(map.size(), count);
+
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+    BOOST_CHECK(map.find(hashes[0]) == map.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,14 +6,20 @@
 #include <config.h>
 #include <index/coinstatsindex.h>
 #include <interfaces/chain.h>
+#include <kernel/coinstats.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
+#include <txdb.h>
 #include <util/time.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(coinstatsindex_tests)
 
@@ -146,4 +152,67 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(coinstats_parallel_computation, TestChain100Setup) {
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+    chainstate.ForceFlushStateToDisk();
+    CCoinsViewDB &coins_db = WITH_LOCK(::cs_main, return chainstate.CoinsDB());
+
+    // The ranges cover the whole UTXO set, in order and without overlap.
+    uint64_t total_coins{0};
+    {
+        std::unique_ptr<CCoinsViewCursor> cursor{coins_db.Cursor()};
+        for (; cursor->Valid(); cursor->Next()) {
+            ++total_coins;
+        }
+    }
+    BOOST_CHECK_GE(total_coins, 100);
+
+    // The coins are ordered by serialized txid.
+    const auto serialized_less_equal = [](const TxId &a, const TxId &b) {
+        return std::memcmp(a.begin(), b.begin(), uint256::size()) <= 0;
+    };
+
+    for (size_t count : {1, 3, 7, 256, 1000}) {
+        const auto cursors = coins_db.RangeCursors(count);
+        BOOST_CHECK_EQUAL(cursors.size(), std::min<size_t>(count, 256));
+
+        uint64_t range_coins{0};
+        std::optional<TxId> prev_txid;
+        for (const auto &cursor : cursors) {
+            BOOST_CHECK(cursor->GetBestBlock() == coins_db.GetBestBlock());
+            for (; cursor->Valid(); cursor->Next()) {
+                COutPoint outpoint;
+                BOOST_REQUIRE(cursor->GetKey(outpoint));
+                BOOST_CHECK(!prev_txid || serialized_less_equal(
+                                              *prev_txid, outpoint.GetTxId()));
+                prev_txid = outpoint.GetTxId();
+                ++range_coins;
+            }
+        }
+        BOOST_CHECK_EQUAL(range_coins, total_coins);
+    }
+
+    // Computing the statistics in parallel gives the same result.
+    for (const auto hash_type : {kernel::CoinStatsHashType::MUHASH,
+                                 kernel::CoinStatsHashType::NONE}) {
+        const auto serial{kernel::ComputeUTXOStats(
+            hash_type, &coins_db, chainstate.m_blockman, [] {})};
+        const auto parallel{kernel::ComputeUTXOStats(
+            hash_type, &coins_db, chainstate.m_blockman, [] {},
+            /*worker_threads_num=*/3)};
+        BOOST_REQUIRE(serial && parallel);
+
+        BOOST_CHECK_EQUAL(parallel->nHeight, serial->nHeight);
+        BOOST_CHECK(parallel->hashBlock == serial->hashBlock);
+        BOOST_CHECK(parallel->hashSerialized == serial->hashSerialized);
+        BOOST_CHECK_EQUAL(parallel->nTransactions, serial->nTransactions);
+        BOOST_CHECK_EQUAL(parallel->nTransactionOutputs,
+                          serial->nTransactionOutputs);
+        BOOST_CHECK_EQUAL(parallel->nBogoSize, serial->nBogoSize);
+        BOOST_CHECK(parallel->total_amount == serial->total_amount);
+        BOOST_CHECK_EQUAL(parallel->coins_count, total_coins);
+        BOOST_CHECK_EQUAL(serial->coins_count, total_coins);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2209,4 +2209,43 @@ BOOST_AUTO_TEST_CASE(muhash_tests) {
         "3a31e6903aff0de9f62f9a9f7f8b861de76ce2cda09822b90014319ae5dc2271");
 }
 
+BOOST_AUTO_TEST_CASE(muhash_implementations) {
+    // Numbers around the modulus, which are not reduced when deserialized, and
+    // random numbers.
+    uint8_t numbers[24][Num3072::BYTE_SIZE];
+    memset(numbers[0], 0, Num3072::BYTE_SIZE);
+    memset(numbers[1], 0xff, Num3072::BYTE_SIZE);
+    memset(numbers[2], 0xff, Num3072::BYTE_SIZE);
+    numbers[2][0] = 0xff - 0x11;
+    memset(numbers[3], 0, Num3072::BYTE_SIZE);
+    numbers[3][0] = 1;
+    for (int i = 4; i < 24; ++i) {
+        const auto bytes = m_rng.randbytes(Num3072::BYTE_SIZE);
+        std::copy(bytes.begin(), bytes.end(), numbers[i]);
+    }
+
+    const auto multiply_all = [&] {
+        std::vector<std::vector<uint8_t>> results;
+        for (const auto &a : numbers) {
+            for (const auto &b : numbers) {
+                Num3072 num{a};
+                num.Multiply(Num3072{b});
+                uint8_t result[Num3072::BYTE_SIZE];
+                num.ToBytes(result);
+                results.emplace_back(std::begin(result), std::end(result));
+            }
+        }
+        return results;
+    };
+
+    // The best implementation available must give the same results as the
+    // portable one.
+    const std::string algo = MuHash3072AutoDetect();
+    BOOST_TEST_MESSAGE("Using the " << algo << " MuHash3072 implementation");
+    const auto results = multiply_all();
+    BOOST_CHECK_EQUAL(MuHash3072AutoDetect(/*use_hardware=*/false), "standard");
+    BOOST_CHECK(multiply_all() == results);
+    MuHash3072AutoDetect();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
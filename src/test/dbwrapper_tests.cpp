@@ -51,6 +51,39 @@ BOOST_AUTO_TEST_CASE(dbwrapper) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_tuning) {
+    const DBTuning custom{.block_size = 1 << 10,
+                          .write_buffer_size = 64 << 10,
+                          .bloom_bits = 0,
+                          .max_open_files = 16};
+    for (const DBTuning &tuning :
+         {DBTuning::ForChainstate(), DBTuning::ForBlockIndex(),
+          DBTuning::ForBlockIndexes(), DBTuning::ForTxIndex(), custom}) {
+        const fs::path ph = m_args.GetDataDirBase() / "dbwrapper_tuning";
+        std::vector<uint256> values;
+        {
+            CDBWrapper dbw({.path = ph,
+                            .cache_bytes = 1 << 20,
+                            .wipe_data = true,
+                            .tuning = tuning});
+            // Write enough to get several files and blocks on disk.
+            for (uint32_t i = 0; i < 10000; i++) {
+                values.push_back(m_rng.rand256());
+                dbw.Write(i, values.back());
+            }
+        }
+
+        // The settings can change when the database is opened again.
+        CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 20});
+        for (uint32_t i = 0; i < values.size(); i++) {
+            uint256 res;
+            BOOST_CHECK(dbw.Read(i, res));
+            BOOST_CHECK_EQUAL(res, values[i]);
+        }
+        BOOST_CHECK(!dbw.Exists(uint32_t(values.size())));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(dbwrapper_basic_data) {
     // Perform tests both obfuscated and non-obfuscated.
     for (bool obfuscate : {false, true}) {
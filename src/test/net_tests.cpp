@@ -1569,4 +1569,71 @@ BOOST_AUTO_TEST_CASE(inactivity_check) {
     connman.ClearNodes();
 }
 
+BOOST_AUTO_TEST_CASE(recv_buffer_pool) {
+    const Config &config = m_node.chainman->GetConfig();
+    RecvBufferPool pool;
+    V1TransportDeserializer deserializer(config, NodeId(0), &pool);
+    const V1TransportSerializer serializer;
+
+    auto receive = [&](std::vector<uint8_t> payload) {
+        CSerializedNetMsg ser_msg;
+        ser_msg.m_type = NetMsgType::PING;
+        ser_msg.data = std::move(payload);
+        std::vector<uint8_t> header;
+        serializer.prepareForTransport(config, ser_msg, header);
+
+        for (Span<const uint8_t> bytes : {Span<const uint8_t>(header),
+                                          Span<const uint8_t>(ser_msg.data)}) {
+            while (!bytes.empty()) {
+                BOOST_CHECK(deserializer.Read(config, bytes) >= 0);
+            }
+        }
+        BOOST_CHECK(deserializer.Complete());
+
+        bool reject_message{true};
+        CNetMessage msg = deserializer.GetMessage(0us, reject_message);
+        BOOST_CHECK(!reject_message);
+        BOOST_CHECK_EQUAL(msg.m_type, NetMsgType::PING);
+        return msg;
+    };
+
+    // Nothing to recycle yet
+    CNetMessage msg = receive(std::vector<uint8_t>(8, 0x42));
+    BOOST_CHECK_EQUAL(msg.m_recv.size(), 8);
+    BOOST_CHECK_EQUAL(pool.Size(), 0);
+
+    const auto *first_buffer = msg.m_recv.data();
+    pool.Put(std::move(msg.m_recv));
+    BOOST_CHECK_EQUAL(pool.Size(), 1);
+
+    // The deserializer already took a buffer from the pool for the next
+    // message when the previous one completed, so it has to be received twice
+    // before the recycled buffer is used.
+    msg = receive(std::vector<uint8_t>(8, 0x43));
+    BOOST_CHECK_EQUAL(pool.Size(), 0);
+    msg = receive(std::vector<uint8_t>(4, 0x44));
+    BOOST_CHECK(msg.m_recv.data() == first_buffer);
+    BOOST_CHECK_EQUAL(msg.m_recv.size(), 4);
+    BOOST_CHECK(msg.m_recv[0] == std::byte{0x44});
+
+    // Large buffers are not retained
+    pool.Put(DataStream{
+        std::vector<uint8_t>(RecvBufferPool::MAX_BUFFER_CAPACITY + 1)});
+    BOOST_CHECK_EQUAL(pool.Size(), 0);
+
+    // Empty buffers are not worth retaining either
+    pool.Put(DataStream{});
+    BOOST_CHECK_EQUAL(pool.Size(), 0);
+
+    // The pool is bounded
+    for (size_t i = 0; i < 2 * RecvBufferPool::MAX_BUFFERS; i++) {
+        pool.Put(DataStream{std::vector<uint8_t>(32)});
+    }
+    BOOST_CHECK_EQUAL(pool.Size(), RecvBufferPool::MAX_BUFFERS);
+    DataStream recycled = pool.Get();
+    BOOST_CHECK(recycled.empty());
+    BOOST_CHECK(recycled.capacity() >= 32);
+    BOOST_CHECK_EQUAL(pool.Size(), RecvBufferPool::MAX_BUFFERS - 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
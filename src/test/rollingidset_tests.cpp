@@ -0,0 +1,118 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <common/rollingidset.h>
+
+#include <common/bloom.h>
+#include <memusage.h>
+#include <uint256.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(rollingidset_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(rolling_id_set) {
+    RollingIdSet set(100);
+
+    // Overfill
+    static const int DATASIZE = 399;
+    std::vector<uint256> data(DATASIZE);
+    for (int i = 0; i < DATASIZE; i++) {
+        data[i] = m_rng.rand256();
+        set.insert(data[i]);
+    }
+
+    // The last 100 are guaranteed to be remembered, and the ones that were
+    // inserted more than 7 generations of 17 entries ago are forgotten.
+    for (int i = DATASIZE - 100; i < DATASIZE; i++) {
+        BOOST_CHECK(set.contains(data[i]));
+    }
+    for (int i = 0; i < DATASIZE - 7 * 17; i++) {
+        BOOST_CHECK(!set.contains(data[i]));
+    }
+
+    // No false positive
+    for (int i = 0; i < 10000; i++) {
+        BOOST_CHECK(!set.contains(m_rng.rand256()));
+    }
+
+    set.reset();
+    for (const uint256 &id : data) {
+        BOOST_CHECK(!set.contains(id));
+    }
+
+    // Roll through the data, the last 100 entries are always remembered
+    for (int i = 0; i < DATASIZE; i++) {
+        if (i >= 100) {
+            BOOST_CHECK(set.contains(data[i - 100]));
+        }
+        set.insert(data[i]);
+        BOOST_CHECK(set.contains(data[i]));
+    }
+
+    // Inserting an id again refreshes it
+    set.reset();
+    set.insert(data[0]);
+    for (int i = 1; i < DATASIZE; i++) {
+        set.insert(data[i]);
+        if (i % 50 == 0) {
+            set.insert(data[0]);
+        }
+        BOOST_CHECK(set.contains(data[0]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rolling_id_set_expiry) {
+    // Check the cluster handling when expiring generations by filling a small
+    // set many times over, with all the entries colliding on a few slots
+    // being very likely.
+    for (uint32_t nElements : {1, 2, 5, 6, 7, 13, 200}) {
+        RollingIdSet set(nElements);
+        std::vector<uint256> data;
+        for (uint32_t i = 0; i < 20 * nElements + 10; i++) {
+            data.push_back(m_rng.rand256());
+            set.insert(data.back());
+
+            for (uint32_t j = 0; j < std::min(nElements, i + 1); j++) {
+                BOOST_CHECK(set.contains(data[i - j]));
+            }
+        }
+
+        // Nothing older than 7 generations is remembered
+        const size_t maxEntries = (nElements + 5) / 6 * 7;
+        for (size_t i = 0; i + maxEntries < data.size(); i++) {
+            BOOST_CHECK(!set.contains(data[i]));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rolling_id_set_memory) {
+    // The finalized items of the avalanche processor used to be tracked by a
+    // rolling bloom filter with a 0.00001% false positive rate. The exact set
+    // should not use more memory.
+    for (uint32_t nElements : {100, 10000, 100000}) {
+        RollingIdSet set(nElements);
+
+        // There is no accessor for the bloom filter size, but it has a
+        // single allocation of the 2-bit entries.
+        const double logFpRate = std::log(0.0000001);
+        const int nHashFuncs =
+            std::max(1, std::min<int>(round(logFpRate / std::log(0.5)), 50));
+        const uint32_t nFilterBits = uint32_t(
+            std::ceil(-1.0 * nHashFuncs * ((nElements + 1) / 2 * 3) /
+                      std::log(1.0 - std::exp(logFpRate / nHashFuncs))));
+        const size_t bloomUsage = memusage::MallocUsage(
+            ((nFilterBits + 63) / 64) * 2 * sizeof(uint64_t));
+
+        BOOST_CHECK_LE(set.DynamicMemoryUsage(), bloomUsage);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,7 +16,9 @@
 #include <util/translation.h>
 #include <util/vector.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 static constexpr uint8_t DB_COIN{'C'};
@@ -28,6 +30,7 @@ static constexpr uint8_t DB_HEAD_BLOCKS{'H'};
 static constexpr uint8_t DB_FLAG{'F'};
 static constexpr uint8_t DB_REINDEX_FLAG{'R'};
 static constexpr uint8_t DB_LAST_BLOCK{'l'};
+static constexpr uint8_t DB_FLAT_BLOCK_INDEX{'x'};
 
 // Keys used in previous version that might still be found in the DB:
 static constexpr uint8_t DB_COINS{'c'};
@@ -201,6 +204,20 @@ void CCoinsViewDB::BatchWrite(CoinsViewCacheCursor &cursor,
              (unsigned int)dirty_count, (unsigned int)count);
 }
 
+void CCoinsViewDB::BulkWrite(
+    const std::vector<std::pair<COutPoint, Coin>> &coins) {
+    CDBBatch batch(*m_db);
+    for (const auto &[outpoint, coin] : coins) {
+        assert(!coin.IsSpent());
+        batch.Write(CoinEntry(&outpoint), coin);
+        if (batch.SizeEstimate() > m_options.batch_write_bytes) {
+            m_db->WriteBatch(batch);
+            batch.Clear();
+        }
+    }
+    m_db->WriteBatch(batch);
+}
+
 size_t CCoinsViewDB::EstimateSize() const {
     return m_db->EstimateSize(DB_COIN, uint8_t(DB_COIN + 1));
 }
@@ -235,17 +252,55 @@ CCoinsViewCursor *CCoinsViewDB::Cursor() const {
      */
     i->pcursor->Seek(DB_COIN);
     // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
-    } else {
-        // Make sure Valid() and GetKey() return false
-        i->keyTmp.first = 0;
-    }
+    i->CacheKey();
     return i;
 }
 
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsViewDB::RangeCursors(size_t count) const {
+    count = std::clamp<size_t>(count, 1, 256);
+
+    // All the cursors read from the same snapshot, so a write in the meantime
+    // can't be seen by some of them only.
+    CDBWrapper &db = const_cast<CDBWrapper &>(*m_db);
+    const auto snapshot = db.GetSnapshot();
+    const BlockHash best_block = [&] {
+        std::unique_ptr<CDBIterator> it{db.NewIterator(snapshot)};
+        it->Seek(DB_BEST_BLOCK);
+        uint8_t key;
+        BlockHash hash;
+        if (!it->Valid() || !it->GetKey(key) || key != DB_BEST_BLOCK ||
+            !it->GetValue(hash)) {
+            return BlockHash();
+        }
+        return hash;
+    }();
+
+    // The ranges are split on the first byte of the txids, as they are
+    // serialized in the keys.
+    const auto range_bound = [&](size_t range) {
+        uint256 txid;
+        *txid.begin() = range * 256 / count;
+        return TxId{txid};
+    };
+
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    cursors.reserve(count);
+    for (size_t range = 0; range < count; ++range) {
+        std::optional<TxId> end;
+        if (range + 1 < count) {
+            end = range_bound(range + 1);
+        }
+        auto cursor = std::unique_ptr<CCoinsViewDBCursor>(
+            new CCoinsViewDBCursor(db.NewIterator(snapshot), best_block, end));
+        const COutPoint begin{range_bound(range), 0};
+        cursor->pcursor->Seek(CoinEntry(&begin));
+        cursor->CacheKey();
+        cursors.push_back(std::move(cursor));
+    }
+    return cursors;
+}
+
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const {
     // Return cached key
     if (keyTmp.first == DB_COIN) {
@@ -269,8 +324,17 @@ bool CCoinsViewDBCursor::Valid() const {
 
 void CCoinsViewDBCursor::Next() {
     pcursor->Next();
+    CacheKey();
+}
+
+void CCoinsViewDBCursor::CacheKey() {
     CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
+    // The end of the range is compared in the order of the keys, which is the
+    // order of the serialized txids and not their numerical order.
+    if (!pcursor->Valid() || !pcursor->GetKey(entry) ||
+        (entry.key == DB_COIN && m_end &&
+         std::memcmp(keyTmp.second.GetTxId().begin(), m_end->begin(),
+                     uint256::size()) >= 0)) {
         // Invalidate cached key after last record so that Valid() and GetKey()
         // return false
         keyTmp.first = 0;
@@ -295,9 +359,23 @@ void CBlockTreeDB::WriteBatchSync(
         batch.Write(std::make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()),
                     CDiskBlockIndex(*it));
     }
+    // The flat block index is no longer a copy of the database.
+    batch.Erase(DB_FLAT_BLOCK_INDEX);
     WriteBatch(batch, true);
 }
 
+bool CBlockTreeDB::ReadFlatBlockIndexId(uint256 &id) {
+    return Read(DB_FLAT_BLOCK_INDEX, id);
+}
+
+void CBlockTreeDB::WriteFlatBlockIndexId(const uint256 &id) {
+    Write(DB_FLAT_BLOCK_INDEX, id, /*fSync=*/true);
+}
+
+void CBlockTreeDB::EraseFlatBlockIndexId() {
+    Erase(DB_FLAT_BLOCK_INDEX, /*fSync=*/true);
+}
+
 void CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
     Write(std::make_pair(DB_FLAG, name), fValue ? uint8_t{'1'} : uint8_t{'0'});
 }
@@ -311,6 +389,11 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+bool CBlockTreeDB::HasCurrentVersion() {
+    uint64_t version = 0;
+    return Read("version", version) && version == CLIENT_VERSION;
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(
     const Consensus::Params &params,
     std::function<CBlockIndex *(const BlockHash &)> insertBlockIndex,
@@ -363,6 +446,7 @@ bool CBlockTreeDB::LoadBlockIndexGuts(
         pindexNew->nNonce = diskindex.nNonce;
         pindexNew->nStatus = diskindex.nStatus;
         pindexNew->nTx = diskindex.nTx;
+        pindexNew->nSize = diskindex.nSize;
 
         if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits,
                               params)) {
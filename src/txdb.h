@@ -12,6 +12,7 @@
 #include <flatfile.h>
 #include <kernel/caches.h>
 #include <kernel/cs_main.h>
+#include <primitives/txid.h>
 #include <util/fs.h>
 #include <util/result.h>
 
@@ -63,6 +64,22 @@ public:
                     const BlockHash &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
 
+    /**
+     * Cursors over count disjoint ranges of the coins, that together cover the
+     * whole set as of the same state of the database, so they can be iterated
+     * in parallel. The coins are split by txid, so all the outputs of a
+     * transaction are in the same range. There are at most 256 ranges.
+     */
+    std::vector<std::unique_ptr<CCoinsViewCursor>>
+    RangeCursors(size_t count) const;
+
+    /**
+     * Write unspent coins straight to the database, bypassing any cache. This
+     * doesn't update the best block, and is meant to bulk load a new database
+     * such as a UTXO snapshot chainstate.
+     */
+    void BulkWrite(const std::vector<std::pair<COutPoint, Coin>> &coins);
+
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
     size_t EstimateSize() const override;
@@ -88,10 +105,16 @@ public:
     void Next() override;
 
 private:
-    CCoinsViewDBCursor(CDBIterator *pcursorIn, const BlockHash &hashBlockIn)
-        : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    CCoinsViewDBCursor(CDBIterator *pcursorIn, const BlockHash &hashBlockIn,
+                       std::optional<TxId> end = std::nullopt)
+        : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn), m_end(end) {}
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! The cursor stops before this txid, if set.
+    std::optional<TxId> m_end;
+
+    //! Cache the key of the current record, or invalidate the cursor.
+    void CacheKey();
 
     friend class CCoinsViewDB;
 };
@@ -109,6 +132,16 @@ public:
     bool IsReindexing() const;
     void WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
+    /**
+     * The id of the flat block index file that is a copy of the block index
+     * in the database. It is erased by any subsequent write of the block
+     * index.
+     */
+    bool ReadFlatBlockIndexId(uint256 &id);
+    void WriteFlatBlockIndexId(const uint256 &id);
+    void EraseFlatBlockIndexId();
+    //! Whether the database is of the version LoadBlockIndexGuts can load.
+    bool HasCurrentVersion();
     bool LoadBlockIndexGuts(
         const Consensus::Params &params,
         std::function<CBlockIndex *(const BlockHash &)> insertBlockIndex,
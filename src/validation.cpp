@@ -1533,7 +1533,8 @@ void Chainstate::InitCoinsDB(size_t cache_size_bytes, bool in_memory,
                  .memory_only = in_memory,
                  .wipe_data = should_wipe,
                  .obfuscate = true,
-                 .options = m_chainman.m_options.coins_db},
+                 .options = m_chainman.m_options.coins_db,
+                 .tuning = DBTuning::ForChainstate()},
         m_chainman.m_options.coins_view);
 }
 
@@ -2710,7 +2711,11 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
                     LOG_TIME_MILLIS_WITH_CATEGORY("write block index to disk",
                                                   BCLog::BENCH);
 
-                    m_blockman.WriteBlockIndexDB();
+                    if (!m_blockman.WriteBlockIndexDB()) {
+                        return FatalError(
+                            m_chainman.GetNotifications(), state,
+                            "Failed to write to block index database");
+                    }
                 }
 
                 // Finally remove any pruned files
@@ -4317,13 +4322,13 @@ void ChainstateManager::ReceivedBlockTransactions(const CBlock &block,
  * Do not call this for any check that depends on the context.
  * For context-dependent calls, see ContextualCheckBlockHeader.
  */
-static bool CheckBlockHeader(const CBlockHeader &block,
+static bool CheckBlockHeader(const CBlockHeader &block, const BlockHash &hash,
                              BlockValidationState &state,
                              const Consensus::Params &params,
                              BlockValidationOptions validationOptions) {
     // Check proof of work matches claimed amount
     if (validationOptions.shouldValidatePoW() &&
-        !CheckProofOfWork(block.GetHash(), block.nBits, params)) {
+        !CheckProofOfWork(hash, block.nBits, params)) {
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER,
                              "high-hash", "proof of work failed");
     }
@@ -4369,7 +4374,8 @@ bool CheckBlock(const CBlock &block, BlockValidationState &state,
 
     // Check that the header is valid (particularly PoW).  This is mostly
     // redundant with the call in AcceptBlockHeader.
-    if (!CheckBlockHeader(block, state, params, validationOptions)) {
+    if (!CheckBlockHeader(block, block.GetHash(), state, params,
+                          validationOptions)) {
         return false;
     }
 
@@ -4663,15 +4669,14 @@ static bool ContextualCheckBlock(const CBlock &block,
  * Returns true if the block is successfully added to the block index.
  */
 bool ChainstateManager::AcceptBlockHeader(
-    const CBlockHeader &block, BlockValidationState &state,
-    CBlockIndex **ppindex, bool min_pow_checked,
+    const CBlockHeader &block, const BlockHash &hash,
+    BlockValidationState &state, CBlockIndex **ppindex, bool min_pow_checked,
     const std::optional<CCheckpointData> &test_checkpoints) {
     AssertLockHeld(cs_main);
     const Config &config = this->GetConfig();
     const CChainParams &chainparams = config.GetChainParams();
 
     // Check for duplicate
-    BlockHash hash = block.GetHash();
     BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
     if (hash != chainparams.GetConsensus().hashGenesisBlock) {
         if (miSelf != m_blockman.m_block_index.end()) {
@@ -4691,7 +4696,7 @@ bool ChainstateManager::AcceptBlockHeader(
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(),
+        if (!CheckBlockHeader(block, hash, state, chainparams.GetConsensus(),
                               BlockValidationOptions(config))) {
             LogPrint(BCLog::VALIDATION,
                      "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__,
@@ -4782,7 +4787,8 @@ bool ChainstateManager::AcceptBlockHeader(
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_LOW_WORK,
                              "too-little-chainwork");
     }
-    CBlockIndex *pindex{m_blockman.AddToBlockIndex(block, m_best_header)};
+    CBlockIndex *pindex{
+        m_blockman.AddToBlockIndex(block, hash, m_best_header)};
 
     if (ppindex) {
         *ppindex = pindex;
@@ -4814,13 +4820,25 @@ bool ChainstateManager::ProcessNewBlockHeaders(
     BlockValidationState &state, const CBlockIndex **ppindex,
     const std::optional<CCheckpointData> &test_checkpoints) {
     AssertLockNotHeld(cs_main);
+
+    // Hashing the headers is the most expensive part of accepting them, and
+    // the hash is needed several times per header (lookup, proof of work and
+    // block index insertion). Compute them once before grabbing cs_main so
+    // the lock is only held for the block index bookkeeping.
+    std::vector<BlockHash> hashes;
+    hashes.reserve(headers.size());
+    for (const CBlockHeader &header : headers) {
+        hashes.push_back(header.GetHash());
+    }
+
     {
         LOCK(cs_main);
-        for (const CBlockHeader &header : headers) {
+        for (size_t i = 0; i < headers.size(); ++i) {
             // Use a temp pindex instead of ppindex to avoid a const_cast
             CBlockIndex *pindex = nullptr;
-            bool accepted = AcceptBlockHeader(
-                header, state, &pindex, min_pow_checked, test_checkpoints);
+            bool accepted =
+                AcceptBlockHeader(headers[i], hashes[i], state, &pindex,
+                                  min_pow_checked, test_checkpoints);
             CheckBlockIndex();
 
             if (!accepted) {
@@ -4896,8 +4914,8 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock> &pblock,
 
     CBlockIndex *pindex = nullptr;
 
-    bool accepted_header{
-        AcceptBlockHeader(block, state, &pindex, min_pow_checked)};
+    bool accepted_header{AcceptBlockHeader(block, block.GetHash(), state,
+                                           &pindex, min_pow_checked)};
     CheckBlockIndex();
 
     if (!accepted_header) {
@@ -5784,8 +5802,8 @@ bool Chainstate::LoadGenesisBlock() {
             LogError("%s: writing genesis block to disk failed\n", __func__);
             return false;
         }
-        CBlockIndex *pindex =
-            m_blockman.AddToBlockIndex(block, m_chainman.m_best_header);
+        CBlockIndex *pindex = m_blockman.AddToBlockIndex(
+            block, block.GetHash(), m_chainman.m_best_header);
         m_chainman.ReceivedBlockTransactions(block, pindex, blockPos);
     } catch (const std::runtime_error &e) {
         LogError("%s: failed to write genesis block: %s\n", __func__, e.what());
@@ -6795,6 +6813,30 @@ static void SnapshotUTXOHashBreakpoint(const util::SignalInterrupt &interrupt) {
     }
 }
 
+/** Number of snapshot coins read from the file before they are processed. */
+static constexpr size_t SNAPSHOT_LOAD_CHUNK_COINS{120000};
+
+/**
+ * Part of the processing of a chunk of snapshot coins, running on the worker
+ * threads while the next chunk is read from the file.
+ */
+class SnapshotLoadTask {
+    std::function<void()> m_task;
+
+public:
+    explicit SnapshotLoadTask(std::function<void()> task)
+        : m_task(std::move(task)) {}
+
+    std::optional<std::string> operator()() {
+        try {
+            m_task();
+        } catch (const std::exception &e) {
+            return e.what();
+        }
+        return std::nullopt;
+    }
+};
+
 bool ChainstateManager::PopulateAndValidateSnapshot(
     Chainstate &snapshot_chainstate, AutoFile &coins_file,
     const SnapshotMetadata &metadata) {
@@ -6846,6 +6888,50 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
               base_blockhash.ToString());
     int64_t coins_processed{0};
 
+    // The snapshot coins come in the coins database order. This makes it
+    // possible to write them straight to the database without going through
+    // the coins cache, and to compute the snapshot hash as they are read
+    // instead of iterating over the database afterwards.
+    //
+    // No need to acquire cs_main since this chainstate isn't being used yet.
+    CCoinsViewDB &coins_db =
+        *WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
+    kernel::SerializedUTXOHasher hasher{base_blockhash};
+
+    // While a chunk is read from the file, the previous one is hashed and
+    // written to the database in parallel. The hash is sequential, so it is
+    // computed by a single task. The chunks are declared before the queue so
+    // they outlive the worker threads.
+    std::vector<std::pair<COutPoint, Coin>> chunk;
+    std::vector<std::pair<COutPoint, Coin>> pending;
+    chunk.reserve(SNAPSHOT_LOAD_CHUNK_COINS);
+    CCheckQueue<SnapshotLoadTask> queue(
+        /*batch_size=*/1, std::max(m_options.worker_threads_num, 1),
+        "snapshotld");
+
+    // Wait for the previous chunk to be processed, then start processing the
+    // current one.
+    const auto process_chunk = [&]() -> bool {
+        if (auto error = queue.Complete()) {
+            LogPrintf("[snapshot] failed to load coins: %s\n", *error);
+            return false;
+        }
+
+        pending = std::move(chunk);
+        chunk.clear();
+        chunk.reserve(SNAPSHOT_LOAD_CHUNK_COINS);
+
+        std::vector<SnapshotLoadTask> tasks;
+        tasks.emplace_back([&] {
+            for (const auto &[outpoint, coin] : pending) {
+                hasher.Add(outpoint, coin);
+            }
+        });
+        tasks.emplace_back([&] { coins_db.BulkWrite(pending); });
+        queue.Add(std::move(tasks));
+        return true;
+    };
+
     while (coins_left > 0) {
         try {
             TxId txid;
@@ -6879,46 +6965,22 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
                               coins_count - coins_left);
                     return false;
                 }
-                coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint),
-                                                      std::move(coin));
+                chunk.emplace_back(std::move(outpoint), std::move(coin));
 
                 --coins_left;
                 ++coins_processed;
 
                 if (coins_processed % 1000000 == 0) {
-                    LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
+                    LogPrintf("[snapshot] %d coins loaded (%.2f%%)\n",
                               coins_processed,
                               static_cast<float>(coins_processed) * 100 /
-                                  static_cast<float>(coins_count),
-                              coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+                                  static_cast<float>(coins_count));
                 }
 
-                // Batch write and flush (if we need to) every so often.
-                //
-                // If our average Coin size is roughly 41 bytes, checking every
-                // 120,000 coins means <5MB of memory imprecision.
-                if (coins_processed % 120000 == 0) {
-                    if (m_interrupt) {
+                if (chunk.size() >= SNAPSHOT_LOAD_CHUNK_COINS) {
+                    if (m_interrupt || !process_chunk()) {
                         return false;
                     }
-
-                    const auto snapshot_cache_state = WITH_LOCK(
-                        ::cs_main,
-                        return snapshot_chainstate.GetCoinsCacheSizeState());
-
-                    if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                        // This is a hack - we don't know what the actual best
-                        // block is, but that doesn't matter for the purposes of
-                        // flushing the cache here. We'll set this to its
-                        // correct value (`base_blockhash`) below after the
-                        // coins are loaded.
-                        coins_cache.SetBestBlock(BlockHash{GetRandHash()});
-
-                        // No need to acquire cs_main since this chainstate
-                        // isn't being used yet.
-                        FlushSnapshotToDisk(coins_cache,
-                                            /*snapshot_loaded=*/false);
-                    }
                 }
             }
         } catch (const std::ios_base::failure &) {
@@ -6929,13 +6991,6 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
         }
     }
 
-    // Important that we set this. This and the coins_cache accesses above are
-    // sort of a layer violation, but either we reach into the innards of
-    // CCoinsViewCache here or we have to invert some of the Chainstate to
-    // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
-    // method.
-    coins_cache.SetBestBlock(base_blockhash);
-
     bool out_of_coins{false};
     try {
         TxId txid;
@@ -6951,43 +7006,37 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
         return false;
     }
 
-    LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s\n",
-              coins_count, coins_cache.DynamicMemoryUsage() / (1000 * 1000),
+    // Process the last chunk and wait for it to complete.
+    if (!process_chunk()) {
+        return false;
+    }
+    if (auto error = queue.Complete()) {
+        LogPrintf("[snapshot] failed to load coins: %s\n", *error);
+        return false;
+    }
+
+    LogPrintf("[snapshot] loaded %d coins from snapshot %s\n", coins_count,
               base_blockhash.ToString());
 
-    // No need to acquire cs_main since this chainstate isn't being used yet.
+    // Important that we set this. The coins have been written to the database
+    // directly, so the flush only marks the database as consistent with the
+    // snapshot base block. This and the coins_cache accesses above are sort of
+    // a layer violation, but either we reach into the innards of
+    // CCoinsViewCache here or we have to invert some of the Chainstate to
+    // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
+    // method.
+    coins_cache.SetBestBlock(base_blockhash);
     FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/true);
 
     assert(coins_cache.GetBestBlock() == base_blockhash);
 
-    // As above, okay to immediately release cs_main here since no other context
-    // knows about the snapshot_chainstate.
-    CCoinsViewDB *snapshot_coinsdb =
-        WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
-
-    std::optional<CCoinsStats> maybe_stats;
-
-    try {
-        maybe_stats = ComputeUTXOStats(
-            CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman,
-            [&interrupt = m_interrupt] {
-                SnapshotUTXOHashBreakpoint(interrupt);
-            });
-    } catch (StopHashingException const &) {
-        return false;
-    }
-    if (!maybe_stats.has_value()) {
-        LogPrintf("[snapshot] failed to generate coins stats\n");
-        return false;
-    }
-
     // Assert that the deserialized chainstate contents match the expected
     // assumeutxo value.
-    if (AssumeutxoHash{maybe_stats->hashSerialized} !=
-        au_data.hash_serialized) {
+    const AssumeutxoHash hash_serialized{hasher.Finalize()};
+    if (hash_serialized != au_data.hash_serialized) {
         LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
                   au_data.hash_serialized.ToString(),
-                  maybe_stats->hashSerialized.ToString());
+                  hash_serialized.ToString());
         return false;
     }
 
@@ -1226,10 +1226,13 @@ private:
      * Caller must set min_pow_checked=true in order to add a new header to the
      * block index (permanent memory storage), indicating that the header is
      * known to be part of a sufficiently high-work chain (anti-dos check).
+     * The caller provides the hash of the header so it can be computed
+     * without holding cs_main.
      */
     bool AcceptBlockHeader(
-        const CBlockHeader &block, BlockValidationState &state,
-        CBlockIndex **ppindex, bool min_pow_checked,
+        const CBlockHeader &block, const BlockHash &hash,
+        BlockValidationState &state, CBlockIndex **ppindex,
+        bool min_pow_checked,
         const std::optional<CCheckpointData> &test_checkpoints = std::nullopt)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     friend Chainstate;
@@ -0,0 +1,144 @@
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the compact avalanche polls and responses negotiated by the peers of
+version AVALANCHE_COMPACT_POLL_VERSION or later."""
+
+import random
+
+from test_framework.avatools import (
+    AVALANCHE_COMPACT_POLL_VERSION,
+    CompactAvaP2PInterface,
+    assert_response,
+    can_find_inv_in_poll,
+    get_ava_p2p_interface,
+)
+from test_framework.key import ECPubKey
+from test_framework.messages import (
+    AvalancheCompactPollItem,
+    AvalancheHello,
+    AvalancheVote,
+    AvalancheVoteError,
+    msg_compactavapoll,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, uint256_hex
+
+QUORUM_NODE_COUNT = 8
+
+ADDRESS = "ecregtest:pqv2r67sgz3qumufap3h2uuj0zfmnzuv8v38gtrh5v"
+
+
+class AvalancheCompactPollTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+        self.extra_args = [
+            [
+                "-avaproofstakeutxodustthreshold=1000000",
+                "-avaproofstakeutxoconfirmations=1",
+                "-avacooldown=0",
+                "-avaminquorumstake=0",
+                "-avaminavaproofsnodecount=0",
+                "-persistavapeers=0",
+                "-avalanchestakingpreconsensus=0",
+            ],
+        ]
+
+    def run_test(self):
+        node = self.nodes[0]
+
+        quorum = [
+            get_ava_p2p_interface(self, node, p2p_class=CompactAvaP2PInterface)
+            for _ in range(QUORUM_NODE_COUNT)
+        ]
+        for peer in node.getpeerinfo():
+            assert_equal(peer["version"], AVALANCHE_COMPACT_POLL_VERSION)
+        assert node.getavalancheinfo()["ready_to_poll"] is True
+
+        self.log.info("Check that the votes on the compact polls are accounted")
+
+        def has_finalized_proof(proofid):
+            can_find_inv_in_poll(quorum, proofid)
+            return node.getrawavalancheproof(uint256_hex(proofid))["finalized"]
+
+        for peer in quorum:
+            self.wait_until(lambda: has_finalized_proof(peer.proof.proofid))
+
+        # The proofs are polled several times, so they are referred to by their
+        # session id after the first poll.
+        assert any(peer.session_id_items > 0 for peer in quorum)
+
+        tip = self.generate(node, 1, sync_fun=self.no_op)[0]
+
+        def has_finalized_tip():
+            can_find_inv_in_poll(quorum, int(tip, 16))
+            return node.isfinalblock(tip)
+
+        self.wait_until(has_finalized_tip)
+
+        self.log.info("Check that the node answers the compact polls")
+        avakey = ECPubKey()
+        avakey.set(bytes.fromhex(node.getavalanchekey()))
+        poll_node = quorum[0]
+
+        fork_height = node.getblockcount() + 1
+        self.generate(node, 5, sync_fun=self.no_op)
+        accepted_hashes = [int(node.getblockhash(h), 16) for h in (0, 1, fork_height)]
+
+        poll = poll_node.send_poll(accepted_hashes)
+        assert_equal([item.code for item in poll.items], [0, 0, 0])
+        assert_response(
+            poll_node,
+            avakey,
+            [AvalancheVote(AvalancheVoteError.ACCEPTED, h) for h in accepted_hashes],
+        )
+
+        # Make the last blocks a fork, so their vote is escaped in the
+        # response.
+        fork_hash = node.getblockhash(fork_height)
+        node.invalidateblock(fork_hash)
+        self.generatetoaddress(node, 10, ADDRESS, sync_fun=self.no_op)
+        node.reconsiderblock(fork_hash)
+
+        unknown_hash = random.randrange(1 << 255, (1 << 256) - 1)
+        poll = poll_node.send_poll(
+            [accepted_hashes[0], accepted_hashes[2], unknown_hash, accepted_hashes[1]]
+        )
+        # The items already polled are sent by session id
+        assert_equal([item.code for item in poll.items], [1, 3, 0, 2])
+        assert_response(
+            poll_node,
+            avakey,
+            [
+                AvalancheVote(AvalancheVoteError.ACCEPTED, accepted_hashes[0]),
+                AvalancheVote(AvalancheVoteError.FORK, accepted_hashes[2]),
+                AvalancheVote(AvalancheVoteError.UNKNOWN, unknown_hash),
+                AvalancheVote(AvalancheVoteError.ACCEPTED, accepted_hashes[1]),
+            ],
+        )
+
+        self.log.info("Check that the polls with too many items are not read")
+        msg = msg_compactavapoll()
+        msg.poll.round = poll_node.round
+        msg.poll.items = [AvalancheCompactPollItem(1)] * (
+            AvalancheHello.MAX_ELEMENT_POLL + 1
+        )
+        with node.assert_debug_log(["Exception 'too many poll items"]):
+            poll_node.send_and_ping(msg)
+        assert_equal(poll_node.avaresponses, [])
+
+        # The session is still usable
+        poll_node.send_poll(accepted_hashes[:2])
+        assert_response(
+            poll_node,
+            avakey,
+            [
+                AvalancheVote(AvalancheVoteError.ACCEPTED, h)
+                for h in accepted_hashes[:2]
+            ],
+        )
+
+
+if __name__ == "__main__":
+    AvalancheCompactPollTest().main()
@@ -0,0 +1,100 @@
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""
+Test that the getheaders responses served from the cache match the chain, and
+that the cache doesn't outlive the tip it was built for.
+"""
+
+from test_framework.address import ADDRESS_ECREG_UNSPENDABLE
+from test_framework.messages import msg_getheaders
+from test_framework.p2p import P2PInterface, p2p_lock
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+
+class HeadersReceiver(P2PInterface):
+    def get_headers(self, locator, hash_stop=0):
+        """Send a getheaders message and return the hashes of the headers of
+        the response."""
+        with p2p_lock:
+            self.last_message.pop("headers", None)
+        msg = msg_getheaders()
+        msg.locator.vHave = [int(h, 16) for h in locator]
+        msg.hashstop = hash_stop
+        self.send_without_ping(msg)
+        self.wait_until(lambda: "headers" in self.last_message)
+        with p2p_lock:
+            return [h.hash_hex for h in self.last_message["headers"].headers]
+
+
+class GetHeadersCacheTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+
+    def chain_hashes(self, start_height):
+        """The hashes of the active chain after start_height, as they are sent
+        in a fresh getheaders response."""
+        node = self.nodes[0]
+        return [
+            node.getblockhash(height)
+            for height in range(start_height + 1, node.getblockcount() + 1)
+        ]
+
+    def run_test(self):
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(HeadersReceiver())
+
+        fork_height = node.getblockcount() - 10
+        locator = [node.getblockhash(fork_height)]
+
+        self.log.info("Check that a repeated request gets the same response")
+        expected = self.chain_hashes(fork_height)
+        assert_equal(peer.get_headers(locator), expected)
+        assert_equal(peer.get_headers(locator), expected)
+
+        # The responses are cached by start and stop hash, so a different
+        # locator resolving to the same fork point shares the entry.
+        assert_equal(
+            peer.get_headers([node.getblockhash(fork_height), node.getblockhash(0)]),
+            expected,
+        )
+
+        hash_stop = int(node.getblockhash(fork_height + 5), 16)
+        assert_equal(peer.get_headers(locator, hash_stop), expected[:5])
+        assert_equal(peer.get_headers(locator), expected)
+
+        tip = node.getbestblockhash()
+        assert_equal(peer.get_headers([tip]), [])
+        assert_equal(peer.get_headers([tip]), [])
+
+        self.log.info("Check that the cache is flushed when the tip moves")
+        self.generate(node, 1, sync_fun=self.no_op)
+        expected = self.chain_hashes(fork_height)
+        assert_equal(peer.get_headers(locator), expected)
+        assert_equal(peer.get_headers([tip]), [node.getbestblockhash()])
+
+        self.log.info("Check that the cache is flushed on a same height reorg")
+        old_tip = node.getbestblockhash()
+        height = node.getblockcount()
+        node.invalidateblock(old_tip)
+        # Mine to another address so the block differs from the invalid one
+        self.generatetoaddress(node, 1, ADDRESS_ECREG_UNSPENDABLE, sync_fun=self.no_op)
+        assert_equal(node.getblockcount(), height)
+        assert old_tip != node.getbestblockhash()
+        expected = self.chain_hashes(fork_height)
+        assert_equal(expected[-1], node.getbestblockhash())
+        assert_equal(peer.get_headers(locator), expected)
+        assert_equal(peer.get_headers([tip]), [node.getbestblockhash()])
+
+        # Back to the original chain, at the same height again
+        new_tip = node.getbestblockhash()
+        node.reconsiderblock(old_tip)
+        node.invalidateblock(new_tip)
+        assert_equal(node.getbestblockhash(), old_tip)
+        expected = self.chain_hashes(fork_height)
+        assert_equal(peer.get_headers(locator), expected)
+
+
+if __name__ == "__main__":
+    GetHeadersCacheTest().main()
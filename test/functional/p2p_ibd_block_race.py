@@ -0,0 +1,206 @@
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""
+Test that a block stalling the download window is raced from a faster peer
+"""
+
+import time
+
+from test_framework.blocktools import create_block, create_coinbase
+from test_framework.messages import (
+    MSG_BLOCK,
+    MSG_TYPE_MASK,
+    CBlockHeader,
+    msg_block,
+    msg_headers,
+)
+from test_framework.p2p import P2PDataStore
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+# Blocks requested from a peer at once (MAX_BLOCKS_IN_TRANSIT_PER_PEER)
+MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16
+# BLOCK_DOWNLOAD_WINDOW
+BLOCK_DOWNLOAD_WINDOW = 1024
+
+
+class P2PBlockServer(P2PDataStore):
+    def __init__(self, block_store):
+        super().__init__()
+        self.block_store = block_store
+        # Whether the requested blocks are sent right away
+        self.serve = True
+        # Blocks that are never sent
+        self.withheld = set()
+
+    def on_getdata(self, message):
+        for inv in message.inv:
+            self.getdata_requests.append(inv.hash)
+            if (
+                (inv.type & MSG_TYPE_MASK) == MSG_BLOCK
+                and self.serve
+                and inv.hash not in self.withheld
+            ):
+                self.send_without_ping(msg_block(self.block_store[inv.hash]))
+
+    def on_getheaders(self, message):
+        pass
+
+    def send_headers(self, blocks):
+        self.send_without_ping(msg_headers([CBlockHeader(b) for b in blocks]))
+
+
+class P2PIBDBlockRaceTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def run_test(self):
+        node = self.nodes[0]
+        # Blocks used to measure the delivery time of the peers, then enough
+        # blocks to fill the download window and to keep it stalled after each
+        # of the blocks held by the staller is raced.
+        num_measure_blocks = 6
+        num_blocks = (
+            num_measure_blocks
+            + BLOCK_DOWNLOAD_WINDOW
+            + MAX_BLOCKS_IN_TRANSIT_PER_PEER
+        )
+
+        tip = int(node.getbestblockhash(), 16)
+        block_time = node.getblock(node.getbestblockhash())["time"] + 1
+        blocks = []
+        block_store = {}
+        for height in range(1, num_blocks + 1):
+            blocks.append(
+                create_block(tip, create_coinbase(height), block_time, version=4)
+            )
+            blocks[-1].solve()
+            tip = blocks[-1].hash_int
+            block_time += 1
+            block_store[tip] = blocks[-1]
+
+        # The time only moves when the test says so, which sets the delivery
+        # times of the peers.
+        self.mocktime = int(time.time())
+        node.setmocktime(self.mocktime)
+
+        peers = []
+
+        def add_peer():
+            peer = node.add_outbound_p2p_connection(
+                P2PBlockServer(block_store),
+                p2p_idx=len(peers),
+                connection_type="outbound-full-relay",
+            )
+            peers.append(peer)
+            return peer, node.getpeerinfo()[-1]["id"]
+
+        def deliver_after(peer, delay, blocks_to_deliver):
+            peer.serve = False
+            peer.send_headers(blocks_to_deliver)
+            self.wait_until(
+                lambda: all(
+                    b.hash_int in peer.getdata_requests for b in blocks_to_deliver
+                )
+            )
+            self.mocktime += delay
+            node.setmocktime(self.mocktime)
+            for b in blocks_to_deliver:
+                peer.send_without_ping(msg_block(b))
+            self.wait_until(
+                lambda: node.getbestblockhash() == blocks_to_deliver[-1].hash_hex
+            )
+            peer.serve = True
+
+        self.log.info("Measure the delivery time of a slow and two fast peers")
+        slow_peer, slow_id = add_peer()
+        deliver_after(slow_peer, 8, blocks[0:2])
+        fast_peer, fast_id = add_peer()
+        deliver_after(fast_peer, 1, blocks[2:4])
+        fast_peer2, _ = add_peer()
+        deliver_after(fast_peer2, 1, blocks[4:6])
+
+        window = blocks[num_measure_blocks:]
+        stall_block = window[0]
+
+        self.log.info("Let the slow peer hold the first blocks of the window")
+        slow_peer.serve = False
+        slow_peer.send_headers(window)
+        self.wait_until(
+            lambda: len(slow_peer.getdata_requests)
+            == 2 + MAX_BLOCKS_IN_TRANSIT_PER_PEER
+        )
+        assert stall_block.hash_int in slow_peer.getdata_requests
+
+        self.log.info(
+            "Check that a peer without a delivery time doesn't race the staller"
+        )
+        # The blocks are delivered instantly as the time doesn't move, so
+        # this peer has no delivery time.
+        filler_peer, _ = add_peer()
+        with node.assert_debug_log(
+            expected_msgs=[f"Stall started peer={slow_id}"],
+            unexpected_msgs=["Racing stalling block"],
+        ):
+            filler_peer.send_headers(window)
+            self.wait_until(
+                lambda: len(filler_peer.getdata_requests)
+                == BLOCK_DOWNLOAD_WINDOW - MAX_BLOCKS_IN_TRANSIT_PER_PEER
+            )
+            filler_peer.sync_with_ping()
+        assert stall_block.hash_int not in filler_peer.getdata_requests
+
+        # A peer that only sent headers and pings has no delivery time either.
+        headers_peer, _ = add_peer()
+        with node.assert_debug_log(
+            expected_msgs=["received: headers"],
+            unexpected_msgs=["Racing stalling block"],
+        ):
+            headers_peer.send_headers(window)
+            headers_peer.sync_with_ping()
+        assert_equal(headers_peer.getdata_requests, [])
+
+        self.log.info("Check that a much faster peer races the staller")
+        fast_peer.withheld.add(stall_block.hash_int)
+        fast_peer2.withheld.add(stall_block.hash_int)
+        with node.assert_debug_log(
+            expected_msgs=[
+                f"Racing stalling block {stall_block.hash_hex} "
+                f"({num_measure_blocks + 1}) from peer={slow_id} to "
+                f"peer={fast_id}"
+            ]
+        ):
+            fast_peer.send_headers(window)
+            fast_peer.sync_with_ping()
+        assert stall_block.hash_int in fast_peer.getdata_requests
+
+        self.log.info("Check that a block is raced by at most two peers at once")
+        with node.assert_debug_log(
+            expected_msgs=["received: headers"],
+            unexpected_msgs=["Racing stalling block"],
+        ):
+            fast_peer2.send_headers(window)
+            fast_peer2.sync_with_ping()
+        assert stall_block.hash_int not in fast_peer2.getdata_requests
+
+        self.log.info(
+            "Check that the fast peers download the blocks held by the staller"
+        )
+        fast_peer.withheld.clear()
+        fast_peer2.withheld.clear()
+        # Once its blocks are raced, the staller is asked for the blocks past
+        # the window. These don't fill the window so they are never raced: let
+        # the staller serve them.
+        slow_peer.serve = True
+        fast_peer.send_without_ping(msg_block(stall_block))
+        self.wait_until(lambda: node.getblockcount() == num_blocks)
+        # The staller never sent the blocks it held and is still connected, as
+        # the time didn't move.
+        assert slow_peer.is_connected
+        assert_equal(node.num_test_p2p_connections(), len(peers))
+
+
+if __name__ == "__main__":
+    P2PIBDBlockRaceTest().main()
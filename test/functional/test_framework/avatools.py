@@ -14,8 +14,11 @@ from .messages import (
     MSG_BLOCK,
     NODE_AVALANCHE,
     NODE_NETWORK,
+    AvalancheCompactPollItem,
+    AvalancheCompactResponse,
     AvalancheDelegation,
     AvalancheHello,
+    AvalanchePoll,
     AvalanchePrefilledProof,
     AvalancheProof,
     AvalancheResponse,
@@ -32,10 +35,12 @@ from .messages import (
     msg_avapoll,
     msg_avaproof,
     msg_avaproofs,
+    msg_compactavapoll,
+    msg_compactavaresponse,
     msg_notfound,
     msg_tcpavaresponse,
 )
-from .p2p import P2PInterface, p2p_lock
+from .p2p import MESSAGEMAP, P2PInterface, p2p_lock
 
 if TYPE_CHECKING:
     from .test_framework import BitcoinTestFramework
@@ -44,6 +49,11 @@ from .test_node import ADDRESS_ECREG_UNSPENDABLE, TestNode
 from .util import assert_equal, satoshi_round, uint256_hex, wait_until_helper_internal
 from .wallet_util import bytes_to_wif
 
+# Version from which the avapoll and avaresponse messages are compact
+AVALANCHE_COMPACT_POLL_VERSION = 70018
+# Maximum number of session ids per connection (AVALANCHE_MAX_POLL_SESSION_IDS)
+AVALANCHE_MAX_POLL_SESSION_IDS = 4096
+
 
 def avalanche_proof_from_hex(proof_hex: str) -> AvalancheProof:
     return FromHex(AvalancheProof(), proof_hex)
@@ -384,6 +394,86 @@ class AvaP2PInterface(NoHandshakeAvaP2PInterface):
             self.send_without_ping(msg_notfound(not_found))
 
 
+class CompactAvaP2PInterface(AvaP2PInterface):
+    """AvaP2PInterface that negotiates the compact avalanche polls and
+    responses. The received polls are decoded and the received responses are
+    expanded, so they are handled like the legacy ones."""
+
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.message_map = {
+            **MESSAGEMAP,
+            b"avapoll": msg_compactavapoll,
+            b"avaresponse": msg_compactavaresponse,
+        }
+        # Session ids of the invs polled by this peer
+        self.poll_session_ids = {}
+        # Invs polled by the node, by session id
+        self.pollee_session_invs = []
+        # Invs of the polls sent by this peer, by round
+        self.sent_polls = {}
+        # Number of items polled by the node using their session id
+        self.session_id_items = 0
+
+    def peer_connect_send_version(self, services):
+        super().peer_connect_send_version(services)
+        self.on_connection_send_msg.nVersion = AVALANCHE_COMPACT_POLL_VERSION
+
+    def on_avapoll(self, message):
+        poll = message.poll
+        if poll.reset_session:
+            self.pollee_session_invs = []
+
+        invs = []
+        for item in poll.items:
+            if item.code == 0:
+                self.pollee_session_invs.append(item.inv)
+                invs.append(item.inv)
+                continue
+            self.session_id_items += 1
+            invs.append(self.pollee_session_invs[item.code - 1])
+        self.avapolls.append(AvalanchePoll(poll.round, invs))
+
+    def on_avaresponse(self, message):
+        invs = self.sent_polls.pop(message.response.round)
+        self.avaresponses.append(
+            TCPAvalancheResponse(message.response.expand(invs), message.sig)
+        )
+
+    def send_avaresponse(self, avaround, votes, privkey, cooldown=0):
+        # The signature covers the full response
+        response = AvalancheResponse(avaround, cooldown, votes)
+        msg = msg_compactavaresponse()
+        msg.response = AvalancheCompactResponse(
+            avaround, cooldown, [v.error for v in votes]
+        )
+        msg.sig = privkey.sign_schnorr(response.get_hash())
+        self.send_without_ping(msg)
+
+    def send_poll(self, hashes, inv_type=MSG_BLOCK):
+        invs = [CInv(inv_type, h) for h in hashes]
+        msg = msg_compactavapoll()
+        msg.poll.round = self.round
+        msg.poll.reset_session = (
+            len(self.poll_session_ids) + len(invs) > AVALANCHE_MAX_POLL_SESSION_IDS
+        )
+        if msg.poll.reset_session:
+            self.poll_session_ids = {}
+        for inv in invs:
+            session_id = self.poll_session_ids.get((inv.type, inv.hash))
+            if session_id is not None:
+                msg.poll.items.append(AvalancheCompactPollItem(session_id + 1))
+                continue
+            self.poll_session_ids[(inv.type, inv.hash)] = len(self.poll_session_ids)
+            msg.poll.items.append(AvalancheCompactPollItem(0, inv))
+
+        with p2p_lock:
+            self.sent_polls[self.round] = invs
+        self.round += 1
+        self.send_without_ping(msg)
+        return msg.poll
+
+
 def get_ava_p2p_interface_no_handshake(
     node: TestNode, services=NODE_NETWORK | NODE_AVALANCHE
 ) -> NoHandshakeAvaP2PInterface:
@@ -406,9 +496,10 @@ def get_ava_p2p_interface(
     sync_fun=None,
     payoutAddress=ADDRESS_ECREG_UNSPENDABLE,
     max_elements: int = AvalancheHello.MAX_ELEMENT_POLL,
+    p2p_class=AvaP2PInterface,
 ) -> AvaP2PInterface:
     """Build and return an AvaP2PInterface connected to the specified TestNode."""
-    n = AvaP2PInterface(
+    n = p2p_class(
         test_framework, node, payoutAddress=payoutAddress, max_elements=max_elements
     )
     assert n.master_privkey is not None
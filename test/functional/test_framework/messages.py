@@ -1082,6 +1082,134 @@ class TCPAvalancheResponse:
         return f"TCPAvalancheResponse(response={self.response!r}, sig={self.sig})"
 
 
+class AvalancheCompactPollItem:
+    """An item of a compact poll: the session id + 1 of an item already polled
+    on the connection, or 0 followed by the inv of a new item."""
+
+    __slots__ = ("code", "inv")
+
+    def __init__(self, code=0, inv=None):
+        self.code = code
+        self.inv = inv if inv is not None else CInv()
+
+    def deserialize(self, f):
+        self.code = deser_compact_size(f)
+        if self.code == 0:
+            self.inv = CInv()
+            self.inv.deserialize(f)
+
+    def serialize(self) -> bytes:
+        r = ser_compact_size(self.code)
+        if self.code == 0:
+            r += self.inv.serialize()
+        return r
+
+    def __repr__(self):
+        return f"AvalancheCompactPollItem(code={self.code}, inv={self.inv!r})"
+
+
+class AvalancheCompactPoll:
+    __slots__ = ("round", "reset_session", "items")
+
+    def __init__(self, avaround=0, reset_session=False, items=None):
+        self.round = avaround
+        self.reset_session = reset_session
+        self.items = items if items is not None else []
+
+    def deserialize(self, f):
+        self.round = struct.unpack("<q", f.read(8))[0]
+        self.reset_session = struct.unpack("<?", f.read(1))[0]
+        self.items = deser_vector(f, AvalancheCompactPollItem)
+
+    def serialize(self) -> bytes:
+        return (
+            struct.pack("<q", self.round)
+            + struct.pack("<?", self.reset_session)
+            + ser_vector(self.items)
+        )
+
+    def __repr__(self):
+        return (
+            f"AvalancheCompactPoll(round={self.round}, "
+            f"reset_session={self.reset_session}, items={self.items!r})"
+        )
+
+
+class AvalancheCompactResponse:
+    """A response without the item hashes. The accepted, rejected and unknown
+    votes are packed on 2 bits, the other values are escaped after them."""
+
+    __slots__ = ("round", "cooldown", "errors")
+
+    CODE_ACCEPTED = 0
+    CODE_REJECTED = 1
+    CODE_UNKNOWN = 2
+    CODE_ESCAPED = 3
+
+    def __init__(self, avaround=0, cooldown=0, errors=None):
+        self.round = avaround
+        self.cooldown = cooldown
+        self.errors = errors if errors is not None else []
+
+    @classmethod
+    def get_code(cls, error):
+        return {
+            0: cls.CODE_ACCEPTED,
+            1: cls.CODE_REJECTED,
+            -1: cls.CODE_UNKNOWN,
+        }.get(error, cls.CODE_ESCAPED)
+
+    def deserialize(self, f):
+        self.round = struct.unpack("<q", f.read(8))[0]
+        self.cooldown = struct.unpack("<i", f.read(4))[0]
+        count = deser_compact_size(f)
+        packed = f.read((count + 3) // 4)
+        codes = [(packed[i // 4] >> (2 * (i % 4))) & 0x03 for i in range(count)]
+        self.errors = [
+            (
+                struct.unpack("<i", f.read(4))[0]
+                if code == self.CODE_ESCAPED
+                else {
+                    self.CODE_ACCEPTED: 0,
+                    self.CODE_REJECTED: 1,
+                    self.CODE_UNKNOWN: -1,
+                }[code]
+            )
+            for code in codes
+        ]
+
+    def serialize(self) -> bytes:
+        packed = bytearray((len(self.errors) + 3) // 4)
+        for i, error in enumerate(self.errors):
+            packed[i // 4] |= self.get_code(error) << (2 * (i % 4))
+        return (
+            struct.pack("<q", self.round)
+            + struct.pack("<i", self.cooldown)
+            + ser_compact_size(len(self.errors))
+            + bytes(packed)
+            + b"".join(
+                struct.pack("<i", error)
+                for error in self.errors
+                if self.get_code(error) == self.CODE_ESCAPED
+            )
+        )
+
+    def expand(self, invs):
+        """Rebuild the full response given the polled invs, in order."""
+        assert_equal(len(invs), len(self.errors))
+        return AvalancheResponse(
+            self.round,
+            self.cooldown,
+            [AvalancheVote(e, inv.hash) for e, inv in zip(self.errors, invs)],
+        )
+
+    def __repr__(self):
+        return (
+            f"AvalancheCompactResponse(round={self.round}, "
+            f"cooldown={self.cooldown}, errors={self.errors!r})"
+        )
+
+
 class AvalancheDelegationLevel:
     __slots__ = ("pubkey", "sig")
 
@@ -2052,6 +2180,51 @@ class msg_tcpavaresponse:
         return f"msg_tcpavaresponse(response={self.response!r})"
 
 
+class msg_compactavapoll:
+    """An avapoll message between peers of version
+    AVALANCHE_COMPACT_POLL_VERSION or later."""
+
+    __slots__ = ("poll",)
+    msgtype = b"avapoll"
+
+    def __init__(self):
+        self.poll = AvalancheCompactPoll()
+
+    def deserialize(self, f):
+        self.poll.deserialize(f)
+
+    def serialize(self) -> bytes:
+        return self.poll.serialize()
+
+    def __repr__(self):
+        return f"msg_compactavapoll(poll={self.poll!r})"
+
+
+class msg_compactavaresponse:
+    """An avaresponse message between peers of version
+    AVALANCHE_COMPACT_POLL_VERSION or later. The signature covers the full
+    response."""
+
+    __slots__ = ("response", "sig")
+    msgtype = b"avaresponse"
+
+    def __init__(self):
+        self.response = AvalancheCompactResponse()
+        self.sig = b"\0" * 64
+
+    def deserialize(self, f):
+        self.response.deserialize(f)
+        self.sig = f.read(64)
+
+    def serialize(self) -> bytes:
+        return self.response.serialize() + self.sig
+
+    def __repr__(self):
+        return (
+            f"msg_compactavaresponse(response={self.response!r}, sig={self.sig})"
+        )
+
+
 class msg_avahello:
     __slots__ = ("hello",)
     msgtype = b"avahello"
@@ -177,6 +177,10 @@ class P2PConnection(asyncio.Protocol):
         # Should only call methods on this from the NetworkThread, c.f.
         # call_soon_threadsafe
         self._transport = None
+        # The classes used to decode the received messages, by message type.
+        # Subclasses can replace some of them when the encoding depends on the
+        # negotiated version.
+        self.message_map = MESSAGEMAP
 
     @property
     def is_connected(self):
@@ -286,13 +290,13 @@ class P2PConnection(asyncio.Protocol):
                 if checksum != h[:4]:
                     raise ValueError(f"got bad checksum {repr(self.recvbuf)}")
                 self.recvbuf = self.recvbuf[4 + 12 + 4 + 4 + msglen :]
-                if msgtype not in MESSAGEMAP:
+                if msgtype not in self.message_map:
                     raise ValueError(
                         f"Received unknown msgtype from {self.dstaddr}:{self.dstport}:"
                         f" '{msgtype}' {msg!r}"
                     )
                 f = BytesIO(msg)
-                m = MESSAGEMAP[msgtype]()
+                m = self.message_map[msgtype]()
                 m.deserialize(f)
                 self._log_message("receive", m)
                 return m